@@ -91,6 +91,8 @@ int main (int argc, char *argv[])
     MPI_Comm_rank (MPI_COMM_WORLD, &rank);
 
     parse_args(argc, argv, MPI_COMM_WORLD);
+    bench_mpit_init(MPI_COMM_WORLD);
+    bench_skew_init(MPI_COMM_WORLD);
 
     int max_elements = elements;
     if (rank == 0 ) {
@@ -121,7 +123,9 @@ int main (int argc, char *argv[])
         }
 
         // execute the allreduce test
+        bench_skew_begin(MPI_COMM_WORLD, niter);
         MPI_Barrier(MPI_COMM_WORLD);
+        bench_mpit_begin();
         t1s = std::chrono::high_resolution_clock::now();
         ret = allgather_test (sendbuf->get_buffer(), recvbuf->get_buffer(), elements,
                               MPI_DOUBLE, MPI_COMM_WORLD, niter);
@@ -161,6 +165,8 @@ int main (int argc, char *argv[])
     delete (sendbuf);
     delete (recvbuf);
 
+    bench_mpit_finalize();
+    bench_skew_finalize();
     MPI_Finalize ();
     return ret;
 }
@@ -171,13 +177,59 @@ int allgather_test (void *sendbuf, void *recvbuf, int count,
                     int niterations)
 {
     int ret;
+#if defined HIP_MPITEST_ALLGATHERV || defined HIP_MPITEST_GATHERV
+    int *rcounts = NULL, *rdispls = NULL;
+    int size;
+
+    MPI_Comm_size (comm, &size);
+
+    rcounts = (int*)malloc(size *sizeof(int));
+    if (NULL == rcounts) {
+        printf("(All)gatherv benchmark: Could not allocate memory\n");
+        return MPI_ERR_OTHER;
+    }
+    rdispls = (int*)malloc(size *sizeof(int));
+    if (NULL == rdispls) {
+        printf("(All)gatherv benchmark: Could not allocate memory\n");
+        ret = MPI_ERR_OTHER;
+        goto out;
+    }
+
+    for (int i=0; i<size; i++) {
+        rcounts[i]=count;
+        rdispls[i]=i*count;
+    }
+#endif
 
     for (int i=0; i<niterations; i++) {
+        BENCH_SKEW_ENTER(i);
+#if defined HIP_MPITEST_GATHER
+        HIP_MPITEST_TRACE_BEGIN();
+        ret = MPI_Gather (sendbuf, count, datatype, recvbuf, count, datatype, 0, comm);
+        HIP_MPITEST_TRACE_END("MPI_Gather", count, datatype);
+#elif defined HIP_MPITEST_GATHERV
+        HIP_MPITEST_TRACE_BEGIN();
+        ret = MPI_Gatherv (sendbuf, count, datatype, recvbuf, rcounts, rdispls, datatype, 0, comm);
+        HIP_MPITEST_TRACE_END("MPI_Gatherv", count, datatype);
+#elif defined HIP_MPITEST_ALLGATHERV
+        HIP_MPITEST_TRACE_BEGIN();
+        ret = MPI_Allgatherv (sendbuf, count, datatype, recvbuf, rcounts, rdispls, datatype, comm);
+        HIP_MPITEST_TRACE_END("MPI_Allgatherv", count, datatype);
+#else
+        HIP_MPITEST_TRACE_BEGIN();
         ret = MPI_Allgather(sendbuf, count, datatype, recvbuf, count, datatype, comm);
+        HIP_MPITEST_TRACE_END("MPI_Allgather", count, datatype);
+#endif
+        BENCH_SKEW_EXIT(i);
         if (MPI_SUCCESS != ret) {
-            return ret;
+            goto out;
         }
     }
 
-    return MPI_SUCCESS;
+ out:
+#if defined HIP_MPITEST_ALLGATHERV || defined HIP_MPITEST_GATHERV
+    free (rcounts);
+    free (rdispls);
+#endif
+    return ret;
 }
@@ -30,6 +30,7 @@
 #include "hip_mpitest_utils.h"
 #include "hip_mpitest_buffer.h"
 #include "hip_mpitest_bench.h"
+#include "hip_mpitest_reduce.h"
 
 #define NITER_LONG   25
 #define NITER_SHORT  200
@@ -38,36 +39,16 @@ int elements=100;
 hip_mpitest_buffer *sendbuf=NULL;
 hip_mpitest_buffer *recvbuf=NULL;
 
-static void init_sendbuf (double *sendbuf, int count, int mynode)
-{
-    for (int i = 0; i < count; i++) {
-        sendbuf[i] = (double)mynode;
-    }
-}
+hip_mpitest_reduction *reduction=NULL;
 
-static void init_recvbuf (double *recvbuf, int count)
+static void init_sendbuf (char *sendbuf, int count, int mynode)
 {
-    for (int i = 0; i < count; i++) {
-        recvbuf[i] = 0.0;
-    }
+    reduction->init_sendbuf (sendbuf, count, mynode);
 }
 
-static bool check_recvbuf(double *recvbuf, int nprocs, int rank, int count)
+static void init_recvbuf (char *recvbuf, int count)
 {
-    bool res=true;
-    int expected = nprocs * (nprocs -1) / 2;
-    double result = (double) expected;
-
-    for (int i=0; i<count; i++) {
-        if (recvbuf[i] != result) {
-            res = false;
-#ifdef VERBOSE
-            printf("recvbuf[%d] = %d\n", i, recvbuf[i]);
-#endif
-        }
-    }
-
-    return res;
+    reduction->init_recvbuf (recvbuf, count);
 }
 
 int allreduce_test (void *sendbuf, void *recvbuf, int count,
@@ -81,7 +62,8 @@ int main (int argc, char *argv[])
     int root = 0;
     std::chrono::high_resolution_clock::time_point t1s, t1e;
     double t1;
-    double *tmp_sendbuf=NULL, *tmp_recvbuf=NULL;
+    char *tmp_sendbuf=NULL, *tmp_recvbuf=NULL;
+    size_t extent;
 
     bind_device();
 
@@ -90,11 +72,16 @@ int main (int argc, char *argv[])
     MPI_Comm_rank (MPI_COMM_WORLD, &rank);
 
     parse_args(argc, argv, MPI_COMM_WORLD);
+    bench_mpit_init(MPI_COMM_WORLD);
+    bench_skew_init(MPI_COMM_WORLD);
+    reduction = hip_mpitest_reduction_select(MPI_COMM_WORLD);
+    extent    = reduction->get_extent();
 
     int max_elements = elements;
 
     if (rank == 0 ) {
-        printf("Benchmark: %s %c %c - %d processes\n\n", argv[0],  sendbuf->get_memchar(), recvbuf->get_memchar(), size);
+        printf("Benchmark: %s %c %c - %d processes\n", argv[0],  sendbuf->get_memchar(), recvbuf->get_memchar(), size);
+        printf("Reduction: %s\n\n", reduction->get_name());
         printf("No. of elems \t msg. length \t time\n");
         printf("================================================================\n");
     }
@@ -105,26 +92,28 @@ int main (int argc, char *argv[])
         tmp_recvbuf = NULL;
 
         // Initialise send buffer
-        ALLOCATE_SENDBUFFER(sendbuf, tmp_sendbuf, double, elements, sizeof(double),
+        ALLOCATE_SENDBUFFER(sendbuf, tmp_sendbuf, char, elements, extent,
                             rank, MPI_COMM_WORLD, init_sendbuf, out);
 
         // Initialize recv buffer
-        ALLOCATE_RECVBUFFER(recvbuf, tmp_recvbuf, double, elements, sizeof(double),
+        ALLOCATE_RECVBUFFER(recvbuf, tmp_recvbuf, char, elements, extent,
                             rank, MPI_COMM_WORLD, init_recvbuf, out);
 
         //Warmup
         ret = allreduce_test (sendbuf->get_buffer(), recvbuf->get_buffer(), elements,
-                              MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD, 1);
+                              reduction->get_mpi_type(), reduction->get_mpi_op(), MPI_COMM_WORLD, 1);
         if (MPI_SUCCESS != ret) {
             fprintf(stderr, "Error in allreduce_test. Aborting\n");
             goto out;
         }
 
         // execute the allreduce test
+        bench_skew_begin(MPI_COMM_WORLD, niter);
         MPI_Barrier(MPI_COMM_WORLD);
+        bench_mpit_begin();
         t1s = std::chrono::high_resolution_clock::now();
         ret = allreduce_test (sendbuf->get_buffer(), recvbuf->get_buffer(), elements,
-                              MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD, niter);
+                              reduction->get_mpi_type(), reduction->get_mpi_op(), MPI_COMM_WORLD, niter);
         if (MPI_SUCCESS != ret) {
             fprintf(stderr, "Error in allreduce_test. Aborting\n");
             goto out;
@@ -137,17 +126,17 @@ int main (int argc, char *argv[])
         bool res, fret;
         res = true;
         if (recvbuf->NeedsStagingBuffer()) {
-            HIP_CHECK(recvbuf->CopyFrom(tmp_recvbuf, elements*sizeof(double)));
-            res = check_recvbuf(tmp_recvbuf, size, rank, elements);
+            HIP_CHECK(recvbuf->CopyFrom(tmp_recvbuf, elements*extent));
+            res = reduction->check_recvbuf(tmp_recvbuf, size, rank, elements);
         }
         else {
-            res = check_recvbuf((double*) recvbuf->get_buffer(), size, rank, elements);
+            res = reduction->check_recvbuf(recvbuf->get_buffer(), size, rank, elements);
         }
 
         fret = report_testresult(argv[0], MPI_COMM_WORLD, sendbuf->get_memchar(), recvbuf->get_memchar(), res);
 #endif
         bench_performance (argv[0], MPI_COMM_WORLD, sendbuf->get_memchar(), recvbuf->get_memchar(),
-                           elements, (size_t)(elements * sizeof(double)), niter, t1);
+                           elements, (size_t)(elements * extent), niter, t1);
 
         //Free buffers
         FREE_BUFFER(sendbuf, tmp_sendbuf);
@@ -160,7 +149,10 @@ int main (int argc, char *argv[])
     }
     delete (sendbuf);
     delete (recvbuf);
+    delete (reduction);
 
+    bench_mpit_finalize();
+    bench_skew_finalize();
     MPI_Finalize ();
     return ret;
 }
@@ -173,7 +165,11 @@ int allreduce_test ( void *sendbuf, void *recvbuf, int count,
     int ret;
 
     for (int i=0; i<niterations; i++) {
+        BENCH_SKEW_ENTER(i);
+        HIP_MPITEST_TRACE_BEGIN();
         ret = MPI_Allreduce (sendbuf, recvbuf, count, datatype, op,  comm);
+        HIP_MPITEST_TRACE_END("MPI_Allreduce", count, datatype);
+        BENCH_SKEW_EXIT(i);
         if (MPI_SUCCESS != ret) {
             return ret;
         }
@@ -94,6 +94,8 @@ int main (int argc, char *argv[])
     MPI_Comm_rank (MPI_COMM_WORLD, &rank);
 
     parse_args(argc, argv, MPI_COMM_WORLD);
+    bench_mpit_init(MPI_COMM_WORLD);
+    bench_skew_init(MPI_COMM_WORLD);
 
     int max_elements = elements;
 
@@ -141,10 +143,12 @@ int main (int argc, char *argv[])
         hip_mpitest_compute_init(params);
         hip_mpitest_compute_set_params(params, (ts*COMPUTE_SAFETY_FACTOR));
 
+        bench_skew_begin(MPI_COMM_WORLD, niter);
         MPI_Barrier(MPI_COMM_WORLD);
         // launch compute operation
         hip_mpitest_compute_launch(params);
         // do communication benchmark
+        bench_mpit_begin();
         t1s = std::chrono::high_resolution_clock::now();
         ret = allreduce_test (sendbuf->get_buffer(), recvbuf->get_buffer(), elements,
                               MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD, niter);
@@ -185,6 +189,8 @@ int main (int argc, char *argv[])
     delete (sendbuf);
     delete (recvbuf);
 
+    bench_mpit_finalize();
+    bench_skew_finalize();
     MPI_Finalize ();
     return ret;
 }
@@ -197,7 +203,11 @@ int allreduce_test ( void *sendbuf, void *recvbuf, int count,
     int ret;
 
     for (int i=0; i<niterations; i++) {
+        BENCH_SKEW_ENTER(i);
+        HIP_MPITEST_TRACE_BEGIN();
         ret = MPI_Allreduce (sendbuf, recvbuf, count, datatype, op,  comm);
+        HIP_MPITEST_TRACE_END("MPI_Allreduce", count, datatype);
+        BENCH_SKEW_EXIT(i);
         if (MPI_SUCCESS != ret) {
             return ret;
         }
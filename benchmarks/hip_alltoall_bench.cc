@@ -91,6 +91,8 @@ int main (int argc, char *argv[])
     MPI_Comm_rank (MPI_COMM_WORLD, &rank);
 
     parse_args(argc, argv, MPI_COMM_WORLD);
+    bench_mpit_init(MPI_COMM_WORLD);
+    bench_skew_init(MPI_COMM_WORLD);
 
     int max_elements = elements;
     if (rank == 0 ) {
@@ -121,7 +123,9 @@ int main (int argc, char *argv[])
         }
 
         // execute the allreduce test
+        bench_skew_begin(MPI_COMM_WORLD, niter);
         MPI_Barrier(MPI_COMM_WORLD);
+        bench_mpit_begin();
         t1s = std::chrono::high_resolution_clock::now();
         ret = alltoall_test (sendbuf->get_buffer(), recvbuf->get_buffer(), elements,
                              MPI_DOUBLE, MPI_COMM_WORLD, niter);
@@ -161,6 +165,8 @@ int main (int argc, char *argv[])
     delete (sendbuf);
     delete (recvbuf);
 
+    bench_mpit_finalize();
+    bench_skew_finalize();
     MPI_Finalize ();
     return ret;
 }
@@ -173,7 +179,11 @@ int alltoall_test ( void *sendbuf, void *recvbuf, int count,
     int ret;
 
     for (int i=0; i<niterations; i++) {
+        BENCH_SKEW_ENTER(i);
+        HIP_MPITEST_TRACE_BEGIN();
         ret = MPI_Alltoall(sendbuf, count, datatype, recvbuf, count, datatype, comm);
+        HIP_MPITEST_TRACE_END("MPI_Alltoall", count, datatype);
+        BENCH_SKEW_EXIT(i);
         if (MPI_SUCCESS != ret) {
             return ret;
         }
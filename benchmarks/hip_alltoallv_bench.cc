@@ -0,0 +1,422 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include <limits.h>
+#include "mpi.h"
+
+#include <hip/hip_runtime.h>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <vector>
+
+#include "hip_mpitest_utils.h"
+#include "hip_mpitest_buffer.h"
+#include "hip_mpitest_bench.h"
+
+#define NITER_LONG   25
+#define NITER_SHORT  200
+#define NITER_THRESH 131072
+int elements=100;
+hip_mpitest_buffer *sendbuf=NULL;
+hip_mpitest_buffer *recvbuf=NULL;
+
+/*
+** Distribution of the per-peer counts, selected with the environment variable
+** HIP_MPITEST_ALLTOALLV_DIST:
+**   uniform               every process sends the same count to every peer (default)
+**   random                counts drawn uniformly from [0, 2*elements]
+**   zipf[:s]              peer popularity follows a Zipf law with exponent s (default 1.0),
+**                         e.g. tokens routed to experts in a mixture-of-experts layer
+**   hotspot[:rank[:f]]    rank (default 0) receives f times (default 8) more than any other peer
+**   sparse[:fraction]     fraction (default 0.5) of the entries of the count matrix are zero
+**   file:<path>           count matrix with size*size entries, row i holding the counts
+**                         process i sends to each peer
+** In all cases the entries are used as weights and scaled such that the total
+** volume equals that of an MPI_Alltoall with elements per peer, hence the
+** element sweep of the benchmark applies to all distributions. The random
+** distributions use the same seed on all processes (HIP_MPITEST_ALLTOALLV_SEED,
+** default 1) so that every process computes the same matrix.
+*/
+#define DIST_UNIFORM 0
+#define DIST_RANDOM  1
+#define DIST_ZIPF    2
+#define DIST_HOTSPOT 3
+#define DIST_SPARSE  4
+#define DIST_FILE    5
+
+static const char *dist_names[] = {"uniform", "random", "zipf", "hotspot", "sparse", "file"};
+
+static double *weights=NULL;  // size*size matrix of relative counts
+
+static int init_weights (MPI_Comm comm)
+{
+    char *dist = getenv("HIP_MPITEST_ALLTOALLV_DIST");
+    char *seedstr = getenv("HIP_MPITEST_ALLTOALLV_SEED");
+    int rank, size, type=DIST_UNIFORM;
+    double param1=0.0, param2=0.0;
+    const char *path=NULL;
+    int ret = MPI_SUCCESS;
+
+    MPI_Comm_rank (comm, &rank);
+    MPI_Comm_size (comm, &size);
+
+    if (NULL != dist) {
+        if (strncmp(dist, "uniform", 7) == 0) {
+            type = DIST_UNIFORM;
+        }
+        else if (strncmp(dist, "random", 6) == 0) {
+            type = DIST_RANDOM;
+        }
+        else if (strncmp(dist, "zipf", 4) == 0) {
+            type   = DIST_ZIPF;
+            param1 = 1.0;
+            sscanf(dist, "zipf:%lf", &param1);
+        }
+        else if (strncmp(dist, "hotspot", 7) == 0) {
+            type   = DIST_HOTSPOT;
+            param1 = 0.0;
+            param2 = 8.0;
+            sscanf(dist, "hotspot:%lf:%lf", &param1, &param2);
+        }
+        else if (strncmp(dist, "sparse", 6) == 0) {
+            type   = DIST_SPARSE;
+            param1 = 0.5;
+            sscanf(dist, "sparse:%lf", &param1);
+        }
+        else if (strncmp(dist, "file:", 5) == 0) {
+            type = DIST_FILE;
+            path = dist + 5;
+        }
+        else {
+            if (rank == 0) {
+                fprintf(stderr, "Invalid distribution in HIP_MPITEST_ALLTOALLV_DIST: %s\n", dist);
+            }
+            return MPI_ERR_ARG;
+        }
+    }
+
+    weights = (double*)malloc(size * size * sizeof(double));
+    if (NULL == weights) {
+        printf("Alltoallv benchmark: Could not allocate memory\n");
+        return MPI_ERR_OTHER;
+    }
+
+    std::mt19937 gen(NULL != seedstr ? atoi(seedstr) : 1);
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+
+    if (type == DIST_ZIPF) {
+        // the popularity of the peers is a random permutation of the ranks
+        std::vector<int> perm(size);
+        for (int j=0; j<size; j++) {
+            perm[j] = j;
+        }
+        std::shuffle(perm.begin(), perm.end(), gen);
+        for (int i=0; i<size; i++) {
+            for (int j=0; j<size; j++) {
+                weights[i*size+j] = 1.0 / pow((double)(perm[j]+1), param1);
+            }
+        }
+    }
+    else if (type == DIST_FILE) {
+        if (rank == 0) {
+            FILE *fp = fopen(path, "r");
+            if (NULL == fp) {
+                fprintf(stderr, "Alltoallv benchmark: Could not open %s\n", path);
+                ret = MPI_ERR_FILE;
+            }
+            else {
+                for (int i=0; i<size*size; i++) {
+                    if (1 != fscanf(fp, "%lf", &weights[i]) || weights[i] < 0.0) {
+                        fprintf(stderr, "Alltoallv benchmark: %s does not contain %d non-negative counts\n",
+                                path, size*size);
+                        ret = MPI_ERR_FILE;
+                        break;
+                    }
+                }
+                fclose(fp);
+            }
+        }
+        MPI_Bcast(&ret, 1, MPI_INT, 0, comm);
+        if (MPI_SUCCESS != ret) {
+            free (weights);
+            weights = NULL;
+            return ret;
+        }
+        MPI_Bcast(weights, size*size, MPI_DOUBLE, 0, comm);
+    }
+    else {
+        for (int i=0; i<size*size; i++) {
+            int j = i % size;
+            switch (type) {
+            case DIST_RANDOM:
+                weights[i] = uni(gen);
+                break;
+            case DIST_HOTSPOT:
+                weights[i] = j == (int)param1 ? param2 : 1.0;
+                break;
+            case DIST_SPARSE:
+                weights[i] = uni(gen) < param1 ? 0.0 : 1.0;
+                break;
+            default:
+                weights[i] = 1.0;
+            }
+        }
+    }
+
+    if (rank == 0) {
+        printf("Count distribution: %s", dist_names[type]);
+        if (type == DIST_ZIPF || type == DIST_SPARSE) {
+            printf(" %.2lf", param1);
+        }
+        else if (type == DIST_HOTSPOT) {
+            printf(" rank %d factor %.2lf", (int)param1, param2);
+        }
+        else if (type == DIST_FILE) {
+            printf(" %s", path);
+        }
+        printf("\n");
+    }
+
+    return ret;
+}
+
+/*
+** Scale the weights to counts with an average of count elements per peer.
+** The counts and displacements are computed in long and the benchmark is
+** aborted if they do not fit into the int arguments of MPI_Alltoallv.
+*/
+static void set_counts (int count, int size, int rank, int *scounts, int *sdispls,
+                        int *rcounts, int *rdispls, int *stotal, int *rtotal)
+{
+    double wsum=0.0, scale;
+    long ssum=0, rsum=0, sc, rc;
+
+    for (int i=0; i<size*size; i++) {
+        wsum += weights[i];
+    }
+    scale = wsum > 0.0 ? ((double)count * size * size) / wsum : 0.0;
+
+    for (int j=0; j<size; j++) {
+        sc = (long)(weights[rank*size+j] * scale + 0.5);
+        rc = (long)(weights[j*size+rank] * scale + 0.5);
+        if (ssum + sc > INT_MAX || rsum + rc > INT_MAX) {
+            fprintf(stderr, "[%d] Alltoallv benchmark: %d elements per peer exceed INT_MAX "
+                    "elements per process with this distribution, reduce -n\n", rank, count);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        scounts[j] = (int)sc;
+        rcounts[j] = (int)rc;
+        sdispls[j] = (int)ssum;
+        rdispls[j] = (int)rsum;
+        ssum += sc;
+        rsum += rc;
+    }
+    *stotal = (int)ssum;
+    *rtotal = (int)rsum;
+}
+
+static void init_sendbuf (double *sendbuf, int count, int mynode)
+{
+    for (int i = 0; i < count; i++) {
+        sendbuf[i] = (double)mynode;
+    }
+}
+
+static void init_recvbuf (double *recvbuf, int count)
+{
+    for (int i = 0; i < count; i++) {
+        recvbuf[i] = 0.0;
+    }
+}
+
+static bool check_recvbuf(double *recvbuf, int nprocs, int rank, int *rcounts, int *rdispls)
+{
+    bool res=true;
+
+    for (int j=0; j<nprocs; j++) {
+        double result = (double)j;
+        for (int i=0; i<rcounts[j]; i++) {
+            if (recvbuf[rdispls[j]+i] != result) {
+                res = false;
+#ifdef VERBOSE
+                printf("recvbuf[%d] = %lf\n", rdispls[j]+i, recvbuf[rdispls[j]+i]);
+#endif
+            }
+        }
+    }
+
+    return res;
+}
+
+int alltoallv_test (void *sendbuf, int *scounts, int *sdispls,
+                    void *recvbuf, int *rcounts, int *rdispls,
+                    int stotal, MPI_Datatype datatype, MPI_Comm comm,
+                    int niterations);
+
+int main (int argc, char *argv[])
+{
+    int ret;
+    int rank, size;
+    std::chrono::high_resolution_clock::time_point t1s, t1e;
+    double t1;
+    double *tmp_sendbuf=NULL, *tmp_recvbuf=NULL;
+    int *scounts=NULL, *sdispls=NULL, *rcounts=NULL, *rdispls=NULL;
+    int stotal, rtotal, max_elements;
+
+    bind_device();
+
+    MPI_Init      (&argc, &argv);
+    MPI_Comm_size (MPI_COMM_WORLD, &size);
+    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+
+    parse_args(argc, argv, MPI_COMM_WORLD);
+    bench_mpit_init(MPI_COMM_WORLD);
+    bench_skew_init(MPI_COMM_WORLD);
+
+    ret = init_weights(MPI_COMM_WORLD);
+    if (MPI_SUCCESS != ret) {
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    scounts = (int*)malloc(size * sizeof(int));
+    sdispls = (int*)malloc(size * sizeof(int));
+    rcounts = (int*)malloc(size * sizeof(int));
+    rdispls = (int*)malloc(size * sizeof(int));
+    if (NULL == scounts || NULL == sdispls || NULL == rcounts || NULL == rdispls) {
+        printf("Alltoallv benchmark: Could not allocate memory\n");
+        ret = MPI_ERR_OTHER;
+        goto out;
+    }
+
+    max_elements = elements;
+    if (rank == 0 ) {
+        printf("Benchmark: %s %c %c - %d processes\n\n", argv[0],  sendbuf->get_memchar(), recvbuf->get_memchar(), size);
+        printf("No. of elems \t msg. length \t time\n");
+        printf("================================================================\n");
+    }
+
+    for (elements = 1; elements <= max_elements; elements *= 2) {
+        int niter = elements >= NITER_THRESH ? NITER_LONG : NITER_SHORT;
+        tmp_sendbuf = NULL;
+        tmp_recvbuf = NULL;
+
+        set_counts(elements, size, rank, scounts, sdispls, rcounts, rdispls, &stotal, &rtotal);
+
+        // Initialise send buffer
+        ALLOCATE_SENDBUFFER(sendbuf, tmp_sendbuf, double, std::max(stotal, 1), sizeof(double),
+                            rank, MPI_COMM_WORLD, init_sendbuf, out);
+
+        // Initialize recv buffer
+        ALLOCATE_RECVBUFFER(recvbuf, tmp_recvbuf, double, std::max(rtotal, 1), sizeof(double),
+                            rank, MPI_COMM_WORLD, init_recvbuf, out);
+
+        //Warmup
+        ret = alltoallv_test (sendbuf->get_buffer(), scounts, sdispls,
+                              recvbuf->get_buffer(), rcounts, rdispls,
+                              stotal, MPI_DOUBLE, MPI_COMM_WORLD, 1);
+        if (MPI_SUCCESS != ret) {
+            fprintf(stderr, "Error in alltoallv_test. Aborting\n");
+            goto out;
+        }
+
+        // execute the alltoallv test
+        bench_skew_begin(MPI_COMM_WORLD, niter);
+        MPI_Barrier(MPI_COMM_WORLD);
+        bench_mpit_begin();
+        t1s = std::chrono::high_resolution_clock::now();
+        ret = alltoallv_test (sendbuf->get_buffer(), scounts, sdispls,
+                              recvbuf->get_buffer(), rcounts, rdispls,
+                              stotal, MPI_DOUBLE, MPI_COMM_WORLD, niter);
+        if (MPI_SUCCESS != ret) {
+            fprintf(stderr, "Error in alltoallv_test. Aborting\n");
+            goto out;
+        }
+        t1e = std::chrono::high_resolution_clock::now();
+        t1 = std::chrono::duration<double>(t1e-t1s).count();
+
+#if 0
+        // verify results
+        bool res, fret;
+        res = true;
+        if (recvbuf->NeedsStagingBuffer()) {
+            HIP_CHECK(recvbuf->CopyFrom(tmp_recvbuf, rtotal*sizeof(double)));
+            res = check_recvbuf(tmp_recvbuf, size, rank, rcounts, rdispls);
+        }
+        else {
+            res = check_recvbuf((double*) recvbuf->get_buffer(), size, rank, rcounts, rdispls);
+        }
+
+        fret = report_testresult(argv[0], MPI_COMM_WORLD, sendbuf->get_memchar(), recvbuf->get_memchar(), res);
+#endif
+        bench_performance (argv[0], MPI_COMM_WORLD, sendbuf->get_memchar(), recvbuf->get_memchar(),
+                           elements, (size_t)(elements * sizeof(double)), niter, t1,
+                           ((long)stotal + rtotal) * sizeof(double));
+
+        //Free buffers
+        FREE_BUFFER(sendbuf, tmp_sendbuf);
+        FREE_BUFFER(recvbuf, tmp_recvbuf);
+    }
+ out:
+    if (MPI_SUCCESS != ret) {
+        FREE_BUFFER(sendbuf, tmp_sendbuf);
+        FREE_BUFFER(recvbuf, tmp_recvbuf);
+    }
+    delete (sendbuf);
+    delete (recvbuf);
+    free (scounts);
+    free (sdispls);
+    free (rcounts);
+    free (rdispls);
+    free (weights);
+
+    bench_mpit_finalize();
+    bench_skew_finalize();
+    MPI_Finalize ();
+    return ret;
+}
+
+
+int alltoallv_test (void *sendbuf, int *scounts, int *sdispls,
+                    void *recvbuf, int *rcounts, int *rdispls,
+                    int stotal, MPI_Datatype datatype, MPI_Comm comm,
+                    int niterations)
+{
+    int ret;
+
+    for (int i=0; i<niterations; i++) {
+        BENCH_SKEW_ENTER(i);
+        HIP_MPITEST_TRACE_BEGIN();
+        ret = MPI_Alltoallv(sendbuf, scounts, sdispls, datatype,
+                            recvbuf, rcounts, rdispls, datatype, comm);
+        HIP_MPITEST_TRACE_END("MPI_Alltoallv", stotal, datatype);
+        BENCH_SKEW_EXIT(i);
+        if (MPI_SUCCESS != ret) {
+            return ret;
+        }
+    }
+
+    return MPI_SUCCESS;
+}
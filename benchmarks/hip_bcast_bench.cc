@@ -89,6 +89,8 @@ int main (int argc, char *argv[])
     MPI_Comm_rank (MPI_COMM_WORLD, &rank);
 
     parse_args(argc, argv, MPI_COMM_WORLD);
+    bench_mpit_init(MPI_COMM_WORLD);
+    bench_skew_init(MPI_COMM_WORLD);
 
     int max_elements = elements;
 
@@ -115,7 +117,9 @@ int main (int argc, char *argv[])
         }
 
         // execute the allreduce test
+        bench_skew_begin(MPI_COMM_WORLD, niter);
         MPI_Barrier(MPI_COMM_WORLD);
+        bench_mpit_begin();
         t1s = std::chrono::high_resolution_clock::now();
         ret = bcast_test (sendbuf->get_buffer(), elements, MPI_DOUBLE, MPI_COMM_WORLD, niter);
         if (MPI_SUCCESS != ret) {
@@ -151,6 +155,8 @@ int main (int argc, char *argv[])
     }
     delete (sendbuf);
 
+    bench_mpit_finalize();
+    bench_skew_finalize();
     MPI_Finalize ();
     return ret;
 }
@@ -162,7 +168,11 @@ int bcast_test ( void *sendbuf, int count, MPI_Datatype datatype, MPI_Comm comm,
     int ret;
 
     for (int i=0; i<niterations; i++) {
+        BENCH_SKEW_ENTER(i);
+        HIP_MPITEST_TRACE_BEGIN();
         ret = MPI_Bcast (sendbuf, count, datatype, ROOT, comm);
+        HIP_MPITEST_TRACE_END("MPI_Bcast", count, datatype);
+        BENCH_SKEW_EXIT(i);
         if (MPI_SUCCESS != ret) {
             return ret;
         }
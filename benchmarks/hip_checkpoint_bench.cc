@@ -0,0 +1,473 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include "mpi.h"
+
+#include <hip/hip_runtime.h>
+#include <chrono>
+
+#include "hip_mpitest_utils.h"
+#include "hip_mpitest_buffer.h"
+#include "hip_mpitest_bench.h"
+
+#define CKPT_MIN_EDGE 4
+#define CKPT_MAX_VARS 16
+#define CKPT_MAX_DIMS 3
+int elements=64;
+hip_mpitest_buffer *sendbuf=NULL;
+hip_mpitest_buffer *recvbuf=NULL;
+
+/*
+** Checkpoint/restart proxy.
+**
+** The processes are arranged in an N-dimensional Cartesian grid created with
+** MPI_Dims_create, i.e. any number of processes is supported. Every process
+** owns a block of edge^ndims cells of a global array, surrounded by a layer of
+** ghost cells, for each of a set of variables of possibly different types. A
+** checkpoint step writes the interior cells of all variables with a single
+** MPI_File_write_all: the memory datatype is a struct of subarrays excluding
+** the ghost cells, the file view a struct of subarrays of the global arrays,
+** which are stored one variable after the other. The restart reads the last
+** step back into the receive buffer with a single MPI_File_read_all.
+**
+** For edge lengths doubled from 4 up to the value given with -n, the average
+** write bandwidth per step (including MPI_File_sync) and the restart read
+** bandwidth in GB/s are reported, the time being the maximum over all processes.
+**
+** The benchmark is configured by environment variables:
+**   HIP_MPITEST_CKPT_NDIMS   number of dimensions, 1 to 3 (default 3)
+**   HIP_MPITEST_CKPT_GHOSTS  width of the ghost cell layer (default 1)
+**   HIP_MPITEST_CKPT_VARS    comma separated list of variable types, int, long,
+**                            float or double (default double,double,double,float,int)
+**   HIP_MPITEST_CKPT_STEPS   number of checkpoint steps per file (default 3)
+**   HIP_MPITEST_IO_FILE      file name (default hip_checkpoint_bench.out)
+**   HIP_MPITEST_IO_DIR       directory of the file (default: working directory)
+**   HIP_MPITEST_IO_HINTS     comma separated list of key=value pairs passed to
+**                            MPI_File_open (default: no hints)
+*/
+
+static const char   *ckpt_type_names[] = {"int", "long", "float", "double", NULL};
+static MPI_Datatype  ckpt_mpi_types[]  = {MPI_INT, MPI_LONG, MPI_FLOAT, MPI_DOUBLE};
+static const int     ckpt_type_sizes[] = {sizeof(int), sizeof(long), sizeof(float), sizeof(double)};
+
+static int  ckpt_ndims=3;
+static int  ckpt_ghosts=1;
+static int  ckpt_nsteps=3;
+static int  ckpt_nvars=0;
+static int  ckpt_vars[CKPT_MAX_VARS];
+static char ckpt_filename[256];
+
+static int  ckpt_dims[CKPT_MAX_DIMS], ckpt_coords[CKPT_MAX_DIMS];
+static int  ckpt_edge;
+static long ckpt_local_cells;                 // cells per variable including ghost cells
+static long ckpt_global_cells;                // cells per variable of the global array
+static long ckpt_var_offset[CKPT_MAX_VARS];   // offset of each variable in the buffers
+
+static int ckpt_init (MPI_Comm comm, MPI_Comm *cartcomm)
+{
+    char *env, *saveptr, *str;
+    int rank, size, periods[CKPT_MAX_DIMS]={0,0,0};
+
+    MPI_Comm_rank (comm, &rank);
+    MPI_Comm_size (comm, &size);
+
+    env = getenv("HIP_MPITEST_CKPT_NDIMS");
+    if (NULL != env) {
+        ckpt_ndims = atoi(env);
+    }
+    env = getenv("HIP_MPITEST_CKPT_GHOSTS");
+    if (NULL != env) {
+        ckpt_ghosts = atoi(env);
+    }
+    env = getenv("HIP_MPITEST_CKPT_STEPS");
+    if (NULL != env) {
+        ckpt_nsteps = atoi(env);
+    }
+    env = getenv("HIP_MPITEST_IO_FILE");
+    hip_mpitest_io_path (NULL != env ? env : "hip_checkpoint_bench.out", ckpt_filename, sizeof(ckpt_filename));
+    if (ckpt_ndims < 1 || ckpt_ndims > CKPT_MAX_DIMS || ckpt_ghosts < 0 || ckpt_nsteps < 1) {
+        if (rank == 0) {
+            fprintf(stderr, "Invalid number of dimensions, ghost cells or steps\n");
+        }
+        return MPI_ERR_ARG;
+    }
+
+    env = getenv("HIP_MPITEST_CKPT_VARS");
+    str = strdup(NULL != env ? env : "double,double,double,float,int");
+    for (char *s = strtok_r(str, ",", &saveptr); s != NULL; s = strtok_r(NULL, ",", &saveptr)) {
+        int t;
+        for (t=0; ckpt_type_names[t] != NULL; t++) {
+            if (strcmp(s, ckpt_type_names[t]) == 0) {
+                break;
+            }
+        }
+        if (NULL == ckpt_type_names[t] || ckpt_nvars == CKPT_MAX_VARS) {
+            if (rank == 0) {
+                fprintf(stderr, "Invalid value in HIP_MPITEST_CKPT_VARS: %s\n", s);
+            }
+            free (str);
+            return MPI_ERR_ARG;
+        }
+        ckpt_vars[ckpt_nvars++] = t;
+    }
+    free (str);
+    if (ckpt_nvars == 0) {
+        return MPI_ERR_ARG;
+    }
+
+    for (int d=0; d<ckpt_ndims; d++) {
+        ckpt_dims[d] = 0;
+    }
+    MPI_Dims_create (size, ckpt_ndims, ckpt_dims);
+    MPI_Cart_create (comm, ckpt_ndims, ckpt_dims, periods, 0, cartcomm);
+    MPI_Cart_coords (*cartcomm, rank, ckpt_ndims, ckpt_coords);
+
+    return MPI_SUCCESS;
+}
+
+// Sets the edge length of the local block, returns the size of the buffers in bytes
+static long ckpt_set_edge (int edge)
+{
+    long offset = 0;
+
+    ckpt_edge = edge;
+    ckpt_local_cells = 1;
+    ckpt_global_cells = 1;
+    for (int d=0; d<ckpt_ndims; d++) {
+        ckpt_local_cells  *= edge + 2 * ckpt_ghosts;
+        ckpt_global_cells *= (long)ckpt_dims[d] * edge;
+    }
+    for (int v=0; v<ckpt_nvars; v++) {
+        ckpt_var_offset[v] = offset;
+        offset += ckpt_local_cells * ckpt_type_sizes[ckpt_vars[v]];
+    }
+    return offset;
+}
+
+// Expected value of local cell c of variable v, -1 for ghost cells
+static double ckpt_value (int v, long c)
+{
+    int lsize = ckpt_edge + 2 * ckpt_ghosts;
+    long gidx = 0, stride = 1;
+
+    for (int d=ckpt_ndims-1; d>=0; d--) {
+        int i = (int)(c % lsize) - ckpt_ghosts;
+        c /= lsize;
+        if (i < 0 || i >= ckpt_edge) {
+            return -1.0;
+        }
+        gidx   += ((long)ckpt_coords[d] * ckpt_edge + i) * stride;
+        stride *= (long)ckpt_dims[d] * ckpt_edge;
+    }
+    // exactly representable as float
+    return (double)(gidx % 1048576 + v + 1);
+}
+
+static void ckpt_store (char *buf, int v, long c, double value)
+{
+    char *p = buf + ckpt_var_offset[v];
+
+    switch (ckpt_vars[v]) {
+    case 0:  ((int *)p)[c]    = (int)value;   break;
+    case 1:  ((long *)p)[c]   = (long)value;  break;
+    case 2:  ((float *)p)[c]  = (float)value; break;
+    default: ((double *)p)[c] = value;        break;
+    }
+}
+
+static double ckpt_load (char *buf, int v, long c)
+{
+    char *p = buf + ckpt_var_offset[v];
+
+    switch (ckpt_vars[v]) {
+    case 0:  return ((int *)p)[c];
+    case 1:  return ((long *)p)[c];
+    case 2:  return ((float *)p)[c];
+    default: return ((double *)p)[c];
+    }
+}
+
+static void init_sendbuf (char *sendbuf, long nbytes, int mynode)
+{
+    for (int v=0; v<ckpt_nvars; v++) {
+        for (long c=0; c<ckpt_local_cells; c++) {
+            ckpt_store (sendbuf, v, c, ckpt_value(v, c));
+        }
+    }
+}
+
+static void init_recvbuf (char *recvbuf, long nbytes)
+{
+    for (int v=0; v<ckpt_nvars; v++) {
+        for (long c=0; c<ckpt_local_cells; c++) {
+            ckpt_store (recvbuf, v, c, -1.0);
+        }
+    }
+}
+
+// the interior cells have to be restored and the ghost cells left untouched
+static bool check_recvbuf (char *recvbuf)
+{
+    bool res=true;
+
+    for (int v=0; v<ckpt_nvars && res; v++) {
+        for (long c=0; c<ckpt_local_cells; c++) {
+            if (ckpt_load(recvbuf, v, c) != ckpt_value(v, c)) {
+                res = false;
+#ifdef VERBOSE
+                printf("variable %d cell %ld = %lf expected %lf\n", v, c, ckpt_load(recvbuf, v, c),
+                       ckpt_value(v, c));
+#endif
+                break;
+            }
+        }
+    }
+
+    return res;
+}
+
+/*
+** Creates the datatypes of one checkpoint step: the interior cells of all
+** variables in the local buffer (memtype) and their location in the global
+** arrays stored one after the other in the file (filetype).
+*/
+static void ckpt_create_types (MPI_Datatype *memtype, MPI_Datatype *filetype)
+{
+    int lsizes[CKPT_MAX_DIMS], gsizes[CKPT_MAX_DIMS], subsizes[CKPT_MAX_DIMS];
+    int lstarts[CKPT_MAX_DIMS], gstarts[CKPT_MAX_DIMS];
+    int blocklens[CKPT_MAX_VARS];
+    MPI_Aint mdispls[CKPT_MAX_VARS], fdispls[CKPT_MAX_VARS], foffset = 0;
+    MPI_Datatype mtypes[CKPT_MAX_VARS], ftypes[CKPT_MAX_VARS];
+
+    for (int d=0; d<ckpt_ndims; d++) {
+        lsizes[d]   = ckpt_edge + 2 * ckpt_ghosts;
+        lstarts[d]  = ckpt_ghosts;
+        gsizes[d]   = ckpt_dims[d] * ckpt_edge;
+        gstarts[d]  = ckpt_coords[d] * ckpt_edge;
+        subsizes[d] = ckpt_edge;
+    }
+
+    for (int v=0; v<ckpt_nvars; v++) {
+        MPI_Datatype type = ckpt_mpi_types[ckpt_vars[v]];
+
+        MPI_Type_create_subarray (ckpt_ndims, lsizes, subsizes, lstarts, MPI_ORDER_C, type, &mtypes[v]);
+        MPI_Type_create_subarray (ckpt_ndims, gsizes, subsizes, gstarts, MPI_ORDER_C, type, &ftypes[v]);
+        blocklens[v] = 1;
+        mdispls[v]   = ckpt_var_offset[v];
+        fdispls[v]   = foffset;
+        foffset     += ckpt_global_cells * ckpt_type_sizes[ckpt_vars[v]];
+    }
+    MPI_Type_create_struct (ckpt_nvars, blocklens, mdispls, mtypes, memtype);
+    MPI_Type_create_struct (ckpt_nvars, blocklens, fdispls, ftypes, filetype);
+    MPI_Type_commit (memtype);
+    MPI_Type_commit (filetype);
+
+    for (int v=0; v<ckpt_nvars; v++) {
+        MPI_Type_free (&mtypes[v]);
+        MPI_Type_free (&ftypes[v]);
+    }
+}
+
+static int ckpt_run (int edge, MPI_Info info, MPI_Comm comm)
+{
+    int ret = MPI_SUCCESS;
+    int rank, size;
+    long nbytes = ckpt_set_edge (edge);
+    MPI_Offset step_bytes = 0;
+    MPI_File fh;
+    MPI_Datatype memtype = MPI_DATATYPE_NULL, filetype = MPI_DATATYPE_NULL;
+    char *tmp_sendbuf=NULL, *tmp_recvbuf=NULL;
+    std::chrono::high_resolution_clock::time_point t1s, t1e;
+    double t[2], tmax[2];
+
+    MPI_Comm_rank (comm, &rank);
+    MPI_Comm_size (comm, &size);
+
+    // Initialise send buffer
+    ALLOCATE_SENDBUFFER(sendbuf, tmp_sendbuf, char, nbytes, 1, rank, comm, init_sendbuf, out);
+
+    // Initialize recv buffer
+    ALLOCATE_RECVBUFFER(recvbuf, tmp_recvbuf, char, nbytes, 1, rank, comm, init_recvbuf, out);
+
+    ckpt_create_types (&memtype, &filetype);
+    for (int v=0; v<ckpt_nvars; v++) {
+        step_bytes += ckpt_global_cells * ckpt_type_sizes[ckpt_vars[v]];
+    }
+
+    if (rank == 0) {
+        MPI_File_delete (ckpt_filename, MPI_INFO_NULL);
+    }
+    MPI_Barrier (comm);
+
+    // checkpoint: one collective write of all variables per step
+    ret = MPI_File_open (comm, ckpt_filename, MPI_MODE_CREATE|MPI_MODE_WRONLY, info, &fh);
+    if (MPI_SUCCESS != ret) {
+        fprintf(stderr, "Error opening %s. Aborting\n", ckpt_filename);
+        goto out;
+    }
+    MPI_Barrier (comm);
+    t1s = std::chrono::high_resolution_clock::now();
+    for (int step=0; step<ckpt_nsteps && MPI_SUCCESS == ret; step++) {
+        ret = MPI_File_set_view (fh, step * step_bytes, MPI_BYTE, filetype, "native", info);
+        if (MPI_SUCCESS != ret) {
+            break;
+        }
+        HIP_MPITEST_TRACE_BEGIN();
+        ret = MPI_File_write_all (fh, sendbuf->get_buffer(), 1, memtype, MPI_STATUS_IGNORE);
+        HIP_MPITEST_TRACE_END("MPI_File_write_all", 1, memtype);
+        if (MPI_SUCCESS == ret) {
+            ret = MPI_File_sync (fh);
+        }
+    }
+    t1e = std::chrono::high_resolution_clock::now();
+    t[0] = std::chrono::duration<double>(t1e-t1s).count();
+    MPI_File_close (&fh);
+    if (MPI_SUCCESS != ret) {
+        fprintf(stderr, "Error writing checkpoint. Aborting\n");
+        goto out;
+    }
+
+    // restart: read the last step
+    ret = MPI_File_open (comm, ckpt_filename, MPI_MODE_RDONLY, info, &fh);
+    if (MPI_SUCCESS != ret) {
+        fprintf(stderr, "Error opening %s. Aborting\n", ckpt_filename);
+        goto out;
+    }
+    ret = MPI_File_set_view (fh, (ckpt_nsteps - 1) * step_bytes, MPI_BYTE, filetype, "native", info);
+    if (MPI_SUCCESS == ret) {
+        MPI_Barrier (comm);
+        t1s = std::chrono::high_resolution_clock::now();
+        HIP_MPITEST_TRACE_BEGIN();
+        ret = MPI_File_read_all (fh, recvbuf->get_buffer(), 1, memtype, MPI_STATUS_IGNORE);
+        HIP_MPITEST_TRACE_END("MPI_File_read_all", 1, memtype);
+        t1e = std::chrono::high_resolution_clock::now();
+        t[1] = std::chrono::duration<double>(t1e-t1s).count();
+    }
+    MPI_File_close (&fh);
+    if (MPI_SUCCESS != ret) {
+        fprintf(stderr, "Error reading checkpoint. Aborting\n");
+        goto out;
+    }
+
+#if 0
+    // verify results
+    bool res, fret;
+    res = true;
+    if (recvbuf->NeedsStagingBuffer()) {
+        HIP_CHECK(recvbuf->CopyFrom(tmp_recvbuf, nbytes));
+        res = check_recvbuf(tmp_recvbuf);
+    }
+    else {
+        res = check_recvbuf((char*) recvbuf->get_buffer());
+    }
+
+    fret = report_testresult((char *)"checkpoint", comm, sendbuf->get_memchar(), recvbuf->get_memchar(), res);
+#endif
+
+    MPI_Reduce (t, tmax, 2, MPI_DOUBLE, MPI_MAX, 0, comm);
+    if (rank == 0) {
+        double gb = (double)step_bytes / 1e9;
+        printf("%8d %12ld %14lld \t %8.3lf %8.3lf\n", edge, ckpt_global_cells, (long long)step_bytes,
+               gb * ckpt_nsteps / tmax[0], gb / tmax[1]);
+    }
+
+ out:
+    if (MPI_DATATYPE_NULL != memtype) {
+        MPI_Type_free (&memtype);
+        MPI_Type_free (&filetype);
+    }
+    //Free buffers
+    FREE_BUFFER(sendbuf, tmp_sendbuf);
+    FREE_BUFFER(recvbuf, tmp_recvbuf);
+
+    return ret;
+}
+
+int main (int argc, char *argv[])
+{
+    int ret = MPI_SUCCESS;
+    int rank, size;
+    char *env;
+    MPI_Comm cartcomm = MPI_COMM_NULL;
+    MPI_Info info = MPI_INFO_NULL;
+
+    bind_device();
+
+    MPI_Init      (&argc, &argv);
+    MPI_Comm_size (MPI_COMM_WORLD, &size);
+    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+
+    parse_args(argc, argv, MPI_COMM_WORLD);
+
+    ret = ckpt_init (MPI_COMM_WORLD, &cartcomm);
+    if (MPI_SUCCESS != ret) {
+        goto out;
+    }
+    env = getenv("HIP_MPITEST_IO_HINTS");
+    if (NULL != env) {
+        info = bench_create_info (env);
+    }
+
+    if (rank == 0 ) {
+        printf("Benchmark: %s %c %c - %d processes\n", argv[0],  sendbuf->get_memchar(), recvbuf->get_memchar(), size);
+        printf("File: %s, %d steps, %d ghost cells, process grid", ckpt_filename, ckpt_nsteps, ckpt_ghosts);
+        for (int d=0; d<ckpt_ndims; d++) {
+            printf("%s%d", d == 0 ? " " : "x", ckpt_dims[d]);
+        }
+        printf(", variables");
+        for (int v=0; v<ckpt_nvars; v++) {
+            printf("%s%s", v == 0 ? " " : ",", ckpt_type_names[ckpt_vars[v]]);
+        }
+        printf("\n\n");
+        printf("%8s %12s %14s \t %8s %8s\n", "edge", "cells/var", "bytes/step", "wr GB/s", "rd GB/s");
+        printf("=====================================================================\n");
+    }
+
+    for (int edge = CKPT_MIN_EDGE; edge <= elements; edge *= 2) {
+        ret = ckpt_run (edge, info, cartcomm);
+        if (MPI_SUCCESS != ret) {
+            goto out;
+        }
+    }
+
+ out:
+    if (rank == 0) {
+        MPI_File_delete (ckpt_filename, MPI_INFO_NULL);
+    }
+    if (MPI_INFO_NULL != info) {
+        MPI_Info_free (&info);
+    }
+    if (MPI_COMM_NULL != cartcomm) {
+        MPI_Comm_free (&cartcomm);
+    }
+    delete (sendbuf);
+    delete (recvbuf);
+
+    if (MPI_SUCCESS != ret ) {
+        MPI_Abort (MPI_COMM_WORLD, 1);
+        return 1;
+    }
+    MPI_Finalize ();
+    return ret;
+}
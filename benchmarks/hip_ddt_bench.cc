@@ -0,0 +1,334 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include "mpi.h"
+
+#include <hip/hip_runtime.h>
+#include <chrono>
+
+#include "hip_mpitest_utils.h"
+#include "hip_mpitest_buffer.h"
+#include "hip_mpitest_bench.h"
+#include "hip_mpitest_datatype_catalog.h"
+
+#define NITER_LONG   25
+#define NITER_SHORT  200
+#define NITER_THRESH 1048576
+#define MAX_GAPS     16
+#define MAX_TYPES    16
+int elements=100;
+hip_mpitest_buffer *sendbuf=NULL;
+hip_mpitest_buffer *recvbuf=NULL;
+
+/*
+** Derived datatype benchmark sweeping the layout of the test datatypes.
+**
+** For every datatype, block length, gap and count the throughput of
+**   pack:   MPI_Pack from the send buffer into a contiguous buffer
+**   unpack: MPI_Unpack from a contiguous buffer into the send buffer
+**   p2p:    MPI_Isend/MPI_Irecv of the datatype in a ring
+**   contig: MPI_Isend/MPI_Irecv of the same number of bytes, contiguous
+** is reported in MB/s of type data, together with the ratio p2p/contig.
+**
+** The sweep is configured by environment variables:
+**   HIP_MPITEST_DDT_TYPES         comma separated list of datatypes (default: all)
+**   HIP_MPITEST_DDT_MAX_BLOCKLEN  maximum block length in integers (default 1024),
+**                                 the block length is multiplied by 4 starting at 1
+**   HIP_MPITEST_DDT_GAPS          comma separated list of gaps in integers (default 1,32)
+** The count is doubled from 1 up to the number of elements given with -n. The
+** layout of darray does not depend on the gap, it is measured with the first gap only.
+*/
+
+static int ddt_ring_test (void *sendbuf, int scount, MPI_Datatype stype,
+                          void *recvbuf, int rcount, MPI_Datatype rtype,
+                          MPI_Comm comm, int niterations);
+static int ddt_pack_test (void *inbuf, void *outbuf, int count, MPI_Datatype datatype,
+                          bool unpack, MPI_Comm comm, int niterations);
+
+static double ddt_time (double t, int niter, MPI_Comm comm)
+{
+    double tsum=0.0;
+    int size;
+
+    MPI_Comm_size (comm, &size);
+    MPI_Reduce(&t, &tsum, 1, MPI_DOUBLE, MPI_SUM, 0, comm);
+    return tsum/(size*niter);
+}
+
+static int ddt_run (const char *name, int blocklen, int gap, int count, MPI_Comm comm)
+{
+    int ret = MPI_SUCCESS;
+    int rank, size, niter, type_size;
+    MPI_Aint extent;
+    char *tmp_sendbuf=NULL, *tmp_recvbuf=NULL;
+    std::chrono::high_resolution_clock::time_point t1s, t1e;
+    double tpack, tunpack, tp2p, tcontig;
+
+    MPI_Comm_rank (comm, &rank);
+    MPI_Comm_size (comm, &size);
+
+    hip_mpitest_datatype *dat = hip_mpitest_datatype_create(name, blocklen, gap);
+    if (NULL == dat) {
+        if (rank == 0) {
+            fprintf(stderr, "Unknown datatype %s\n", name);
+        }
+        return MPI_ERR_TYPE;
+    }
+    type_size = dat->get_size();
+    extent    = dat->get_extent();
+    niter     = (long)count * type_size >= NITER_THRESH ? NITER_LONG : NITER_SHORT;
+
+    // Initialise send buffer
+    ALLOCATE_SENDBUFFER(sendbuf, tmp_sendbuf, char, count, extent,
+                        rank, comm, dat->init_sendbuf, out);
+
+    // Initialize recv buffer
+    ALLOCATE_RECVBUFFER(recvbuf, tmp_recvbuf, char, count, extent,
+                        rank, comm, dat->init_recvbuf, out);
+
+    //Warmup
+    ret = ddt_ring_test (sendbuf->get_buffer(), count, dat->get_mpi_type(),
+                         recvbuf->get_buffer(), count, dat->get_mpi_type(), comm, 1);
+    if (MPI_SUCCESS != ret) {
+        fprintf(stderr, "Error in ddt_ring_test. Aborting\n");
+        goto out;
+    }
+
+    MPI_Barrier(comm);
+    t1s = std::chrono::high_resolution_clock::now();
+    ret = ddt_ring_test (sendbuf->get_buffer(), count, dat->get_mpi_type(),
+                         recvbuf->get_buffer(), count, dat->get_mpi_type(), comm, niter);
+    if (MPI_SUCCESS != ret) {
+        fprintf(stderr, "Error in ddt_ring_test. Aborting\n");
+        goto out;
+    }
+    t1e = std::chrono::high_resolution_clock::now();
+    tp2p = std::chrono::duration<double>(t1e-t1s).count();
+
+#if 0
+    // verify results
+    bool res, fret;
+    res = true;
+    if (recvbuf->NeedsStagingBuffer()) {
+        HIP_CHECK(recvbuf->CopyFrom(tmp_recvbuf, count*extent));
+        res = dat->check_recvbuf(tmp_recvbuf, size, rank, count);
+    }
+    else {
+        res = dat->check_recvbuf(recvbuf->get_buffer(), size, rank, count);
+    }
+
+    fret = report_testresult((char *)name, comm, sendbuf->get_memchar(), recvbuf->get_memchar(), res);
+#endif
+
+    ret = ddt_ring_test (sendbuf->get_buffer(), count*type_size, MPI_BYTE,
+                         recvbuf->get_buffer(), count*type_size, MPI_BYTE, comm, 1);
+    if (MPI_SUCCESS != ret) {
+        fprintf(stderr, "Error in ddt_ring_test. Aborting\n");
+        goto out;
+    }
+    MPI_Barrier(comm);
+    t1s = std::chrono::high_resolution_clock::now();
+    ret = ddt_ring_test (sendbuf->get_buffer(), count*type_size, MPI_BYTE,
+                         recvbuf->get_buffer(), count*type_size, MPI_BYTE, comm, niter);
+    if (MPI_SUCCESS != ret) {
+        fprintf(stderr, "Error in ddt_ring_test. Aborting\n");
+        goto out;
+    }
+    t1e = std::chrono::high_resolution_clock::now();
+    tcontig = std::chrono::duration<double>(t1e-t1s).count();
+
+    // pack from the send buffer into the receive buffer and unpack it back
+    ret = ddt_pack_test (sendbuf->get_buffer(), recvbuf->get_buffer(), count, dat->get_mpi_type(),
+                         false, comm, 1);
+    if (MPI_SUCCESS != ret) {
+        fprintf(stderr, "Error in ddt_pack_test. Aborting\n");
+        goto out;
+    }
+    t1s = std::chrono::high_resolution_clock::now();
+    ret = ddt_pack_test (sendbuf->get_buffer(), recvbuf->get_buffer(), count, dat->get_mpi_type(),
+                         false, comm, niter);
+    if (MPI_SUCCESS != ret) {
+        fprintf(stderr, "Error in ddt_pack_test. Aborting\n");
+        goto out;
+    }
+    t1e = std::chrono::high_resolution_clock::now();
+    tpack = std::chrono::duration<double>(t1e-t1s).count();
+
+    t1s = std::chrono::high_resolution_clock::now();
+    ret = ddt_pack_test (recvbuf->get_buffer(), sendbuf->get_buffer(), count, dat->get_mpi_type(),
+                         true, comm, niter);
+    if (MPI_SUCCESS != ret) {
+        fprintf(stderr, "Error in ddt_pack_test. Aborting\n");
+        goto out;
+    }
+    t1e = std::chrono::high_resolution_clock::now();
+    tunpack = std::chrono::duration<double>(t1e-t1s).count();
+
+    tp2p    = ddt_time(tp2p, niter, comm);
+    tcontig = ddt_time(tcontig, niter, comm);
+    tpack   = ddt_time(tpack, niter, comm);
+    tunpack = ddt_time(tunpack, niter, comm);
+    if (rank == 0) {
+        double mb = (double)count * type_size / 1e6;
+        printf("%-14s %8d %6d %8d %12ld \t %10.2lf %10.2lf %10.2lf %10.2lf \t %6.3lf\n",
+               name, blocklen, gap, count, (long)count * type_size, mb/tpack, mb/tunpack,
+               mb/tp2p, mb/tcontig, tcontig/tp2p);
+    }
+
+ out:
+    //Free buffers
+    FREE_BUFFER(sendbuf, tmp_sendbuf);
+    FREE_BUFFER(recvbuf, tmp_recvbuf);
+    delete (dat);
+
+    return ret;
+}
+
+int main (int argc, char *argv[])
+{
+    int ret = MPI_SUCCESS;
+    int rank, size;
+    int max_blocklen, ngaps=0, gaps[MAX_GAPS], ntypes=0, types[MAX_TYPES];
+    char defgaps[32];
+
+    bind_device();
+
+    MPI_Init      (&argc, &argv);
+    MPI_Comm_size (MPI_COMM_WORLD, &size);
+    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+
+    parse_args(argc, argv, MPI_COMM_WORLD);
+
+    max_blocklen = hip_mpitest_datatype_param("HIP_MPITEST_DDT_MAX_BLOCKLEN", 1024, 1);
+    snprintf(defgaps, sizeof(defgaps), "1,%d", GAPSIZE);
+    ngaps = bench_parse_ints ("HIP_MPITEST_DDT_GAPS", defgaps, 0, false, gaps, MAX_GAPS, MPI_COMM_WORLD);
+    ntypes = bench_parse_names ("HIP_MPITEST_DDT_TYPES", NULL, hip_mpitest_datatype_names,
+                                types, MAX_TYPES, MPI_COMM_WORLD);
+    if (ngaps < 0 || ntypes < 0) {
+        MPI_Abort (MPI_COMM_WORLD, 1);
+        return 1;
+    }
+
+    if (rank == 0 ) {
+        printf("Benchmark: %s %c %c - %d processes\n\n", argv[0],  sendbuf->get_memchar(), recvbuf->get_memchar(), size);
+        printf("%-14s %8s %6s %8s %12s \t %10s %10s %10s %10s \t %6s\n", "Datatype", "blocklen",
+               "gap", "count", "bytes", "pack", "unpack", "p2p", "contig", "ratio");
+        printf("==================================================================================================================\n");
+    }
+
+    for (int t=0; t<ntypes; t++) {
+        const char *name = hip_mpitest_datatype_names[types[t]];
+        // darray ignores the gap
+        int tgaps = strcmp(name, "darray") == 0 ? 1 : ngaps;
+
+        for (int blocklen = 1; blocklen <= max_blocklen; blocklen *= 4) {
+            for (int g=0; g<tgaps; g++) {
+                for (int count = 1; count <= elements; count *= 2) {
+                    ret = ddt_run(name, blocklen, gaps[g], count, MPI_COMM_WORLD);
+                    if (MPI_SUCCESS != ret) {
+                        goto out;
+                    }
+                }
+            }
+        }
+    }
+
+ out:
+    delete (sendbuf);
+    delete (recvbuf);
+
+    if (MPI_SUCCESS != ret ) {
+        MPI_Abort (MPI_COMM_WORLD, 1);
+        return 1;
+    }
+    MPI_Finalize ();
+    return ret;
+}
+
+
+static int ddt_ring_test (void *sendbuf, int scount, MPI_Datatype stype,
+                          void *recvbuf, int rcount, MPI_Datatype rtype,
+                          MPI_Comm comm, int niterations)
+{
+    int size, rank, ret;
+    int tag=251;
+    MPI_Request reqs[2];
+
+    MPI_Comm_size (comm, &size);
+    MPI_Comm_rank (comm, &rank);
+
+    // send buffer to right, receive from left
+    int left = rank - 1;
+    if (left < 0) left = size-1;
+    int right = rank + 1;
+    if (right == size) right = 0;
+
+    for (int i=0; i<niterations; i++) {
+        HIP_MPITEST_TRACE_BEGIN();
+        ret = MPI_Irecv (recvbuf, rcount, rtype, left, tag, comm, &reqs[1]);
+        if (MPI_SUCCESS != ret) {
+            return ret;
+        }
+        ret = MPI_Isend (sendbuf, scount, stype, right, tag, comm, &reqs[0]);
+        if (MPI_SUCCESS != ret) {
+            return ret;
+        }
+        ret = MPI_Waitall(2, reqs, MPI_STATUSES_IGNORE);
+        if (MPI_SUCCESS != ret) {
+            return ret;
+        }
+        HIP_MPITEST_TRACE_END("MPI_Isend/MPI_Irecv", scount, stype);
+    }
+
+    return MPI_SUCCESS;
+}
+
+static int ddt_pack_test (void *inbuf, void *outbuf, int count, MPI_Datatype datatype,
+                          bool unpack, MPI_Comm comm, int niterations)
+{
+    int      ret, pos;
+    int      type_size;
+    MPI_Aint lb, type_extent;
+
+    MPI_Type_size(datatype, &type_size);
+    MPI_Type_get_extent(datatype, &lb, &type_extent);
+
+    for (int i=0; i<niterations; i++) {
+        pos = 0;
+        HIP_MPITEST_TRACE_BEGIN();
+        if (unpack) {
+            ret = MPI_Unpack(inbuf, type_size*count, &pos, outbuf, count, datatype, comm);
+            HIP_MPITEST_TRACE_END("MPI_Unpack", count, datatype);
+        }
+        else {
+            ret = MPI_Pack(inbuf, count, datatype, outbuf, type_extent*count, &pos, comm);
+            HIP_MPITEST_TRACE_END("MPI_Pack", count, datatype);
+        }
+        if (MPI_SUCCESS != ret) {
+            return ret;
+        }
+    }
+
+    return MPI_SUCCESS;
+}
@@ -0,0 +1,555 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include "mpi.h"
+
+#include <hip/hip_runtime.h>
+#include <chrono>
+#include <vector>
+
+#include "hip_mpitest_utils.h"
+#include "hip_mpitest_buffer.h"
+#include "hip_mpitest_bench.h"
+#include "hip_mpitest_rawio.h"
+
+#define IO_MIN_ELEMENTS 1024
+#define IO_MAX_LIST     16
+int elements=16*1024*1024;
+hip_mpitest_buffer *sendbuf=NULL;
+hip_mpitest_buffer *recvbuf=NULL;
+
+/*
+** Parallel file I/O benchmark.
+**
+** Every process writes and reads back count longs from the send and receive
+** buffer, with count multiplied by 4 from 1024 up to the number of elements
+** given with -n. For every configuration the aggregate write (including
+** MPI_File_sync) and read bandwidth in GB/s is reported, the time being the
+** maximum over all processes.
+**
+** The sweep is configured by environment variables, all of them comma
+** separated lists:
+**   HIP_MPITEST_IO_LAYOUT  contig: one contiguous block per process (segmented)
+**                          interleaved: blocks of HIP_MPITEST_IO_BLOCK elements
+**                          (default 1024) assigned round-robin to the processes
+**                          2d, 3d: subarray of a global 2D/3D array decomposed
+**                          over the processes, the local block holds the
+**                          largest square/cube of at most count elements
+**                          (default contig,2d,3d)
+**   HIP_MPITEST_IO_FILES   shared: one file for all processes, process: one
+**                          file per process, node: one file per node (processes
+**                          sharing memory), or a number of files, each shared
+**                          by a consecutive range of ranks (default shared).
+**                          The layout applies to the processes of each file.
+**   HIP_MPITEST_IO_ACCESS  independent (MPI_File_write/read) or collective
+**                          (MPI_File_write_all/read_all) (default both), or
+**                          raw: the reference path of hip_mpitest_rawio.h
+**                          bypassing MPI-IO, from the host copy of the buffers
+**                          and only for the contig layout in blocking mode
+**   HIP_MPITEST_IO_MODE    blocking or nonblocking, the latter splits the
+**                          transfer into HIP_MPITEST_IO_NBLOCKS (default 8)
+**                          MPI_File_iwrite(_all)/iread(_all) operations (default both)
+**   HIP_MPITEST_IO_HINTS   list of hint sets separated by ';', each a comma
+**                          separated list of key=value pairs passed to
+**                          MPI_File_open, e.g. "cb_nodes=2,cb_buffer_size=16777216;
+**                          romio_cb_write=enable;striping_factor=4" (default: no hints)
+** The file name is given by HIP_MPITEST_IO_FILE (default hip_file_io_bench.out),
+** with multiple files extended by the index of the file, in the directory
+** HIP_MPITEST_IO_DIR (default: working directory). The number of repetitions
+** per configuration is given by HIP_MPITEST_IO_NREP (default 3).
+** The files are deleted before every configuration such that striping hints
+** apply. The time to create and open the files is reported separately as the
+** metadata cost.
+*/
+
+#define IO_CONTIG 0
+#define IO_2D     1
+#define IO_3D     2
+#define IO_INTERLEAVED 3
+
+#define IO_FILES_PROCESS -1
+#define IO_FILES_NODE    -2
+
+static const char *io_layout_names[] = {"contig", "2d", "3d", "interleaved", NULL};
+#define IO_RAW    2
+
+static const char *io_access_names[] = {"independent", "collective", "raw", NULL};
+static const char *io_mode_names[]   = {"blocking", "nonblocking", NULL};
+
+static int  io_nlayouts=0, io_layouts[IO_MAX_LIST];
+static int  io_naccess=0, io_access[IO_MAX_LIST];
+static int  io_nmodes=0, io_modes[IO_MAX_LIST];
+static int  io_nfiles=0, io_files[IO_MAX_LIST];
+static int  io_nblocks=8;
+static int  io_blocklen=1024;
+static int  io_nrep=3;
+static char io_filename[256];
+
+// Parses HIP_MPITEST_IO_FILES, the number of files is stored or IO_FILES_PROCESS/NODE
+static int io_parse_files (MPI_Comm comm)
+{
+    char *env = getenv("HIP_MPITEST_IO_FILES");
+    char *saveptr, *str = strdup(NULL != env ? env : "shared");
+    int rank, n = 0;
+
+    MPI_Comm_rank (comm, &rank);
+    for (char *s = strtok_r(str, ",", &saveptr); s != NULL && n < IO_MAX_LIST;
+         s = strtok_r(NULL, ",", &saveptr)) {
+        if (strcmp(s, "shared") == 0) {
+            io_files[n++] = 1;
+        }
+        else if (strcmp(s, "process") == 0) {
+            io_files[n++] = IO_FILES_PROCESS;
+        }
+        else if (strcmp(s, "node") == 0) {
+            io_files[n++] = IO_FILES_NODE;
+        }
+        else if (atoi(s) > 0) {
+            io_files[n++] = atoi(s);
+        }
+        else {
+            if (rank == 0) {
+                fprintf(stderr, "Invalid value in HIP_MPITEST_IO_FILES: %s\n", s);
+            }
+            n = -1;
+            break;
+        }
+    }
+    free (str);
+    return n;
+}
+
+static const char* io_files_name (int files, char *buf, size_t len)
+{
+    if (files == IO_FILES_PROCESS) {
+        return "process";
+    }
+    if (files == IO_FILES_NODE) {
+        return "node";
+    }
+    if (files == 1) {
+        return "shared";
+    }
+    snprintf(buf, len, "%d", files);
+    return buf;
+}
+
+/*
+** Splits comm into the groups of processes sharing a file and sets the name of
+** the file of the calling process. The files are numbered by the lowest rank
+** of their group.
+*/
+static void io_file_comm (int files, MPI_Comm comm, MPI_Comm *fcomm, char *fname, size_t len)
+{
+    int rank, size, index;
+
+    MPI_Comm_rank (comm, &rank);
+    MPI_Comm_size (comm, &size);
+
+    if (files == IO_FILES_NODE) {
+        MPI_Comm_split_type (comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, fcomm);
+    }
+    else {
+        int nfiles = files == IO_FILES_PROCESS ? size : (files > size ? size : files);
+        MPI_Comm_split (comm, (int)((long)rank * nfiles / size), rank, fcomm);
+    }
+    index = rank;
+    MPI_Bcast (&index, 1, MPI_INT, 0, *fcomm);
+
+    if (files == 1) {
+        snprintf(fname, len, "%s", io_filename);
+    }
+    else {
+        snprintf(fname, len, "%s.%d", io_filename, index);
+    }
+}
+
+/*
+** Sets the file view of a layout for count elements per process. Returns the
+** number of elements actually accessed per process in lcount.
+*/
+static int io_set_view (MPI_File fh, int layout, int count, MPI_Comm comm, int *lcount)
+{
+    int rank, size, ret;
+    int ndims = layout == IO_2D ? 2 : 3;
+    int dims[3]={0,0,0}, sizes[3], subsizes[3], starts[3];
+    MPI_Datatype ftype;
+
+    MPI_Comm_rank (comm, &rank);
+    MPI_Comm_size (comm, &size);
+
+    if (layout == IO_CONTIG) {
+        *lcount = count;
+        return MPI_File_set_view (fh, (MPI_Offset)rank * count * sizeof(long), MPI_LONG, MPI_LONG,
+                                  "native", MPI_INFO_NULL);
+    }
+    if (layout == IO_INTERLEAVED) {
+        // count is a multiple of the block length, both being powers of 2 in the sweep
+        int blocklen = count < io_blocklen ? count : io_blocklen;
+        MPI_Datatype btype;
+
+        *lcount = count;
+        MPI_Type_contiguous (blocklen, MPI_LONG, &btype);
+        MPI_Type_create_resized (btype, 0, (MPI_Aint)size * blocklen * sizeof(long), &ftype);
+        MPI_Type_commit (&ftype);
+        ret = MPI_File_set_view (fh, (MPI_Offset)rank * blocklen * sizeof(long), MPI_LONG, ftype,
+                                 "native", MPI_INFO_NULL);
+        MPI_Type_free (&btype);
+        MPI_Type_free (&ftype);
+        return ret;
+    }
+
+    // largest edge length with edge^ndims <= count
+    int edge = (int)pow((double)count, 1.0/ndims);
+    while (pow((double)(edge + 1), ndims) <= (double)count) {
+        edge++;
+    }
+    while (edge > 1 && pow((double)edge, ndims) > (double)count) {
+        edge--;
+    }
+    *lcount = ndims == 2 ? edge * edge : edge * edge * edge;
+
+    MPI_Dims_create (size, ndims, dims);
+    for (int d=ndims-1, r=rank; d>=0; d--) {
+        starts[d]   = (r % dims[d]) * edge;
+        r          /= dims[d];
+        sizes[d]    = dims[d] * edge;
+        subsizes[d] = edge;
+    }
+    MPI_Type_create_subarray (ndims, sizes, subsizes, starts, MPI_ORDER_C, MPI_LONG, &ftype);
+    MPI_Type_commit (&ftype);
+    ret = MPI_File_set_view (fh, 0, MPI_LONG, ftype, "native", MPI_INFO_NULL);
+    MPI_Type_free (&ftype);
+
+    return ret;
+}
+
+static void init_sendbuf (long *sendbuf, int count, int mynode)
+{
+    for (long i = 0; i < count; i++) {
+        sendbuf[i] = (long)mynode * count + i + 1;
+    }
+}
+
+static void init_recvbuf (long *recvbuf, int count)
+{
+    for (long i = 0; i < count; i++) {
+        recvbuf[i] = 0;
+    }
+}
+
+static bool check_recvbuf (long *recvbuf, int count, int rank, int lcount)
+{
+    bool res=true;
+
+    for (long i=0; i<lcount; i++) {
+        if (recvbuf[i] != (long)rank * count + i + 1) {
+            res = false;
+#ifdef VERBOSE
+            printf("recvbuf[%ld] = %ld expected %ld\n", i, recvbuf[i], (long)rank * count + i + 1);
+#endif
+            break;
+        }
+    }
+
+    return res;
+}
+
+static int io_test (MPI_File fh, void *buf, int count, bool write, int access, int mode, int nrep);
+
+static int io_run (int layout, int access, int mode, int files, const char *hints, int count, MPI_Comm comm)
+{
+    int ret = MPI_SUCCESS;
+    int rank, size, frank, lcount;
+    MPI_File fh;
+    MPI_Comm fcomm = MPI_COMM_NULL;
+    MPI_Info info = MPI_INFO_NULL;
+    long *tmp_sendbuf=NULL, *tmp_recvbuf=NULL;
+    std::chrono::high_resolution_clock::time_point t1s, t1e;
+    double t[3], tmax[3];
+    char fname[1024], fbuf[16];
+
+    MPI_Comm_rank (comm, &rank);
+    MPI_Comm_size (comm, &size);
+
+    if (access == IO_RAW && (layout != IO_CONTIG || mode != 0)) {
+        return MPI_SUCCESS;
+    }
+
+    // Initialise send buffer
+    ALLOCATE_SENDBUFFER(sendbuf, tmp_sendbuf, long, count, sizeof(long),
+                        rank, comm, init_sendbuf, out);
+
+    // Initialize recv buffer
+    ALLOCATE_RECVBUFFER(recvbuf, tmp_recvbuf, long, count, sizeof(long),
+                        rank, comm, init_recvbuf, out);
+
+    io_file_comm (files, comm, &fcomm, fname, sizeof(fname));
+    MPI_Comm_rank (fcomm, &frank);
+    if (frank == 0) {
+        MPI_File_delete (fname, MPI_INFO_NULL);
+    }
+    MPI_Barrier (comm);
+
+    info = bench_create_info (hints);
+    for (int pass=0; pass<2; pass++) {
+        bool write = (pass == 0);
+
+        if (access == IO_RAW) {
+            long *hbuf = write ? (sendbuf->NeedsStagingBuffer() ? tmp_sendbuf : (long *)sendbuf->get_buffer()) :
+                (recvbuf->NeedsStagingBuffer() ? tmp_recvbuf : (long *)recvbuf->get_buffer());
+
+            lcount = count;
+            t[2]   = 0.0;
+            MPI_Barrier (comm);
+            t1s = std::chrono::high_resolution_clock::now();
+            for (int i=0; i<io_nrep && MPI_SUCCESS == ret; i++) {
+                if (0 != hip_mpitest_rawio (fname, hbuf, (size_t)count * sizeof(long),
+                                            (off_t)frank * count * sizeof(long), write)) {
+                    ret = MPI_ERR_OTHER;
+                }
+            }
+            t1e = std::chrono::high_resolution_clock::now();
+            t[pass] = std::chrono::duration<double>(t1e-t1s).count();
+            if (MPI_SUCCESS != ret) {
+                fprintf(stderr, "Error in hip_mpitest_rawio. Aborting\n");
+                goto out;
+            }
+            if (!write && recvbuf->NeedsStagingBuffer()) {
+                HIP_CHECK(recvbuf->CopyTo(tmp_recvbuf, count*sizeof(long)));
+            }
+            continue;
+        }
+
+        // the creation of the files measures the metadata cost
+        MPI_Barrier (comm);
+        t1s = std::chrono::high_resolution_clock::now();
+        ret = MPI_File_open (fcomm, fname, write ? MPI_MODE_CREATE|MPI_MODE_WRONLY : MPI_MODE_RDONLY,
+                             info, &fh);
+        t1e = std::chrono::high_resolution_clock::now();
+        if (write) {
+            t[2] = std::chrono::duration<double>(t1e-t1s).count();
+        }
+        if (MPI_SUCCESS != ret) {
+            fprintf(stderr, "Error opening %s. Aborting\n", fname);
+            goto out;
+        }
+        ret = io_set_view (fh, layout, count, fcomm, &lcount);
+        if (MPI_SUCCESS != ret) {
+            MPI_File_close (&fh);
+            goto out;
+        }
+
+        MPI_Barrier (comm);
+        t1s = std::chrono::high_resolution_clock::now();
+        ret = io_test (fh, write ? sendbuf->get_buffer() : recvbuf->get_buffer(), lcount,
+                       write, access, mode, io_nrep);
+        if (MPI_SUCCESS == ret && write) {
+            ret = MPI_File_sync (fh);
+        }
+        t1e = std::chrono::high_resolution_clock::now();
+        t[pass] = std::chrono::duration<double>(t1e-t1s).count();
+        MPI_File_close (&fh);
+        if (MPI_SUCCESS != ret) {
+            fprintf(stderr, "Error in io_test. Aborting\n");
+            goto out;
+        }
+    }
+
+#if 0
+    // verify results
+    bool res, fret;
+    res = true;
+    if (recvbuf->NeedsStagingBuffer()) {
+        HIP_CHECK(recvbuf->CopyFrom(tmp_recvbuf, count*sizeof(long)));
+        res = check_recvbuf(tmp_recvbuf, count, rank, lcount);
+    }
+    else {
+        res = check_recvbuf((long*) recvbuf->get_buffer(), count, rank, lcount);
+    }
+
+    fret = report_testresult((char *)io_layout_names[layout], comm, sendbuf->get_memchar(), recvbuf->get_memchar(), res);
+#endif
+
+    MPI_Reduce (t, tmax, 3, MPI_DOUBLE, MPI_MAX, 0, comm);
+    if (rank == 0) {
+        double gb = (double)lcount * sizeof(long) * size * io_nrep / 1e9;
+        printf("%-11s %-7s %-11s %-11s %10d %12ld \t %8.3lf %8.3lf %8.3lf \t %s\n", io_layout_names[layout],
+               io_files_name(files, fbuf, sizeof(fbuf)), io_access_names[access],
+               access == IO_RAW ? hip_mpitest_rawio_engine() : io_mode_names[mode],
+               lcount, (long)lcount * sizeof(long), tmax[2] * 1e3, gb / tmax[0], gb / tmax[1],
+               strlen(hints) > 0 ? hints : "-");
+    }
+
+ out:
+    if (MPI_COMM_NULL != fcomm) {
+        if (MPI_SUCCESS == ret) {
+            MPI_Barrier (comm);
+        }
+        if (frank == 0) {
+            MPI_File_delete (fname, MPI_INFO_NULL);
+        }
+        MPI_Comm_free (&fcomm);
+    }
+    if (MPI_INFO_NULL != info) {
+        MPI_Info_free (&info);
+    }
+    //Free buffers
+    FREE_BUFFER(sendbuf, tmp_sendbuf);
+    FREE_BUFFER(recvbuf, tmp_recvbuf);
+
+    return ret;
+}
+
+int main (int argc, char *argv[])
+{
+    int ret = MPI_SUCCESS;
+    int rank, size;
+    char *env, *hintsets, *hints, *saveptr;
+
+    bind_device();
+
+    MPI_Init      (&argc, &argv);
+    MPI_Comm_size (MPI_COMM_WORLD, &size);
+    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+
+    parse_args(argc, argv, MPI_COMM_WORLD);
+
+    io_nlayouts = bench_parse_names ("HIP_MPITEST_IO_LAYOUT", "contig,2d,3d", io_layout_names, io_layouts, IO_MAX_LIST, MPI_COMM_WORLD);
+    io_naccess  = bench_parse_names ("HIP_MPITEST_IO_ACCESS", "independent,collective", io_access_names, io_access, IO_MAX_LIST, MPI_COMM_WORLD);
+    io_nmodes   = bench_parse_names ("HIP_MPITEST_IO_MODE", "blocking,nonblocking", io_mode_names, io_modes, IO_MAX_LIST, MPI_COMM_WORLD);
+    io_nfiles   = io_parse_files (MPI_COMM_WORLD);
+    if (io_nlayouts < 0 || io_naccess < 0 || io_nmodes < 0 || io_nfiles < 0) {
+        MPI_Abort (MPI_COMM_WORLD, 1);
+        return 1;
+    }
+    env = getenv("HIP_MPITEST_IO_NBLOCKS");
+    if (NULL != env && atoi(env) > 0) {
+        io_nblocks = atoi(env);
+    }
+    env = getenv("HIP_MPITEST_IO_BLOCK");
+    if (NULL != env && atoi(env) > 0) {
+        io_blocklen = atoi(env);
+    }
+    env = getenv("HIP_MPITEST_IO_NREP");
+    if (NULL != env && atoi(env) > 0) {
+        io_nrep = atoi(env);
+    }
+    env = getenv("HIP_MPITEST_IO_FILE");
+    hip_mpitest_io_path (NULL != env ? env : "hip_file_io_bench.out", io_filename, sizeof(io_filename));
+    env = getenv("HIP_MPITEST_IO_HINTS");
+    hintsets = strdup(NULL != env ? env : "");
+
+    if (rank == 0 ) {
+        printf("Benchmark: %s %c %c - %d processes\n", argv[0],  sendbuf->get_memchar(), recvbuf->get_memchar(), size);
+        printf("File: %s, %d repetitions, %d blocks per nonblocking transfer\n\n", io_filename,
+               io_nrep, io_nblocks);
+        printf("%-11s %-7s %-11s %-11s %10s %12s \t %8s %8s %8s \t %s\n", "Layout", "Files", "Access", "Mode",
+               "count", "bytes/proc", "open ms", "wr GB/s", "rd GB/s", "Hints");
+        printf("==================================================================================================================\n");
+    }
+
+    // an empty list of hint sets runs once without hints
+    hints = strtok_r(hintsets, ";", &saveptr);
+    do {
+        for (int f=0; f<io_nfiles; f++) {
+            for (int l=0; l<io_nlayouts; l++) {
+                for (int a=0; a<io_naccess; a++) {
+                    for (int m=0; m<io_nmodes; m++) {
+                        for (int count = IO_MIN_ELEMENTS; count <= elements; count *= 4) {
+                            ret = io_run(io_layouts[l], io_access[a], io_modes[m], io_files[f],
+                                         NULL != hints ? hints : "", count, MPI_COMM_WORLD);
+                            if (MPI_SUCCESS != ret) {
+                                goto out;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    } while (NULL != hints && NULL != (hints = strtok_r(NULL, ";", &saveptr)));
+
+ out:
+    free (hintsets);
+    delete (sendbuf);
+    delete (recvbuf);
+
+    if (MPI_SUCCESS != ret ) {
+        MPI_Abort (MPI_COMM_WORLD, 1);
+        return 1;
+    }
+    MPI_Finalize ();
+    return ret;
+}
+
+
+static int io_test (MPI_File fh, void *buf, int count, bool write, int access, int mode, int nrep)
+{
+    int ret = MPI_SUCCESS;
+    int nblocks = mode == 1 ? io_nblocks : 1;
+    int bcount = (count + nblocks - 1) / nblocks;
+    std::vector<MPI_Request> reqs(nblocks, MPI_REQUEST_NULL);
+
+    for (int i=0; i<nrep; i++) {
+        // every repetition accesses the same part of the file
+        ret = MPI_File_seek (fh, 0, MPI_SEEK_SET);
+        if (MPI_SUCCESS != ret) {
+            return ret;
+        }
+        HIP_MPITEST_TRACE_BEGIN();
+        if (mode == 0 && access == 0) {
+            ret = write ? MPI_File_write (fh, buf, count, MPI_LONG, MPI_STATUS_IGNORE) :
+                MPI_File_read (fh, buf, count, MPI_LONG, MPI_STATUS_IGNORE);
+        }
+        else if (mode == 0) {
+            ret = write ? MPI_File_write_all (fh, buf, count, MPI_LONG, MPI_STATUS_IGNORE) :
+                MPI_File_read_all (fh, buf, count, MPI_LONG, MPI_STATUS_IGNORE);
+        }
+        else {
+            for (int b=0; b<nblocks; b++) {
+                long *bbuf = (long *)buf + (long)b * bcount;
+                int  len   = b * bcount >= count ? 0 : (count - b * bcount < bcount ? count - b * bcount : bcount);
+                if (access == 0) {
+                    ret = write ? MPI_File_iwrite (fh, bbuf, len, MPI_LONG, &reqs[b]) :
+                        MPI_File_iread (fh, bbuf, len, MPI_LONG, &reqs[b]);
+                }
+                else {
+                    ret = write ? MPI_File_iwrite_all (fh, bbuf, len, MPI_LONG, &reqs[b]) :
+                        MPI_File_iread_all (fh, bbuf, len, MPI_LONG, &reqs[b]);
+                }
+                if (MPI_SUCCESS != ret) {
+                    return ret;
+                }
+            }
+            ret = MPI_Waitall (nblocks, reqs.data(), MPI_STATUSES_IGNORE);
+        }
+        HIP_MPITEST_TRACE_END(write ? "MPI_File_write" : "MPI_File_read", count, MPI_LONG);
+        if (MPI_SUCCESS != ret) {
+            return ret;
+        }
+    }
+
+    return MPI_SUCCESS;
+}
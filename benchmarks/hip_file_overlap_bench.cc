@@ -0,0 +1,432 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <unistd.h>
+#include "mpi.h"
+
+#include <hip/hip_runtime.h>
+#include <chrono>
+
+#include "hip_mpitest_utils.h"
+#include "hip_mpitest_buffer.h"
+#include "hip_mpitest_bench.h"
+#include "hip_mpitest_compute_kernel.h"
+
+#define IO_MIN_ELEMENTS 1024
+#define IO_MAX_LIST     16
+#define COMPUTE_SAFETY_FACTOR 1.2
+int elements=16*1024*1024;
+hip_mpitest_buffer *sendbuf=NULL;
+hip_mpitest_buffer *recvbuf=NULL;
+
+/*
+** Overlap of nonblocking file I/O with computation.
+**
+** Every process accesses count longs of the send (write) or receive (read)
+** buffer, with count multiplied by 4 from 1024 up to the number of elements
+** given with -n. For every operation and count three times are measured:
+**   io:       posting the operation and waiting for its completion
+**   compute:  a compute phase calibrated to the duration of the I/O, either
+**             the kernel of hip_mpitest_compute_kernel.cc or a busy loop on
+**             the host
+**   overlap:  posting the operation, running the compute phase and waiting
+**             for the operation to complete afterwards
+** The achieved overlap is (io + compute - overlap) / min(io, compute) in
+** percent, 100% meaning the I/O is completely hidden behind the computation.
+** While the compute phase runs, MPI_Test can be called on the request every
+** poll interval to drive the progress of the I/O; the number of calls is
+** reported, the extra cost of polling shows in the overlap time compared to
+** the run without polling. All times are averages over the repetitions and
+** the maximum over all processes.
+**
+** The benchmark is configured by environment variables:
+**   HIP_MPITEST_IO_OVERLAP_OP       comma separated list of iwrite_all, iwrite_at,
+**                                   iread_all and iread_at (default iwrite_all,iwrite_at)
+**   HIP_MPITEST_IO_OVERLAP_COMPUTE  device or host (default device)
+**   HIP_MPITEST_IO_OVERLAP_POLL     comma separated list of poll intervals in
+**                                   microseconds, 0 disables polling (default 0,100,1000)
+**   HIP_MPITEST_IO_FILE             file name (default hip_file_overlap_bench.out)
+**   HIP_MPITEST_IO_DIR              directory of the file (default: working directory)
+**   HIP_MPITEST_IO_NREP             number of repetitions (default 3)
+*/
+
+#define IO_IWRITE_ALL 0
+#define IO_IWRITE_AT  1
+#define IO_IREAD_ALL  2
+#define IO_IREAD_AT   3
+
+static const char *io_op_names[] = {"iwrite_all", "iwrite_at", "iread_all", "iread_at", NULL};
+
+static int  io_nops=0, io_ops[IO_MAX_LIST];
+static int  io_npolls=0, io_polls[IO_MAX_LIST];
+static bool io_host_compute=false;
+static int  io_nrep=3;
+static char io_filename[256];
+
+static hip_mpitest_compute_params_t params;
+static double host_runtime;
+
+static void init_sendbuf (long *sendbuf, int count, int mynode)
+{
+    for (long i = 0; i < count; i++) {
+        sendbuf[i] = (long)mynode * count + i + 1;
+    }
+}
+
+static void init_recvbuf (long *recvbuf, int count)
+{
+    for (long i = 0; i < count; i++) {
+        recvbuf[i] = 0;
+    }
+}
+
+static bool check_recvbuf (long *recvbuf, int count, int rank)
+{
+    bool res=true;
+
+    for (long i=0; i<count; i++) {
+        if (recvbuf[i] != (long)rank * count + i + 1) {
+            res = false;
+#ifdef VERBOSE
+            printf("recvbuf[%ld] = %ld expected %ld\n", i, recvbuf[i], (long)rank * count + i + 1);
+#endif
+            break;
+        }
+    }
+
+    return res;
+}
+
+static double io_elapsed (std::chrono::high_resolution_clock::time_point ts)
+{
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - ts).count();
+}
+
+// Posts the nonblocking operation, the "all" variants access the file through a view
+static int io_post (MPI_File fh, int op, void *buf, int count, int rank, MPI_Request *req)
+{
+    int ret;
+
+    HIP_MPITEST_TRACE_BEGIN();
+    switch (op) {
+    case IO_IWRITE_ALL:
+        ret = MPI_File_seek (fh, 0, MPI_SEEK_SET);
+        if (MPI_SUCCESS == ret) {
+            ret = MPI_File_iwrite_all (fh, buf, count, MPI_LONG, req);
+        }
+        break;
+    case IO_IWRITE_AT:
+        ret = MPI_File_iwrite_at (fh, (MPI_Offset)rank * count, buf, count, MPI_LONG, req);
+        break;
+    case IO_IREAD_ALL:
+        ret = MPI_File_seek (fh, 0, MPI_SEEK_SET);
+        if (MPI_SUCCESS == ret) {
+            ret = MPI_File_iread_all (fh, buf, count, MPI_LONG, req);
+        }
+        break;
+    default:
+        ret = MPI_File_iread_at (fh, (MPI_Offset)rank * count, buf, count, MPI_LONG, req);
+        break;
+    }
+    HIP_MPITEST_TRACE_END(io_op_names[op], count, MPI_LONG);
+
+    return ret;
+}
+
+/*
+** Runs the compute phase. If poll is larger than zero, MPI_Test is called on
+** the request every poll microseconds until it completes. Returns the number
+** of MPI_Test calls.
+*/
+static long io_compute (MPI_Request *req, int poll)
+{
+    std::chrono::high_resolution_clock::time_point ts, tp;
+    int done = (MPI_REQUEST_NULL == *req);
+    long ntests = 0;
+    int ret = hipSuccess;
+
+    ts = std::chrono::high_resolution_clock::now();
+    tp = ts;
+    if (io_host_compute) {
+        volatile double x = 1.0;
+
+        while (io_elapsed(ts) < host_runtime) {
+            for (int i=0; i<1000; i++) {
+                x = x * 1.0000001 + 1e-9;
+            }
+            if (poll > 0 && !done && io_elapsed(tp) * 1e6 >= poll) {
+                MPI_Test (req, &done, MPI_STATUS_IGNORE);
+                ntests++;
+                tp = std::chrono::high_resolution_clock::now();
+            }
+        }
+        return ntests;
+    }
+
+    HIP_CHECK(hip_mpitest_compute_launch (params));
+    if (poll > 0) {
+        while (hipErrorNotReady == hipStreamQuery (params.stream)) {
+            if (!done) {
+                MPI_Test (req, &done, MPI_STATUS_IGNORE);
+                ntests++;
+            }
+            usleep (poll);
+        }
+    }
+    HIP_CHECK(hipStreamSynchronize(params.stream));
+ out:
+    if (hipSuccess != ret) {
+        fprintf(stderr, "Error in io_compute. Aborting\n");
+        MPI_Abort (MPI_COMM_WORLD, 1);
+    }
+    return ntests;
+}
+
+static int io_run (int op, int count, MPI_Comm comm)
+{
+    int ret = MPI_SUCCESS;
+    int rank, size;
+    bool write = (op == IO_IWRITE_ALL || op == IO_IWRITE_AT);
+    MPI_File fh = MPI_FILE_NULL;
+    MPI_Request req;
+    long *tmp_sendbuf=NULL, *tmp_recvbuf=NULL;
+    void *buf;
+    std::chrono::high_resolution_clock::time_point ts;
+    double t[3], tmax[3];
+
+    MPI_Comm_rank (comm, &rank);
+    MPI_Comm_size (comm, &size);
+
+    // Initialise send buffer
+    ALLOCATE_SENDBUFFER(sendbuf, tmp_sendbuf, long, count, sizeof(long),
+                        rank, comm, init_sendbuf, out);
+
+    // Initialize recv buffer
+    ALLOCATE_RECVBUFFER(recvbuf, tmp_recvbuf, long, count, sizeof(long),
+                        rank, comm, init_recvbuf, out);
+    buf = write ? sendbuf->get_buffer() : recvbuf->get_buffer();
+
+    if (rank == 0) {
+        MPI_File_delete (io_filename, MPI_INFO_NULL);
+    }
+    MPI_Barrier (comm);
+    ret = MPI_File_open (comm, io_filename, MPI_MODE_CREATE|MPI_MODE_RDWR, MPI_INFO_NULL, &fh);
+    if (MPI_SUCCESS != ret) {
+        fprintf(stderr, "Error opening %s. Aborting\n", io_filename);
+        goto out;
+    }
+    // the read operations access the data written here
+    ret = MPI_File_write_at_all (fh, (MPI_Offset)rank * count * sizeof(long), sendbuf->get_buffer(),
+                                 count, MPI_LONG, MPI_STATUS_IGNORE);
+    if (MPI_SUCCESS == ret) {
+        ret = (op == IO_IWRITE_ALL || op == IO_IREAD_ALL) ?
+            MPI_File_set_view (fh, (MPI_Offset)rank * count * sizeof(long), MPI_LONG, MPI_LONG, "native", MPI_INFO_NULL) :
+            MPI_File_set_view (fh, 0, MPI_LONG, MPI_LONG, "native", MPI_INFO_NULL);
+    }
+    if (MPI_SUCCESS != ret) {
+        goto out;
+    }
+
+    // I/O only
+    t[0] = 0.0;
+    for (int i=0; i<io_nrep && MPI_SUCCESS == ret; i++) {
+        MPI_Barrier (comm);
+        ts = std::chrono::high_resolution_clock::now();
+        ret = io_post (fh, op, buf, count, rank, &req);
+        if (MPI_SUCCESS == ret) {
+            ret = MPI_Wait (&req, MPI_STATUS_IGNORE);
+        }
+        t[0] += io_elapsed(ts);
+    }
+    if (MPI_SUCCESS != ret) {
+        fprintf(stderr, "Error in %s. Aborting\n", io_op_names[op]);
+        goto out;
+    }
+
+    // Calibrate the compute phase to the slowest process, then compute only
+    MPI_Allreduce (MPI_IN_PLACE, t, 1, MPI_DOUBLE, MPI_MAX, comm);
+    if (io_host_compute) {
+        host_runtime = t[0] / io_nrep * COMPUTE_SAFETY_FACTOR;
+    }
+    else {
+        hip_mpitest_compute_set_params(params, t[0] / io_nrep * COMPUTE_SAFETY_FACTOR);
+    }
+    t[1] = 0.0;
+    for (int i=0; i<io_nrep; i++) {
+        req = MPI_REQUEST_NULL;
+        MPI_Barrier (comm);
+        ts = std::chrono::high_resolution_clock::now();
+        io_compute (&req, 0);
+        t[1] += io_elapsed(ts);
+    }
+
+    // I/O overlapped with the compute phase, for every poll interval
+    for (int p=0; p<io_npolls; p++) {
+        long ntests = 0, maxtests;
+
+        t[2] = 0.0;
+        for (int i=0; i<io_nrep && MPI_SUCCESS == ret; i++) {
+            MPI_Barrier (comm);
+            ts = std::chrono::high_resolution_clock::now();
+            ret = io_post (fh, op, buf, count, rank, &req);
+            if (MPI_SUCCESS == ret) {
+                ntests += io_compute (&req, io_polls[p]);
+                ret = MPI_Wait (&req, MPI_STATUS_IGNORE);
+            }
+            t[2] += io_elapsed(ts);
+        }
+        if (MPI_SUCCESS != ret) {
+            fprintf(stderr, "Error in %s. Aborting\n", io_op_names[op]);
+            goto out;
+        }
+
+        MPI_Reduce (t, tmax, 3, MPI_DOUBLE, MPI_MAX, 0, comm);
+        MPI_Reduce (&ntests, &maxtests, 1, MPI_LONG, MPI_MAX, 0, comm);
+        if (rank == 0) {
+            double tio   = tmax[0] / io_nrep;
+            double tcomp = tmax[1] / io_nrep;
+            double tovl  = tmax[2] / io_nrep;
+            double ovl   = (tio + tcomp - tovl) / (tio < tcomp ? tio : tcomp) * 100.0;
+
+            ovl = ovl < 0.0 ? 0.0 : (ovl > 100.0 ? 100.0 : ovl);
+            printf("%-10s %-6s %6d %10d %12ld \t %10.6lf %10.6lf %10.6lf %6.1lf %8ld\n", io_op_names[op],
+                   io_host_compute ? "host" : "device", io_polls[p], count, (long)count * sizeof(long),
+                   tio, tcomp, tovl, ovl, maxtests / io_nrep);
+        }
+    }
+
+#if 0
+    // verify results
+    bool res, fret;
+    res = true;
+    if (write) {
+        ret = MPI_File_set_view (fh, 0, MPI_LONG, MPI_LONG, "native", MPI_INFO_NULL);
+        if (MPI_SUCCESS == ret) {
+            ret = MPI_File_read_at_all (fh, (MPI_Offset)rank * count, recvbuf->get_buffer(), count,
+                                        MPI_LONG, MPI_STATUS_IGNORE);
+        }
+        if (MPI_SUCCESS != ret) {
+            goto out;
+        }
+    }
+    if (recvbuf->NeedsStagingBuffer()) {
+        HIP_CHECK(recvbuf->CopyFrom(tmp_recvbuf, count*sizeof(long)));
+        res = check_recvbuf(tmp_recvbuf, count, rank);
+    }
+    else {
+        res = check_recvbuf((long*) recvbuf->get_buffer(), count, rank);
+    }
+
+    fret = report_testresult((char *)io_op_names[op], comm, sendbuf->get_memchar(), recvbuf->get_memchar(), res);
+#endif
+
+ out:
+    if (MPI_FILE_NULL != fh) {
+        MPI_File_close (&fh);
+    }
+    //Free buffers
+    FREE_BUFFER(sendbuf, tmp_sendbuf);
+    FREE_BUFFER(recvbuf, tmp_recvbuf);
+
+    return ret;
+}
+
+int main (int argc, char *argv[])
+{
+    int ret = MPI_SUCCESS;
+    int rank, size;
+    char *env;
+
+    bind_device();
+
+    MPI_Init      (&argc, &argv);
+    MPI_Comm_size (MPI_COMM_WORLD, &size);
+    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+
+    parse_args(argc, argv, MPI_COMM_WORLD);
+
+    io_nops   = bench_parse_names ("HIP_MPITEST_IO_OVERLAP_OP", "iwrite_all,iwrite_at", io_op_names, io_ops, IO_MAX_LIST, MPI_COMM_WORLD);
+    io_npolls = bench_parse_ints ("HIP_MPITEST_IO_OVERLAP_POLL", "0,100,1000", 0, false, io_polls, IO_MAX_LIST, MPI_COMM_WORLD);
+    if (io_nops < 0 || io_npolls < 0) {
+        MPI_Abort (MPI_COMM_WORLD, 1);
+        return 1;
+    }
+    env = getenv("HIP_MPITEST_IO_OVERLAP_COMPUTE");
+    if (NULL != env) {
+        if (strcmp(env, "host") == 0) {
+            io_host_compute = true;
+        }
+        else if (strcmp(env, "device") != 0) {
+            if (rank == 0) {
+                fprintf(stderr, "Invalid value in HIP_MPITEST_IO_OVERLAP_COMPUTE: %s\n", env);
+            }
+            MPI_Abort (MPI_COMM_WORLD, 1);
+            return 1;
+        }
+    }
+    env = getenv("HIP_MPITEST_IO_NREP");
+    if (NULL != env && atoi(env) > 0) {
+        io_nrep = atoi(env);
+    }
+    env = getenv("HIP_MPITEST_IO_FILE");
+    hip_mpitest_io_path (NULL != env ? env : "hip_file_overlap_bench.out", io_filename, sizeof(io_filename));
+
+    if (!io_host_compute) {
+        hip_mpitest_compute_init(params);
+    }
+
+    if (rank == 0 ) {
+        printf("Benchmark: %s %c %c - %d processes\n", argv[0],  sendbuf->get_memchar(), recvbuf->get_memchar(), size);
+        printf("File: %s, %d repetitions\n\n", io_filename, io_nrep);
+        printf("%-10s %-6s %6s %10s %12s \t %10s %10s %10s %6s %8s\n", "Operation", "Comp.", "poll", "count",
+               "bytes/proc", "io", "compute", "overlap", "ovl %", "tests");
+        printf("=======================================================================================================\n");
+    }
+
+    for (int o=0; o<io_nops; o++) {
+        for (int count = IO_MIN_ELEMENTS; count <= elements; count *= 4) {
+            ret = io_run(io_ops[o], count, MPI_COMM_WORLD);
+            if (MPI_SUCCESS != ret) {
+                goto out;
+            }
+        }
+    }
+
+ out:
+    if (rank == 0) {
+        MPI_File_delete (io_filename, MPI_INFO_NULL);
+    }
+    if (!io_host_compute) {
+        hip_mpitest_compute_fini(params);
+    }
+    delete (sendbuf);
+    delete (recvbuf);
+
+    if (MPI_SUCCESS != ret ) {
+        MPI_Abort (MPI_COMM_WORLD, 1);
+        return 1;
+    }
+    MPI_Finalize ();
+    return ret;
+}
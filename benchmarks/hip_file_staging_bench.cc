@@ -0,0 +1,365 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include "mpi.h"
+
+#include <hip/hip_runtime.h>
+#include <chrono>
+
+#include "hip_mpitest_utils.h"
+#include "hip_mpitest_buffer.h"
+#include "hip_mpitest_mpit.h"
+
+#define STAGING_MIN_ELEMENTS 1024
+int elements=16*1024*1024;
+hip_mpitest_buffer *sendbuf=NULL;
+hip_mpitest_buffer *recvbuf=NULL;
+
+/*
+** Breakdown of collective file I/O from device memory.
+**
+** Every process writes and reads a square block of at most count longs of a
+** global 2D array with MPI_File_write_all/read_all, the access pattern of the
+** hip_file_*_all_2D tests, for count multiplied by 4 from 1024 up to the
+** number of elements given with -n. The end-to-end time is split into its
+** phases by a controlled experiment, repeating the transfer
+**   full:    from the send (write) or receive (read) buffer with the 2D view
+**   host:    from a malloc'ed host buffer with the 2D view
+**   contig:  from the host buffer with a contiguous view, i.e. every process
+**            accesses one contiguous block of the file and the collective
+**            buffering does not need to redistribute the data
+**   copy:    a hipMemcpy of the block between the buffer and the host buffer
+** The staging cost is full - host, the collective shuffle host - contig and
+** the file system transfer contig, each reported in percent of full. All
+** times are averages over the repetitions and the maximum over all processes.
+** Writes include MPI_File_sync.
+**
+** If HIP_MPITEST_PVARS is set, the matching MPI_T performance variables are
+** sampled around the full transfer and reported summed up over all processes.
+** The file name is given by HIP_MPITEST_IO_FILE (default hip_file_staging_bench.out)
+** in the directory HIP_MPITEST_IO_DIR (default: working directory), the number
+** of repetitions by HIP_MPITEST_IO_NREP (default 3).
+*/
+
+#define STAGING_FULL   0
+#define STAGING_HOST   1
+#define STAGING_CONTIG 2
+#define STAGING_COPY   3
+
+static int  staging_nrep=3;
+static char staging_filename[256];
+
+static void init_sendbuf (long *sendbuf, int count, int mynode)
+{
+    for (long i = 0; i < count; i++) {
+        sendbuf[i] = (long)mynode * count + i + 1;
+    }
+}
+
+static void init_recvbuf (long *recvbuf, int count)
+{
+    for (long i = 0; i < count; i++) {
+        recvbuf[i] = 0;
+    }
+}
+
+static bool check_recvbuf (long *recvbuf, int count, int rank, int lcount)
+{
+    bool res=true;
+
+    for (long i=0; i<lcount; i++) {
+        if (recvbuf[i] != (long)rank * count + i + 1) {
+            res = false;
+#ifdef VERBOSE
+            printf("recvbuf[%ld] = %ld expected %ld\n", i, recvbuf[i], (long)rank * count + i + 1);
+#endif
+            break;
+        }
+    }
+
+    return res;
+}
+
+/*
+** Sets the 2D subarray view of a square block of at most count elements or a
+** contiguous view of the same size. Returns the number of elements of the
+** block in lcount.
+*/
+static int staging_set_view (MPI_File fh, bool contig, int count, MPI_Comm comm, int *lcount)
+{
+    int rank, size, ret;
+    int dims[2]={0,0}, sizes[2], subsizes[2], starts[2];
+    int edge = (int)sqrt((double)count);
+    MPI_Datatype ftype;
+
+    MPI_Comm_rank (comm, &rank);
+    MPI_Comm_size (comm, &size);
+
+    while ((long)edge * edge > count) {
+        edge--;
+    }
+    *lcount = edge * edge;
+    if (contig) {
+        return MPI_File_set_view (fh, (MPI_Offset)rank * *lcount * sizeof(long), MPI_LONG, MPI_LONG,
+                                  "native", MPI_INFO_NULL);
+    }
+
+    MPI_Dims_create (size, 2, dims);
+    starts[0]   = (rank / dims[1]) * edge;
+    starts[1]   = (rank % dims[1]) * edge;
+    sizes[0]    = dims[0] * edge;
+    sizes[1]    = dims[1] * edge;
+    subsizes[0] = edge;
+    subsizes[1] = edge;
+    MPI_Type_create_subarray (2, sizes, subsizes, starts, MPI_ORDER_C, MPI_LONG, &ftype);
+    MPI_Type_commit (&ftype);
+    ret = MPI_File_set_view (fh, 0, MPI_LONG, ftype, "native", MPI_INFO_NULL);
+    MPI_Type_free (&ftype);
+
+    return ret;
+}
+
+// Returns the average time of one collective transfer of count elements
+static int staging_test (MPI_File fh, void *buf, int count, bool write, double *t)
+{
+    int ret = MPI_SUCCESS;
+    std::chrono::high_resolution_clock::time_point t1s, t1e;
+
+    t1s = std::chrono::high_resolution_clock::now();
+    for (int i=0; i<staging_nrep && MPI_SUCCESS == ret; i++) {
+        ret = MPI_File_seek (fh, 0, MPI_SEEK_SET);
+        if (MPI_SUCCESS != ret) {
+            break;
+        }
+        HIP_MPITEST_TRACE_BEGIN();
+        ret = write ? MPI_File_write_all (fh, buf, count, MPI_LONG, MPI_STATUS_IGNORE) :
+            MPI_File_read_all (fh, buf, count, MPI_LONG, MPI_STATUS_IGNORE);
+        HIP_MPITEST_TRACE_END(write ? "MPI_File_write_all" : "MPI_File_read_all", count, MPI_LONG);
+        if (MPI_SUCCESS == ret && write) {
+            ret = MPI_File_sync (fh);
+        }
+    }
+    t1e = std::chrono::high_resolution_clock::now();
+    *t = std::chrono::duration<double>(t1e-t1s).count() / staging_nrep;
+
+    return ret;
+}
+
+static int staging_run (int count, MPI_Comm comm)
+{
+    int ret = MPI_SUCCESS;
+    int rank, size, lcount=0;
+    MPI_File fh = MPI_FILE_NULL;
+    long *tmp_sendbuf=NULL, *tmp_recvbuf=NULL, *hostbuf=NULL;
+    double twarm;
+    std::chrono::high_resolution_clock::time_point t1s, t1e;
+    double pvals[HIP_MPITEST_MPIT_MAX_PVARS], pvals_sum[HIP_MPITEST_MPIT_MAX_PVARS];
+    int npvars = 0;
+
+    MPI_Comm_rank (comm, &rank);
+    MPI_Comm_size (comm, &size);
+
+    // Initialise send buffer
+    ALLOCATE_SENDBUFFER(sendbuf, tmp_sendbuf, long, count, sizeof(long),
+                        rank, comm, init_sendbuf, out);
+
+    // Initialize recv buffer
+    ALLOCATE_RECVBUFFER(recvbuf, tmp_recvbuf, long, count, sizeof(long),
+                        rank, comm, init_recvbuf, out);
+
+    // the host buffer holds the same data as the send buffer
+    hostbuf = (long *) malloc (count * sizeof(long));
+    if (NULL == hostbuf) {
+        ret = MPI_ERR_OTHER;
+        goto out;
+    }
+    init_sendbuf (hostbuf, count, rank);
+
+    if (rank == 0) {
+        MPI_File_delete (staging_filename, MPI_INFO_NULL);
+    }
+    MPI_Barrier (comm);
+    ret = MPI_File_open (comm, staging_filename, MPI_MODE_CREATE|MPI_MODE_RDWR, MPI_INFO_NULL, &fh);
+    if (MPI_SUCCESS != ret) {
+        fprintf(stderr, "Error opening %s. Aborting\n", staging_filename);
+        goto out;
+    }
+    // allocate the blocks of the file before the first measurement
+    ret = staging_set_view (fh, false, count, comm, &lcount);
+    if (MPI_SUCCESS == ret) {
+        ret = staging_test (fh, hostbuf, lcount, true, &twarm);
+    }
+    if (MPI_SUCCESS != ret) {
+        fprintf(stderr, "Error in staging_test. Aborting\n");
+        goto out;
+    }
+
+    for (int pass=0; pass<2; pass++) {
+        bool write = (pass == 0);
+        void *buf = write ? sendbuf->get_buffer() : recvbuf->get_buffer();
+        // the writes end with a transfer through the 2D view such that the file holds
+        // the data in the 2D layout, the reads end with copying the data read through
+        // the 2D view from the host buffer into the receive buffer
+        int wphases[4] = {STAGING_CONTIG, STAGING_HOST, STAGING_FULL, STAGING_COPY};
+        int rphases[4] = {STAGING_FULL, STAGING_CONTIG, STAGING_HOST, STAGING_COPY};
+        int *phases = write ? wphases : rphases;
+        double t[4], tmax[4];
+
+        for (int p=0; p<4 && MPI_SUCCESS == ret; p++) {
+            int ph = phases[p];
+
+            if (ph == STAGING_COPY) {
+                t1s = std::chrono::high_resolution_clock::now();
+                for (int i=0; i<staging_nrep; i++) {
+                    if (write) {
+                        HIP_CHECK(hipMemcpy(hostbuf, buf, lcount * sizeof(long), hipMemcpyDefault));
+                    }
+                    else {
+                        HIP_CHECK(hipMemcpy(buf, hostbuf, lcount * sizeof(long), hipMemcpyDefault));
+                    }
+                }
+                t1e = std::chrono::high_resolution_clock::now();
+                t[ph] = std::chrono::duration<double>(t1e-t1s).count() / staging_nrep;
+                continue;
+            }
+
+            ret = staging_set_view (fh, ph == STAGING_CONTIG, count, comm, &lcount);
+            if (MPI_SUCCESS != ret) {
+                break;
+            }
+            MPI_Barrier (comm);
+            if (ph == STAGING_FULL) {
+                bench_mpit_begin();
+            }
+            ret = staging_test (fh, ph == STAGING_FULL ? buf : hostbuf, lcount, write, &t[ph]);
+            if (ph == STAGING_FULL) {
+                npvars = bench_mpit_end (pvals);
+            }
+        }
+        if (MPI_SUCCESS != ret) {
+            fprintf(stderr, "Error in staging_test. Aborting\n");
+            goto out;
+        }
+
+        MPI_Reduce (t, tmax, 4, MPI_DOUBLE, MPI_MAX, 0, comm);
+        if (npvars > 0) {
+            PMPI_Reduce (pvals, pvals_sum, npvars, MPI_DOUBLE, MPI_SUM, 0, comm);
+        }
+        if (rank == 0) {
+            double full = tmax[STAGING_FULL];
+
+            printf("%-5s %10d %12ld \t %10.6lf %10.6lf %10.6lf %10.6lf \t %6.1lf %6.1lf %6.1lf",
+                   write ? "write" : "read", lcount, (long)lcount * sizeof(long), full,
+                   tmax[STAGING_HOST], tmax[STAGING_CONTIG], tmax[STAGING_COPY],
+                   (full - tmax[STAGING_HOST]) / full * 100.0,
+                   (tmax[STAGING_HOST] - tmax[STAGING_CONTIG]) / full * 100.0,
+                   tmax[STAGING_CONTIG] / full * 100.0);
+            // performance variables are summed up over all processes
+            for (int i=0; i<npvars; i++) {
+                bench_mpit_print (i, pvals_sum[i]);
+            }
+            printf("\n");
+        }
+    }
+
+#if 0
+    // verify results
+    bool res, fret;
+    res = true;
+    if (recvbuf->NeedsStagingBuffer()) {
+        HIP_CHECK(recvbuf->CopyFrom(tmp_recvbuf, count*sizeof(long)));
+        res = check_recvbuf(tmp_recvbuf, count, rank, lcount);
+    }
+    else {
+        res = check_recvbuf((long*) recvbuf->get_buffer(), count, rank, lcount);
+    }
+
+    fret = report_testresult((char *)"staging", comm, sendbuf->get_memchar(), recvbuf->get_memchar(), res);
+#endif
+
+ out:
+    if (MPI_FILE_NULL != fh) {
+        MPI_File_close (&fh);
+    }
+    free (hostbuf);
+    //Free buffers
+    FREE_BUFFER(sendbuf, tmp_sendbuf);
+    FREE_BUFFER(recvbuf, tmp_recvbuf);
+
+    return ret;
+}
+
+int main (int argc, char *argv[])
+{
+    int ret = MPI_SUCCESS;
+    int rank, size;
+    char *env;
+
+    bind_device();
+
+    MPI_Init      (&argc, &argv);
+    MPI_Comm_size (MPI_COMM_WORLD, &size);
+    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+
+    parse_args(argc, argv, MPI_COMM_WORLD);
+    bench_mpit_init(MPI_COMM_WORLD);
+
+    env = getenv("HIP_MPITEST_IO_NREP");
+    if (NULL != env && atoi(env) > 0) {
+        staging_nrep = atoi(env);
+    }
+    env = getenv("HIP_MPITEST_IO_FILE");
+    hip_mpitest_io_path (NULL != env ? env : "hip_file_staging_bench.out", staging_filename, sizeof(staging_filename));
+
+    if (rank == 0 ) {
+        printf("Benchmark: %s %c %c - %d processes\n", argv[0],  sendbuf->get_memchar(), recvbuf->get_memchar(), size);
+        printf("File: %s, %d repetitions, times in seconds, phases in %% of full\n\n", staging_filename, staging_nrep);
+        printf("%-5s %10s %12s \t %10s %10s %10s %10s \t %6s %6s %6s\n", "Op", "count", "bytes/proc",
+               "full", "host", "contig", "copy", "stage", "shuffl", "fs");
+        printf("=================================================================================================\n");
+    }
+
+    for (int count = STAGING_MIN_ELEMENTS; count <= elements; count *= 4) {
+        ret = staging_run(count, MPI_COMM_WORLD);
+        if (MPI_SUCCESS != ret) {
+            goto out;
+        }
+    }
+
+ out:
+    if (rank == 0) {
+        MPI_File_delete (staging_filename, MPI_INFO_NULL);
+    }
+    delete (sendbuf);
+    delete (recvbuf);
+
+    bench_mpit_finalize();
+    if (MPI_SUCCESS != ret ) {
+        MPI_Abort (MPI_COMM_WORLD, 1);
+        return 1;
+    }
+    MPI_Finalize ();
+    return ret;
+}
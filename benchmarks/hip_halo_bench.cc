@@ -0,0 +1,534 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include "mpi.h"
+
+#include <hip/hip_runtime.h>
+#include <chrono>
+
+#include "hip_mpitest_utils.h"
+#include "hip_mpitest_buffer.h"
+#include "hip_mpitest_bench.h"
+
+#if HIP_MPITEST_PERSISTENT_NEIGHBOR == 2
+#include "mpi-ext.h"
+#define HALO_NEIGHBOR_ALLTOALL_INIT  MPIX_Neighbor_alltoall_init
+#define HALO_NEIGHBOR_ALLTOALLW_INIT MPIX_Neighbor_alltoallw_init
+#elif HIP_MPITEST_PERSISTENT_NEIGHBOR == 1
+#define HALO_NEIGHBOR_ALLTOALL_INIT  MPI_Neighbor_alltoall_init
+#define HALO_NEIGHBOR_ALLTOALLW_INIT MPI_Neighbor_alltoallw_init
+#endif
+
+#define NITER_LONG   25
+#define NITER_SHORT  200
+#define NITER_THRESH 131072
+int elements=100;
+hip_mpitest_buffer *sendbuf=NULL;
+hip_mpitest_buffer *recvbuf=NULL;
+
+/*
+** Halo exchange on a periodic 2D or 3D Cartesian process grid.
+**
+** Every process owns a subdomain of elements^ndims doubles surrounded by a
+** halo of width one, and exchanges one face with each of its 2*ndims
+** neighbors per iteration. The benchmark is configured by environment variables:
+**   HIP_MPITEST_HALO_NDIMS   2 (default) or 3
+**   HIP_MPITEST_HALO_FACES   contiguous (default): the faces are packed in
+**                            separate buffers with one block per neighbor, as
+**                            an application packing the faces on the device would do
+**                            strided: the faces are described by subarray datatypes
+**                            on the subdomain, the receive buffer is a second
+**                            subdomain whose halo is filled
+**   HIP_MPITEST_HALO_METHOD  isend (default), sendrecv, neighbor_alltoall,
+**                            neighbor_alltoallv, neighbor_alltoallw or persistent
+**                            (MPI_Neighbor_alltoall_init for contiguous and
+**                            MPI_Neighbor_alltoallw_init for strided faces)
+** neighbor_alltoall and neighbor_alltoallv require contiguous faces.
+**
+** The neighbors are ordered as defined for Cartesian neighborhood collectives,
+** i.e. for each dimension the neighbor in negative and then in positive direction.
+*/
+#define HALO_ISEND              0
+#define HALO_SENDRECV           1
+#define HALO_NEIGHBOR_ALLTOALL  2
+#define HALO_NEIGHBOR_ALLTOALLV 3
+#define HALO_NEIGHBOR_ALLTOALLW 4
+#define HALO_PERSISTENT         5
+
+#define HALO_MAX_NEIGHBORS 6
+
+static const char *halo_method_names[] = {"isend", "sendrecv", "neighbor_alltoall",
+                                          "neighbor_alltoallv", "neighbor_alltoallw",
+                                          "persistent"};
+
+static int  halo_ndims=2;
+static int  halo_method=HALO_ISEND;
+static bool halo_strided=false;
+static int  halo_nbrs[HALO_MAX_NEIGHBORS];
+
+// per-neighbor description of the faces, recomputed for every subdomain size
+static int          halo_face;
+static int          halo_counts[HALO_MAX_NEIGHBORS];
+static MPI_Aint     halo_sdispls[HALO_MAX_NEIGHBORS], halo_rdispls[HALO_MAX_NEIGHBORS];
+static int          halo_idispls[HALO_MAX_NEIGHBORS];
+static MPI_Datatype halo_stypes[HALO_MAX_NEIGHBORS], halo_rtypes[HALO_MAX_NEIGHBORS];
+
+static int halo_init (MPI_Comm comm, MPI_Comm *cartcomm)
+{
+    char *env;
+    int rank, size;
+    int dims[3]={0,0,0}, periods[3]={1,1,1};
+
+    MPI_Comm_rank (comm, &rank);
+    MPI_Comm_size (comm, &size);
+
+    for (int k=0; k<HALO_MAX_NEIGHBORS; k++) {
+        halo_stypes[k] = MPI_DATATYPE_NULL;
+        halo_rtypes[k] = MPI_DATATYPE_NULL;
+    }
+
+    env = getenv("HIP_MPITEST_HALO_NDIMS");
+    if (NULL != env) {
+        halo_ndims = atoi(env);
+        if (halo_ndims != 2 && halo_ndims != 3) {
+            if (rank == 0) {
+                fprintf(stderr, "Invalid number of dimensions in HIP_MPITEST_HALO_NDIMS: %s\n", env);
+            }
+            return MPI_ERR_ARG;
+        }
+    }
+
+    env = getenv("HIP_MPITEST_HALO_FACES");
+    if (NULL != env) {
+        if (strcmp(env, "strided") == 0) {
+            halo_strided = true;
+        }
+        else if (strcmp(env, "contiguous") != 0) {
+            if (rank == 0) {
+                fprintf(stderr, "Invalid face layout in HIP_MPITEST_HALO_FACES: %s\n", env);
+            }
+            return MPI_ERR_ARG;
+        }
+    }
+
+    env = getenv("HIP_MPITEST_HALO_METHOD");
+    if (NULL != env) {
+        halo_method = -1;
+        for (int i=0; i<=HALO_PERSISTENT; i++) {
+            if (strcmp(env, halo_method_names[i]) == 0) {
+                halo_method = i;
+            }
+        }
+        if (halo_method == -1) {
+            if (rank == 0) {
+                fprintf(stderr, "Invalid method in HIP_MPITEST_HALO_METHOD: %s\n", env);
+            }
+            return MPI_ERR_ARG;
+        }
+    }
+    if (halo_strided && (halo_method == HALO_NEIGHBOR_ALLTOALL ||
+                         halo_method == HALO_NEIGHBOR_ALLTOALLV)) {
+        if (rank == 0) {
+            fprintf(stderr, "%s requires contiguous faces\n", halo_method_names[halo_method]);
+        }
+        return MPI_ERR_ARG;
+    }
+#ifndef HALO_NEIGHBOR_ALLTOALL_INIT
+    if (halo_method == HALO_PERSISTENT) {
+        if (rank == 0) {
+            fprintf(stderr, "Persistent neighborhood collectives are not supported by the MPI library\n");
+        }
+        return MPI_ERR_ARG;
+    }
+#endif
+
+    MPI_Dims_create(size, halo_ndims, dims);
+    MPI_Cart_create(comm, halo_ndims, dims, periods, 0, cartcomm);
+    for (int i=0; i<halo_ndims; i++) {
+        MPI_Cart_shift(*cartcomm, i, 1, &halo_nbrs[2*i], &halo_nbrs[2*i+1]);
+    }
+
+    if (rank == 0) {
+        printf("Halo exchange: %dD grid of %d", halo_ndims, dims[0]);
+        for (int i=1; i<halo_ndims; i++) {
+            printf(" x %d", dims[i]);
+        }
+        printf(" processes, %s faces, method %s\n", halo_strided ? "strided" : "contiguous",
+               halo_method_names[halo_method]);
+    }
+
+    return MPI_SUCCESS;
+}
+
+// Number of elements of the send and receive buffer for a subdomain of edge length n
+static int halo_bufsize (int n)
+{
+    int len = 1;
+
+    if (halo_strided) {
+        for (int i=0; i<halo_ndims; i++) {
+            len *= n+2;
+        }
+        return len;
+    }
+    for (int i=1; i<halo_ndims; i++) {
+        len *= n;
+    }
+    return 2 * halo_ndims * len;
+}
+
+static void halo_setup (int n)
+{
+    int sizes[3], subsizes[3], starts[3];
+
+    halo_face = 1;
+    for (int i=1; i<halo_ndims; i++) {
+        halo_face *= n;
+    }
+
+    for (int k=0; k<2*halo_ndims; k++) {
+        if (!halo_strided) {
+            halo_counts[k]  = halo_face;
+            halo_idispls[k] = k * halo_face;
+            halo_sdispls[k] = k * halo_face * sizeof(double);
+            halo_rdispls[k] = halo_sdispls[k];
+            halo_stypes[k]  = MPI_DOUBLE;
+            halo_rtypes[k]  = MPI_DOUBLE;
+            continue;
+        }
+
+        // the last layer of the subdomain is sent, the halo layer received
+        int d = k / 2;
+        for (int i=0; i<halo_ndims; i++) {
+            sizes[i]    = n + 2;
+            subsizes[i] = i == d ? 1 : n;
+            starts[i]   = i == d ? (k % 2 == 0 ? 1 : n) : 1;
+        }
+        MPI_Type_create_subarray(halo_ndims, sizes, subsizes, starts, MPI_ORDER_C,
+                                 MPI_DOUBLE, &halo_stypes[k]);
+        MPI_Type_commit(&halo_stypes[k]);
+        starts[d] = k % 2 == 0 ? 0 : n + 1;
+        MPI_Type_create_subarray(halo_ndims, sizes, subsizes, starts, MPI_ORDER_C,
+                                 MPI_DOUBLE, &halo_rtypes[k]);
+        MPI_Type_commit(&halo_rtypes[k]);
+        halo_counts[k]  = 1;
+        halo_idispls[k] = 0;
+        halo_sdispls[k] = 0;
+        halo_rdispls[k] = 0;
+    }
+}
+
+static void halo_free (void)
+{
+    if (!halo_strided) {
+        return;
+    }
+    for (int k=0; k<2*halo_ndims; k++) {
+        if (MPI_DATATYPE_NULL != halo_stypes[k]) {
+            MPI_Type_free(&halo_stypes[k]);
+        }
+        if (MPI_DATATYPE_NULL != halo_rtypes[k]) {
+            MPI_Type_free(&halo_rtypes[k]);
+        }
+    }
+}
+
+/*
+** Creates the persistent neighborhood collective for the current subdomain
+** size outside of the timed region, such that only MPI_Start/MPI_Wait are
+** measured. preq is MPI_REQUEST_NULL for all other methods.
+*/
+static int halo_persistent_init (void *sendbuf, void *recvbuf, MPI_Comm comm, MPI_Request *preq)
+{
+    int ret = MPI_SUCCESS;
+
+    *preq = MPI_REQUEST_NULL;
+#ifdef HALO_NEIGHBOR_ALLTOALL_INIT
+    if (halo_method == HALO_PERSISTENT) {
+        if (halo_strided) {
+            ret = HALO_NEIGHBOR_ALLTOALLW_INIT (sendbuf, halo_counts, halo_sdispls, halo_stypes,
+                                                recvbuf, halo_counts, halo_rdispls, halo_rtypes,
+                                                comm, MPI_INFO_NULL, preq);
+        }
+        else {
+            ret = HALO_NEIGHBOR_ALLTOALL_INIT (sendbuf, halo_face, MPI_DOUBLE, recvbuf, halo_face,
+                                               MPI_DOUBLE, comm, MPI_INFO_NULL, preq);
+        }
+    }
+#endif
+    return ret;
+}
+
+static void halo_persistent_free (MPI_Request *preq)
+{
+    if (MPI_REQUEST_NULL != *preq) {
+        MPI_Request_free(preq);
+    }
+}
+
+static void init_sendbuf (double *sendbuf, int count, int mynode)
+{
+    for (int i = 0; i < count; i++) {
+        sendbuf[i] = (double)mynode;
+    }
+}
+
+static void init_recvbuf (double *recvbuf, int count)
+{
+    for (int i = 0; i < count; i++) {
+        recvbuf[i] = -1.0;
+    }
+}
+
+// Every element of a received face has to hold the rank of the neighbor
+static bool check_recvbuf(double *recvbuf, int n)
+{
+    bool res=true;
+
+    if (!halo_strided) {
+        for (int k=0; k<2*halo_ndims; k++) {
+            for (int i=0; i<halo_face; i++) {
+                if (recvbuf[k*halo_face+i] != (double)halo_nbrs[k]) {
+                    res = false;
+#ifdef VERBOSE
+                    printf("recvbuf[%d] = %lf\n", k*halo_face+i, recvbuf[k*halo_face+i]);
+#endif
+                }
+            }
+        }
+        return res;
+    }
+
+    int len = halo_bufsize(n);
+    for (int l=0; l<len; l++) {
+        // a halo element has exactly one coordinate in the halo layer
+        int k=-1, nhalo=0, rem=l;
+        for (int i=halo_ndims-1; i>=0; i--) {
+            int c = rem % (n+2);
+            rem /= n+2;
+            if (c == 0 || c == n+1) {
+                k = 2*i + (c == 0 ? 0 : 1);
+                nhalo++;
+            }
+        }
+        if (nhalo == 1 && recvbuf[l] != (double)halo_nbrs[k]) {
+            res = false;
+#ifdef VERBOSE
+            printf("recvbuf[%d] = %lf\n", l, recvbuf[l]);
+#endif
+        }
+    }
+
+    return res;
+}
+
+int halo_test (void *sendbuf, void *recvbuf, MPI_Request *preq, MPI_Comm comm, int niterations);
+
+int main (int argc, char *argv[])
+{
+    int ret;
+    int rank, size;
+    std::chrono::high_resolution_clock::time_point t1s, t1e;
+    double t1;
+    double *tmp_sendbuf=NULL, *tmp_recvbuf=NULL;
+    MPI_Comm cartcomm=MPI_COMM_NULL;
+    MPI_Request preq=MPI_REQUEST_NULL;
+    int max_elements, len;
+
+    bind_device();
+
+    MPI_Init      (&argc, &argv);
+    MPI_Comm_size (MPI_COMM_WORLD, &size);
+    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+
+    parse_args(argc, argv, MPI_COMM_WORLD);
+    ret = halo_init(MPI_COMM_WORLD, &cartcomm);
+    if (MPI_SUCCESS != ret) {
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    bench_mpit_init(cartcomm);
+    bench_skew_init(cartcomm);
+
+    max_elements = elements;
+    if (rank == 0 ) {
+        printf("Benchmark: %s %c %c - %d processes\n\n", argv[0],  sendbuf->get_memchar(), recvbuf->get_memchar(), size);
+        printf("Subdomain edge \t face length \t time\n");
+        printf("================================================================\n");
+    }
+
+    for (elements = 1; elements <= max_elements; elements *= 2) {
+        tmp_sendbuf = NULL;
+        tmp_recvbuf = NULL;
+
+        halo_setup(elements);
+        len = halo_bufsize(elements);
+        int niter = halo_face >= NITER_THRESH ? NITER_LONG : NITER_SHORT;
+
+        // Initialise send buffer
+        ALLOCATE_SENDBUFFER(sendbuf, tmp_sendbuf, double, len, sizeof(double),
+                            rank, cartcomm, init_sendbuf, out);
+
+        // Initialize recv buffer
+        ALLOCATE_RECVBUFFER(recvbuf, tmp_recvbuf, double, len, sizeof(double),
+                            rank, cartcomm, init_recvbuf, out);
+
+        ret = halo_persistent_init (sendbuf->get_buffer(), recvbuf->get_buffer(), cartcomm, &preq);
+        if (MPI_SUCCESS != ret) {
+            fprintf(stderr, "Error in halo_persistent_init. Aborting\n");
+            goto out;
+        }
+
+        //Warmup
+        ret = halo_test (sendbuf->get_buffer(), recvbuf->get_buffer(), &preq, cartcomm, 1);
+        if (MPI_SUCCESS != ret) {
+            fprintf(stderr, "Error in halo_test. Aborting\n");
+            goto out;
+        }
+
+        // execute the halo exchange test
+        bench_skew_begin(cartcomm, niter);
+        MPI_Barrier(cartcomm);
+        bench_mpit_begin();
+        t1s = std::chrono::high_resolution_clock::now();
+        ret = halo_test (sendbuf->get_buffer(), recvbuf->get_buffer(), &preq, cartcomm, niter);
+        if (MPI_SUCCESS != ret) {
+            fprintf(stderr, "Error in halo_test. Aborting\n");
+            goto out;
+        }
+        t1e = std::chrono::high_resolution_clock::now();
+        t1 = std::chrono::duration<double>(t1e-t1s).count();
+
+#if 0
+        // verify results
+        bool res, fret;
+        res = true;
+        if (recvbuf->NeedsStagingBuffer()) {
+            HIP_CHECK(recvbuf->CopyFrom(tmp_recvbuf, len*sizeof(double)));
+            res = check_recvbuf(tmp_recvbuf, elements);
+        }
+        else {
+            res = check_recvbuf((double*) recvbuf->get_buffer(), elements);
+        }
+
+        fret = report_testresult(argv[0], cartcomm, sendbuf->get_memchar(), recvbuf->get_memchar(), res);
+#endif
+        bench_performance (argv[0], cartcomm, sendbuf->get_memchar(), recvbuf->get_memchar(),
+                           elements, (size_t)(halo_face * sizeof(double)), niter, t1);
+
+        //Free buffers
+        halo_persistent_free(&preq);
+        FREE_BUFFER(sendbuf, tmp_sendbuf);
+        FREE_BUFFER(recvbuf, tmp_recvbuf);
+        halo_free();
+    }
+ out:
+    if (MPI_SUCCESS != ret) {
+        halo_persistent_free(&preq);
+        FREE_BUFFER(sendbuf, tmp_sendbuf);
+        FREE_BUFFER(recvbuf, tmp_recvbuf);
+        halo_free();
+    }
+    delete (sendbuf);
+    delete (recvbuf);
+
+    bench_mpit_finalize();
+    bench_skew_finalize();
+    MPI_Comm_free(&cartcomm);
+    MPI_Finalize ();
+    return ret;
+}
+
+
+int halo_test (void *sendbuf, void *recvbuf, MPI_Request *preq, MPI_Comm comm, int niterations)
+{
+    int ret = MPI_SUCCESS;
+    int nnbrs = 2 * halo_ndims;
+    MPI_Request reqs[2*HALO_MAX_NEIGHBORS];
+    char *sbuf = (char *)sendbuf;
+    char *rbuf = (char *)recvbuf;
+
+    for (int i=0; i<niterations; i++) {
+        BENCH_SKEW_ENTER(i);
+        HIP_MPITEST_TRACE_BEGIN();
+        switch (halo_method) {
+        case HALO_ISEND:
+            // a message sent in direction k is received from the opposite direction k^1
+            for (int k=0; k<nnbrs && MPI_SUCCESS == ret; k++) {
+                ret = MPI_Irecv(rbuf + halo_rdispls[k], halo_counts[k], halo_rtypes[k],
+                                halo_nbrs[k], k^1, comm, &reqs[k]);
+            }
+            for (int k=0; k<nnbrs && MPI_SUCCESS == ret; k++) {
+                ret = MPI_Isend(sbuf + halo_sdispls[k], halo_counts[k], halo_stypes[k],
+                                halo_nbrs[k], k, comm, &reqs[nnbrs+k]);
+            }
+            if (MPI_SUCCESS == ret) {
+                ret = MPI_Waitall(2*nnbrs, reqs, MPI_STATUSES_IGNORE);
+            }
+            HIP_MPITEST_TRACE_END("MPI_Isend/MPI_Irecv", halo_face, MPI_DOUBLE);
+            break;
+        case HALO_SENDRECV:
+            // shift in positive and then in negative direction in every dimension
+            for (int k=0; k<nnbrs && MPI_SUCCESS == ret; k++) {
+                int to = k^1;
+                ret = MPI_Sendrecv(sbuf + halo_sdispls[to], halo_counts[to], halo_stypes[to],
+                                   halo_nbrs[to], to,
+                                   rbuf + halo_rdispls[k], halo_counts[k], halo_rtypes[k],
+                                   halo_nbrs[k], k^1, comm, MPI_STATUS_IGNORE);
+            }
+            HIP_MPITEST_TRACE_END("MPI_Sendrecv", halo_face, MPI_DOUBLE);
+            break;
+        case HALO_NEIGHBOR_ALLTOALL:
+            ret = MPI_Neighbor_alltoall(sendbuf, halo_face, MPI_DOUBLE, recvbuf, halo_face,
+                                        MPI_DOUBLE, comm);
+            HIP_MPITEST_TRACE_END("MPI_Neighbor_alltoall", halo_face, MPI_DOUBLE);
+            break;
+        case HALO_NEIGHBOR_ALLTOALLV:
+            ret = MPI_Neighbor_alltoallv(sendbuf, halo_counts, halo_idispls, MPI_DOUBLE,
+                                         recvbuf, halo_counts, halo_idispls, MPI_DOUBLE, comm);
+            HIP_MPITEST_TRACE_END("MPI_Neighbor_alltoallv", halo_face, MPI_DOUBLE);
+            break;
+        case HALO_NEIGHBOR_ALLTOALLW:
+            ret = MPI_Neighbor_alltoallw(sendbuf, halo_counts, halo_sdispls, halo_stypes,
+                                         recvbuf, halo_counts, halo_rdispls, halo_rtypes, comm);
+            HIP_MPITEST_TRACE_END("MPI_Neighbor_alltoallw", halo_face, MPI_DOUBLE);
+            break;
+#ifdef HALO_NEIGHBOR_ALLTOALL_INIT
+        case HALO_PERSISTENT:
+            ret = MPI_Start(preq);
+            if (MPI_SUCCESS == ret) {
+                ret = MPI_Wait(preq, MPI_STATUS_IGNORE);
+            }
+            HIP_MPITEST_TRACE_END(halo_strided ? "MPI_Neighbor_alltoallw_init" :
+                                  "MPI_Neighbor_alltoall_init", halo_face, MPI_DOUBLE);
+            break;
+#endif
+        }
+        BENCH_SKEW_EXIT(i);
+        if (MPI_SUCCESS != ret) {
+            break;
+        }
+    }
+
+    return ret;
+}
@@ -0,0 +1,365 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include "mpi.h"
+
+#include <hip/hip_runtime.h>
+#include <chrono>
+#include <vector>
+
+#include "hip_mpitest_utils.h"
+#include "hip_mpitest_buffer.h"
+
+#define NITER_LONG   5
+#define NITER_SHORT  50
+#define NITER_THRESH 4096
+#define MATCH_TAG_UB 32768
+int elements=1;
+hip_mpitest_buffer *sendbuf=NULL;
+hip_mpitest_buffer *recvbuf=NULL;
+
+/*
+** Stress of the message matching queues.
+**
+** Every process sends nmsg messages of elements integers to its right
+** neighbor in a ring and receives nmsg messages from its left neighbor.
+** Message i carries tag i % ntags. The number of outstanding messages nmsg is
+** doubled from 1 up to HIP_MPITEST_MATCH_MAX. For each nmsg the time to
+** match and complete all receives, the message rate and the growth of the
+** resident memory of the process while the messages are outstanding are
+** reported (maximum over all processes).
+**
+** The benchmark is configured by environment variables:
+**   HIP_MPITEST_MATCH_MODE      unexpected (default): all messages are sent
+**                               before the receives are posted, such that they
+**                               are queued in the unexpected message queue
+**                               expected: the receives are posted before the
+**                               messages are sent
+**   HIP_MPITEST_MATCH_TAGS      number of distinct tags (default 1)
+**   HIP_MPITEST_MATCH_ORDER     forward (default) or reverse, the order in
+**                               which the receives are posted. With multiple
+**                               tags, reverse makes every receive walk the queue.
+**   HIP_MPITEST_MATCH_WILDCARD  none (default), any_source, any_tag or both
+**   HIP_MPITEST_MATCH_MAX       maximum number of outstanding messages (default 65536)
+*/
+
+static bool match_unexpected=true;
+static bool match_reverse=false;
+static bool match_any_source=false;
+static bool match_any_tag=false;
+static int  match_ntags=1;
+static int  match_max=65536;
+static int  match_nmsg;
+static std::vector<MPI_Status> match_statuses;
+
+static int match_param (const char *name, const char **values, int defval, MPI_Comm comm)
+{
+    char *env = getenv(name);
+    int rank;
+
+    if (NULL == env) {
+        return defval;
+    }
+    for (int i=0; values[i] != NULL; i++) {
+        if (strcmp(env, values[i]) == 0) {
+            return i;
+        }
+    }
+    MPI_Comm_rank (comm, &rank);
+    if (rank == 0) {
+        fprintf(stderr, "Invalid value of %s: %s\n", name, env);
+    }
+    return -1;
+}
+
+static int match_init (MPI_Comm comm)
+{
+    const char *modes[]     = {"expected", "unexpected", NULL};
+    const char *orders[]    = {"forward", "reverse", NULL};
+    const char *wildcards[] = {"none", "any_source", "any_tag", "both", NULL};
+    char *env;
+    int mode, order, wildcard;
+
+    mode     = match_param ("HIP_MPITEST_MATCH_MODE", modes, 1, comm);
+    order    = match_param ("HIP_MPITEST_MATCH_ORDER", orders, 0, comm);
+    wildcard = match_param ("HIP_MPITEST_MATCH_WILDCARD", wildcards, 0, comm);
+    if (mode < 0 || order < 0 || wildcard < 0) {
+        return MPI_ERR_ARG;
+    }
+    match_unexpected = (mode == 1);
+    match_reverse    = (order == 1);
+    match_any_source = (wildcard == 1 || wildcard == 3);
+    match_any_tag    = (wildcard == 2 || wildcard == 3);
+
+    env = getenv("HIP_MPITEST_MATCH_TAGS");
+    if (NULL != env) {
+        match_ntags = atoi(env);
+    }
+    env = getenv("HIP_MPITEST_MATCH_MAX");
+    if (NULL != env) {
+        match_max = atoi(env);
+    }
+    if (match_ntags < 1 || match_ntags > MATCH_TAG_UB || match_max < 1) {
+        return MPI_ERR_ARG;
+    }
+    return MPI_SUCCESS;
+}
+
+// Returns the resident set size of the process in kB
+static long match_rss (void)
+{
+    char line[256];
+    long rss = 0;
+    FILE *fp = fopen("/proc/self/status", "r");
+
+    if (NULL == fp) {
+        return 0;
+    }
+    while (NULL != fgets(line, sizeof(line), fp)) {
+        if (strncmp(line, "VmRSS:", 6) == 0) {
+            rss = atol(line + 6);
+            break;
+        }
+    }
+    fclose (fp);
+    return rss;
+}
+
+// message i of process rank holds rank * MATCH_TAG_UB + tag in all elements
+static void init_sendbuf (int *sendbuf, int count, int mynode)
+{
+    for (int i = 0; i < count; i++) {
+        sendbuf[i] = mynode * MATCH_TAG_UB + (i / elements) % match_ntags;
+    }
+}
+
+static void init_recvbuf (int *recvbuf, int count)
+{
+    for (int i = 0; i < count; i++) {
+        recvbuf[i] = -1;
+    }
+}
+
+// the content of each message has to match its source and tag
+static bool check_recvbuf (int *recvbuf, int nprocs, int rank, int count)
+{
+    bool res=true;
+    int left = (rank + nprocs - 1) % nprocs;
+
+    for (int m=0; m<match_nmsg; m++) {
+        MPI_Status *status = &match_statuses[m];
+        int expected = status->MPI_SOURCE * MATCH_TAG_UB + status->MPI_TAG;
+        if (status->MPI_SOURCE != left) {
+            res = false;
+        }
+        for (int i=0; i<count; i++) {
+            if (recvbuf[m*count + i] != expected) {
+                res = false;
+#ifdef VERBOSE
+                printf("message %d: recvbuf[%d] = %d expected %d\n", m, i, recvbuf[m*count + i], expected);
+#endif
+            }
+        }
+    }
+
+    return res;
+}
+
+/*
+** Executes niterations rounds of nmsg messages. t accumulates the time from
+** the point all messages are outstanding to the completion of all receives,
+** rss the largest growth of the resident memory while they are outstanding.
+*/
+static int match_test (int *sendbuf, int *recvbuf, int count, int nmsg, MPI_Comm comm,
+                       int niterations, double *t, long *rss)
+{
+    int rank, size, ret = MPI_SUCCESS;
+    int left, right;
+    std::vector<MPI_Request> sreqs(nmsg), rreqs(nmsg);
+    std::chrono::high_resolution_clock::time_point ts, te;
+    long rss0;
+
+    MPI_Comm_rank (comm, &rank);
+    MPI_Comm_size (comm, &size);
+    left  = (rank + size - 1) % size;
+    right = (rank + 1) % size;
+    *t   = 0.0;
+    *rss = 0;
+
+    for (int it=0; it<niterations; it++) {
+        rss0 = match_rss();
+        HIP_MPITEST_TRACE_BEGIN();
+        for (int phase=0; phase<2; phase++) {
+            // unexpected: sends in the first phase, expected: receives in the first phase
+            if ((phase == 0) == match_unexpected) {
+                for (int i=0; i<nmsg; i++) {
+                    ret = MPI_Isend (sendbuf + i*count, count, MPI_INT, right, i % match_ntags,
+                                     comm, &sreqs[i]);
+                    if (MPI_SUCCESS != ret) {
+                        return ret;
+                    }
+                }
+            }
+            else {
+                for (int j=0; j<nmsg; j++) {
+                    int i = match_reverse ? nmsg - 1 - j : j;
+                    ret = MPI_Irecv (recvbuf + i*count, count, MPI_INT,
+                                     match_any_source ? MPI_ANY_SOURCE : left,
+                                     match_any_tag ? MPI_ANY_TAG : i % match_ntags,
+                                     comm, &rreqs[i]);
+                    if (MPI_SUCCESS != ret) {
+                        return ret;
+                    }
+                }
+            }
+            if (phase == 0) {
+                // all messages of the first phase are outstanding on all processes
+                MPI_Barrier (comm);
+                long growth = match_rss() - rss0;
+                *rss = growth > *rss ? growth : *rss;
+                ts = std::chrono::high_resolution_clock::now();
+            }
+        }
+        ret = MPI_Waitall (nmsg, rreqs.data(), match_statuses.data());
+        if (MPI_SUCCESS != ret) {
+            return ret;
+        }
+        te = std::chrono::high_resolution_clock::now();
+        *t += std::chrono::duration<double>(te-ts).count();
+        ret = MPI_Waitall (nmsg, sreqs.data(), MPI_STATUSES_IGNORE);
+        HIP_MPITEST_TRACE_END(match_unexpected ? "MPI_Irecv (unexpected)" : "MPI_Irecv (expected)",
+                              count, MPI_INT);
+        if (MPI_SUCCESS != ret) {
+            return ret;
+        }
+        // no message of this round may be matched by a receive of the next round
+        MPI_Barrier (comm);
+    }
+
+    return MPI_SUCCESS;
+}
+
+int main (int argc, char *argv[])
+{
+    int ret;
+    int rank, size;
+    double t, tmax;
+    long rss, rsswarmup, rssmax;
+    int *tmp_sendbuf=NULL, *tmp_recvbuf=NULL;
+
+    bind_device();
+
+    MPI_Init      (&argc, &argv);
+    MPI_Comm_size (MPI_COMM_WORLD, &size);
+    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+
+    parse_args(argc, argv, MPI_COMM_WORLD);
+    ret = match_init(MPI_COMM_WORLD);
+    if (MPI_SUCCESS != ret) {
+        if (rank == 0) {
+            fprintf(stderr, "Invalid matching benchmark configuration. Aborting\n");
+        }
+        MPI_Abort (MPI_COMM_WORLD, 1);
+        return 1;
+    }
+
+    if (rank == 0 ) {
+        printf("Benchmark: %s %c %c - %d processes\n", argv[0],  sendbuf->get_memchar(), recvbuf->get_memchar(), size);
+        printf("Mode: %s, %d tag(s), %s receive order, source %s, tag %s\n\n",
+               match_unexpected ? "unexpected" : "expected", match_ntags,
+               match_reverse ? "reverse" : "forward", match_any_source ? "MPI_ANY_SOURCE" : "left neighbor",
+               match_any_tag ? "MPI_ANY_TAG" : "i % ntags");
+        printf("No. of msgs \t msg. length \t time \t\t msgs/s \t RSS growth [MB]\n");
+        printf("================================================================================\n");
+    }
+
+    for (match_nmsg=1; match_nmsg<=match_max; match_nmsg *=2 ) {
+        int niter = match_nmsg >= NITER_THRESH ? NITER_LONG : NITER_SHORT;
+        tmp_sendbuf = NULL;
+        tmp_recvbuf = NULL;
+        match_statuses.resize(match_nmsg);
+
+        // Initialise send buffer
+        ALLOCATE_SENDBUFFER(sendbuf, tmp_sendbuf, int, match_nmsg*elements, sizeof(int),
+                            rank, MPI_COMM_WORLD, init_sendbuf, out);
+
+        // Initialize recv buffer
+        ALLOCATE_RECVBUFFER(recvbuf, tmp_recvbuf, int, match_nmsg*elements, sizeof(int),
+                            rank, MPI_COMM_WORLD, init_recvbuf, out);
+
+        //Warmup
+        ret = match_test ((int *)sendbuf->get_buffer(), (int *)recvbuf->get_buffer(), elements,
+                          match_nmsg, MPI_COMM_WORLD, 1, &t, &rsswarmup);
+        if (MPI_SUCCESS != ret) {
+            fprintf(stderr, "Error in match_test. Aborting\n");
+            goto out;
+        }
+
+        ret = match_test ((int *)sendbuf->get_buffer(), (int *)recvbuf->get_buffer(), elements,
+                          match_nmsg, MPI_COMM_WORLD, niter, &t, &rss);
+        if (MPI_SUCCESS != ret) {
+            fprintf(stderr, "Error in match_test. Aborting\n");
+            goto out;
+        }
+
+#if 0
+        // verify results
+        bool res, fret;
+        res = true;
+        if (recvbuf->NeedsStagingBuffer()) {
+            HIP_CHECK(recvbuf->CopyFrom(tmp_recvbuf, match_nmsg*elements*sizeof(int)));
+            res = check_recvbuf(tmp_recvbuf, size, rank, elements);
+        }
+        else {
+            res = check_recvbuf((int*) recvbuf->get_buffer(), size, rank, elements);
+        }
+
+        fret = report_testresult(argv[0], MPI_COMM_WORLD, sendbuf->get_memchar(), recvbuf->get_memchar(), res);
+#endif
+
+        // the library allocates most of the queue memory in the first round
+        t /= niter;
+        rss = rsswarmup > rss ? rsswarmup : rss;
+        MPI_Reduce (&t, &tmax, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+        MPI_Reduce (&rss, &rssmax, 1, MPI_LONG, MPI_MAX, 0, MPI_COMM_WORLD);
+        if (rank == 0) {
+            printf("%11d \t %11ld \t %lf \t %12.0lf \t %.2lf\n", match_nmsg, (long)elements * sizeof(int),
+                   tmax, match_nmsg / tmax, rssmax / 1024.0);
+        }
+
+        //Free buffers
+        FREE_BUFFER(sendbuf, tmp_sendbuf);
+        FREE_BUFFER(recvbuf, tmp_recvbuf);
+    }
+ out:
+    if (ret != MPI_SUCCESS) {
+        FREE_BUFFER(sendbuf, tmp_sendbuf);
+        FREE_BUFFER(recvbuf, tmp_recvbuf);
+    }
+    delete (sendbuf);
+    delete (recvbuf);
+
+    MPI_Finalize ();
+    return ret;
+}
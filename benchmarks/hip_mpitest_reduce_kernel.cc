@@ -0,0 +1,161 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <hip/hip_runtime_api.h>
+#include <hip/hip_runtime.h>
+
+#include "hip_mpitest_utils.h"
+#include "hip_mpitest_reduce.h"
+#include "hip_mpitest_reduce_kernel.h"
+
+template <typename T, int OP> __device__ inline T reduce_op (T a, T b)
+{
+    switch (OP) {
+    case HIP_MPITEST_OP_PROD:
+        return a * b;
+    case HIP_MPITEST_OP_MAX:
+        return a > b ? a : b;
+    case HIP_MPITEST_OP_MIN:
+        return a < b ? a : b;
+    default:
+        return a + b;
+    }
+}
+
+template <typename T> __device__ inline T reduce_band (T a, T b)
+{
+    return a & b;
+}
+
+template <typename T, int OP> __global__ void reduce_me (const T *in, T *inout, int count)
+{
+    for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < count; i += blockDim.x * gridDim.x) {
+        inout[i] = reduce_op<T, OP>(in[i], inout[i]);
+    }
+}
+
+template <typename T> __global__ void reduce_band_me (const T *in, T *inout, int count)
+{
+    for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < count; i += blockDim.x * gridDim.x) {
+        inout[i] = reduce_band<T>(in[i], inout[i]);
+    }
+}
+
+static bool reduce_kernel_is_integer (const char *dtype)
+{
+    return (strcmp(dtype, "int8") == 0 || strcmp(dtype, "int16") == 0 ||
+            strcmp(dtype, "int32") == 0 || strcmp(dtype, "int64") == 0);
+}
+
+bool hip_mpitest_reduce_kernel_supported (const char *dtype, int op)
+{
+    if (op == HIP_MPITEST_OP_MAXLOC) {
+        return false;
+    }
+    if (op == HIP_MPITEST_OP_BAND) {
+        return reduce_kernel_is_integer(dtype);
+    }
+    return (reduce_kernel_is_integer(dtype) || strcmp(dtype, "float") == 0 ||
+            strcmp(dtype, "double") == 0);
+}
+
+template <typename T> static int reduce_kernel_launch (int op, const void *in, void *inout,
+                                                       int count, hipStream_t stream)
+{
+    int threadsPerBlock=256;
+    int nblocks = (count + threadsPerBlock - 1) / threadsPerBlock;
+    const T *a = (const T *) in;
+    T *b = (T *) inout;
+    int ret = 0;
+
+    if (nblocks > 65536) {
+        nblocks = 65536;
+    }
+
+    switch (op) {
+    case HIP_MPITEST_OP_PROD:
+        reduce_me<T, HIP_MPITEST_OP_PROD><<<dim3(nblocks), dim3(threadsPerBlock), 0, stream>>>(a, b, count);
+        break;
+    case HIP_MPITEST_OP_MAX:
+        reduce_me<T, HIP_MPITEST_OP_MAX><<<dim3(nblocks), dim3(threadsPerBlock), 0, stream>>>(a, b, count);
+        break;
+    case HIP_MPITEST_OP_MIN:
+        reduce_me<T, HIP_MPITEST_OP_MIN><<<dim3(nblocks), dim3(threadsPerBlock), 0, stream>>>(a, b, count);
+        break;
+    default:
+        reduce_me<T, HIP_MPITEST_OP_SUM><<<dim3(nblocks), dim3(threadsPerBlock), 0, stream>>>(a, b, count);
+        break;
+    }
+    HIP_CHECK(hipGetLastError());
+ out:
+    return ret;
+}
+
+template <typename T> static int reduce_kernel_launch_band (const void *in, void *inout,
+                                                            int count, hipStream_t stream)
+{
+    int threadsPerBlock=256;
+    int nblocks = (count + threadsPerBlock - 1) / threadsPerBlock;
+    int ret = 0;
+
+    if (nblocks > 65536) {
+        nblocks = 65536;
+    }
+    reduce_band_me<T><<<dim3(nblocks), dim3(threadsPerBlock), 0, stream>>>((const T *) in, (T *) inout, count);
+    HIP_CHECK(hipGetLastError());
+ out:
+    return ret;
+}
+
+int hip_mpitest_reduce_kernel_launch (const char *dtype, int op, const void *in, void *inout,
+                                      int count, hipStream_t stream)
+{
+    if (!hip_mpitest_reduce_kernel_supported(dtype, op)) {
+        return hipErrorNotSupported;
+    }
+
+    if (strcmp(dtype, "int8") == 0) {
+        return op == HIP_MPITEST_OP_BAND ? reduce_kernel_launch_band<int8_t>(in, inout, count, stream) :
+            reduce_kernel_launch<int8_t>(op, in, inout, count, stream);
+    }
+    else if (strcmp(dtype, "int16") == 0) {
+        return op == HIP_MPITEST_OP_BAND ? reduce_kernel_launch_band<int16_t>(in, inout, count, stream) :
+            reduce_kernel_launch<int16_t>(op, in, inout, count, stream);
+    }
+    else if (strcmp(dtype, "int32") == 0) {
+        return op == HIP_MPITEST_OP_BAND ? reduce_kernel_launch_band<int32_t>(in, inout, count, stream) :
+            reduce_kernel_launch<int32_t>(op, in, inout, count, stream);
+    }
+    else if (strcmp(dtype, "int64") == 0) {
+        return op == HIP_MPITEST_OP_BAND ? reduce_kernel_launch_band<int64_t>(in, inout, count, stream) :
+            reduce_kernel_launch<int64_t>(op, in, inout, count, stream);
+    }
+    else if (strcmp(dtype, "float") == 0) {
+        return reduce_kernel_launch<float>(op, in, inout, count, stream);
+    }
+    return reduce_kernel_launch<double>(op, in, inout, count, stream);
+}
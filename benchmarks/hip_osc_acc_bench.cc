@@ -0,0 +1,392 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include "mpi.h"
+
+#include <hip/hip_runtime.h>
+#include <chrono>
+#include <vector>
+
+#include "hip_mpitest_utils.h"
+#include "hip_mpitest_buffer.h"
+#include "hip_mpitest_bench.h"
+
+#define NITER_LONG   25
+#define NITER_SHORT  200
+#define NITER_THRESH 131072
+int elements=1;
+hip_mpitest_buffer *sendbuf=NULL;
+hip_mpitest_buffer *recvbuf=NULL;
+
+/*
+** Accumulate operations under concurrency.
+**
+** All processes, including rank 0 itself, accumulate -n elements into the
+** same location of the window of rank 0 while holding a shared lock on it.
+** Every iteration issues a window of operations followed by MPI_Win_flush.
+** For every combination of call, operation, element type and info hints the
+** time per operation in us and the aggregate bandwidth into the target in MB/s
+** are reported.
+**
+** The sweep is configured by environment variables (comma separated lists):
+**   HIP_MPITEST_ACC_CALL   accumulate      MPI_Accumulate
+**                          raccumulate     MPI_Raccumulate, completed by MPI_Waitall
+**                          get_accumulate  MPI_Get_accumulate
+**                          (default: all)
+**   HIP_MPITEST_ACC_OP     sum, max, replace, no_op (default: all). no_op is
+**                          only executed with get_accumulate.
+**   HIP_MPITEST_ACC_DTYPE  int, float, double (default: all)
+**   HIP_MPITEST_ACC_HINTS  info hints given to MPI_Win_create (default: all)
+**                          none      no hints
+**                          ordering  accumulate_ordering=none
+**                          same_op   accumulate_ops=same_op_no_op
+**                          both      both hints
+**   HIP_MPITEST_OSC_WINDOW number of operations between two flushes (default 16)
+**
+** The window exposes the receive buffer of rank 0, the origin buffer and the
+** result buffer of MPI_Get_accumulate are the two halves of the send buffer.
+** The window is reset to zero before every combination.
+*/
+
+#define ACC_CALL_ACC  0
+#define ACC_CALL_RACC 1
+#define ACC_CALL_GACC 2
+#define ACC_CALL_LAST 3
+
+#define ACC_OP_LAST    4
+#define ACC_DTYPE_LAST 3
+#define ACC_HINTS_LAST 4
+
+#define ACC_MAX_EXTENT 8
+
+static const char *acc_call_names[]               = {"accumulate", "raccumulate", "get_accumulate", NULL};
+static const char *acc_op_names[]                 = {"sum", "max", "replace", "no_op", NULL};
+static const MPI_Op acc_ops[ACC_OP_LAST]           = {MPI_SUM, MPI_MAX, MPI_REPLACE, MPI_NO_OP};
+static const char *acc_dtype_names[]              = {"int", "float", "double", NULL};
+static const char *acc_hints_names[]              = {"none", "ordering", "same_op", "both", NULL};
+
+static MPI_Datatype acc_dtype (int dtype)
+{
+    return (dtype == 0) ? MPI_INT : (dtype == 1) ? MPI_FLOAT : MPI_DOUBLE;
+}
+
+// Stores value as count elements of the given type
+static void acc_set (void *buf, int dtype, int count, double value)
+{
+    for (int i=0; i<count; i++) {
+        if (dtype == 0) {
+            ((int *)buf)[i] = (int)value;
+        }
+        else if (dtype == 1) {
+            ((float *)buf)[i] = (float)value;
+        }
+        else {
+            ((double *)buf)[i] = value;
+        }
+    }
+}
+
+static double acc_get (void *buf, int dtype, int i)
+{
+    if (dtype == 0) {
+        return ((int *)buf)[i];
+    }
+    else if (dtype == 1) {
+        return ((float *)buf)[i];
+    }
+    return ((double *)buf)[i];
+}
+
+static void init_sendbuf (char *sendbuf, int count, int mynode)
+{
+    memset (sendbuf, 0, count);
+}
+
+static void init_recvbuf (char *recvbuf, int count)
+{
+    memset (recvbuf, 0, count);
+}
+
+/*
+** Checks the window of rank 0 after a combination, in which every process
+** contributed rank+1 in nops operations.
+*/
+static bool check_recvbuf (void *recvbuf, int nprocs, int rank, int count, int dtype, int op, int nops)
+{
+    bool res=true;
+
+    if (rank != 0) {
+        return res;
+    }
+    for (int i=0; i<count; i++) {
+        double val = acc_get (recvbuf, dtype, i), expected = 0.0;
+
+        if (op == 0) {
+            expected = (double)nops * nprocs * (nprocs + 1) / 2;
+        }
+        else if (op == 1) {
+            expected = nprocs;
+        }
+        else if (op == 2) {
+            // any of the contributions
+            expected = (val >= 1.0 && val <= nprocs) ? val : 1.0;
+        }
+        if (val != expected) {
+            res = false;
+#ifdef VERBOSE
+            printf("recvbuf[%d] = %lf expected %lf\n", i, val, expected);
+#endif
+        }
+    }
+
+    return res;
+}
+
+/*
+** Executes niterations windows of window operations on count elements,
+** each followed by MPI_Win_flush. The shared lock on rank 0 is held by the caller.
+*/
+static int acc_test (int call, MPI_Op op, MPI_Datatype datatype, void *sbuf, void *resbuf,
+                     int count, int window, MPI_Win win, MPI_Request *reqs, int niterations)
+{
+    int ret = MPI_SUCCESS;
+
+    for (int i=0; i<niterations; i++) {
+        HIP_MPITEST_TRACE_BEGIN();
+        for (int j=0; j<window; j++) {
+            if (call == ACC_CALL_ACC) {
+                ret = MPI_Accumulate (sbuf, count, datatype, 0, 0, count, datatype, op, win);
+            }
+            else if (call == ACC_CALL_RACC) {
+                ret = MPI_Raccumulate (sbuf, count, datatype, 0, 0, count, datatype, op, win, &reqs[j]);
+            }
+            else {
+                ret = MPI_Get_accumulate (sbuf, count, datatype, resbuf, count, datatype,
+                                          0, 0, count, datatype, op, win);
+            }
+            if (MPI_SUCCESS != ret) {
+                return ret;
+            }
+        }
+        if (call == ACC_CALL_RACC) {
+            ret = MPI_Waitall (window, reqs, MPI_STATUSES_IGNORE);
+            if (MPI_SUCCESS != ret) {
+                return ret;
+            }
+        }
+        ret = MPI_Win_flush (0, win);
+        HIP_MPITEST_TRACE_END(acc_call_names[call], count * window, datatype);
+        if (MPI_SUCCESS != ret) {
+            return ret;
+        }
+    }
+
+    return MPI_SUCCESS;
+}
+
+// Returns the maximum time of niter iterations over all processes
+static int acc_time (int call, MPI_Op op, MPI_Datatype datatype, void *sbuf, void *resbuf,
+                     int count, int window, MPI_Win win, MPI_Request *reqs, int niter,
+                     double *t)
+{
+    std::chrono::high_resolution_clock::time_point t1s, t1e;
+    double tl;
+    int ret;
+
+    ret = MPI_Win_lock (MPI_LOCK_SHARED, 0, 0, win);
+    if (MPI_SUCCESS != ret) {
+        return ret;
+    }
+
+    //Warmup
+    ret = acc_test (call, op, datatype, sbuf, resbuf, count, window, win, reqs, 1);
+    if (MPI_SUCCESS != ret) {
+        return ret;
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    t1s = std::chrono::high_resolution_clock::now();
+    ret = acc_test (call, op, datatype, sbuf, resbuf, count, window, win, reqs, niter);
+    if (MPI_SUCCESS != ret) {
+        return ret;
+    }
+    t1e = std::chrono::high_resolution_clock::now();
+    tl = std::chrono::duration<double>(t1e-t1s).count();
+
+    ret = MPI_Win_unlock (0, win);
+    if (MPI_SUCCESS != ret) {
+        return ret;
+    }
+
+    MPI_Allreduce (&tl, t, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    return MPI_SUCCESS;
+}
+
+int main (int argc, char *argv[])
+{
+    int ret = MPI_SUCCESS;
+    int rank, size, niter, window;
+    int ncalls, calls[ACC_CALL_LAST], nops, ops[ACC_OP_LAST];
+    int ndtypes, dtypes[ACC_DTYPE_LAST], nhints, hints[ACC_HINTS_LAST];
+    size_t nbytes;
+    double t;
+    char *tmp_sendbuf=NULL, *tmp_recvbuf=NULL, *hbuf=NULL;
+    MPI_Win win = MPI_WIN_NULL;
+    MPI_Info info;
+    std::vector<MPI_Request> reqs;
+    char *env;
+
+    bind_device();
+
+    MPI_Init      (&argc, &argv);
+    MPI_Comm_size (MPI_COMM_WORLD, &size);
+    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+
+    parse_args(argc, argv, MPI_COMM_WORLD);
+
+    ncalls  = bench_parse_names ("HIP_MPITEST_ACC_CALL", NULL, acc_call_names, calls, ACC_CALL_LAST, MPI_COMM_WORLD);
+    nops    = bench_parse_names ("HIP_MPITEST_ACC_OP", NULL, acc_op_names, ops, ACC_OP_LAST, MPI_COMM_WORLD);
+    ndtypes = bench_parse_names ("HIP_MPITEST_ACC_DTYPE", NULL, acc_dtype_names, dtypes, ACC_DTYPE_LAST, MPI_COMM_WORLD);
+    nhints  = bench_parse_names ("HIP_MPITEST_ACC_HINTS", NULL, acc_hints_names, hints, ACC_HINTS_LAST, MPI_COMM_WORLD);
+    if (ncalls < 0 || nops < 0 || ndtypes < 0 || nhints < 0) {
+        MPI_Abort (MPI_COMM_WORLD, 1);
+        return 1;
+    }
+    env    = getenv("HIP_MPITEST_OSC_WINDOW");
+    window = (NULL != env && atoi(env) > 0) ? atoi(env) : 16;
+    reqs.resize(window, MPI_REQUEST_NULL);
+    niter  = elements >= NITER_THRESH ? NITER_LONG : NITER_SHORT;
+    nbytes = (size_t)elements * ACC_MAX_EXTENT;
+
+    // host copy used to set the contents of the buffers for every element type
+    hbuf = (char *) malloc (2 * nbytes);
+    if (NULL == hbuf) {
+        ret = MPI_ERR_OTHER;
+        goto out;
+    }
+
+    // Initialise send buffer, origin and result buffer
+    ALLOCATE_SENDBUFFER(sendbuf, tmp_sendbuf, char, 2*nbytes, 1,
+                        rank, MPI_COMM_WORLD, init_sendbuf, out);
+
+    // Initialize recv buffer
+    ALLOCATE_RECVBUFFER(recvbuf, tmp_recvbuf, char, nbytes, 1,
+                        rank, MPI_COMM_WORLD, init_recvbuf, out);
+
+    if (rank == 0 ) {
+        printf("Benchmark: %s %c %c - %d processes\n\n", argv[0],  sendbuf->get_memchar(), recvbuf->get_memchar(), size);
+        printf("%d elements per operation, %d operations per flush\n\n", elements, window);
+        printf("%14s %8s %6s %8s \t %10s \t %10s\n", "call", "op", "dtype", "hints", "us/op", "MB/s");
+        printf("==========================================================================\n");
+    }
+
+    for (int k=0; k<nhints; k++) {
+        int h = hints[k];
+
+        MPI_Info_create (&info);
+        if (h == 1 || h == 3) {
+            MPI_Info_set (info, "accumulate_ordering", "none");
+        }
+        if (h == 2 || h == 3) {
+            MPI_Info_set (info, "accumulate_ops", "same_op_no_op");
+        }
+        ret = MPI_Win_create (recvbuf->get_buffer(), nbytes, 1, info, MPI_COMM_WORLD, &win);
+        MPI_Info_free (&info);
+        if (MPI_SUCCESS != ret) {
+            goto out;
+        }
+
+        for (int l=0; l<ncalls; l++) {
+            int c = calls[l];
+
+            for (int m=0; m<nops; m++) {
+                int o = ops[m];
+
+                // MPI_NO_OP is only valid for the fetching operations
+                if (acc_ops[o] == MPI_NO_OP && c != ACC_CALL_GACC) {
+                    continue;
+                }
+                for (int n=0; n<ndtypes; n++) {
+                    int d = dtypes[n];
+                    MPI_Datatype datatype = acc_dtype(d);
+                    int tsize;
+
+                    MPI_Type_size (datatype, &tsize);
+
+                    // every process contributes rank+1, the target starts at zero
+                    acc_set (hbuf, d, elements, rank + 1);
+                    HIP_CHECK(sendbuf->CopyTo(hbuf, elements * tsize));
+                    if (rank == 0) {
+                        memset (hbuf, 0, nbytes);
+                        HIP_CHECK(recvbuf->CopyTo(hbuf, nbytes));
+                    }
+                    MPI_Barrier (MPI_COMM_WORLD);
+
+                    ret = acc_time (c, acc_ops[o], datatype, sendbuf->get_buffer(),
+                                    (char *)sendbuf->get_buffer() + nbytes, elements, window,
+                                    win, reqs.data(), niter, &t);
+                    if (MPI_SUCCESS != ret) {
+                        fprintf(stderr, "Error in acc_test. Aborting\n");
+                        goto out;
+                    }
+
+#if 0
+                    // verify results
+                    bool res, fret;
+                    MPI_Barrier (MPI_COMM_WORLD);
+                    HIP_CHECK(recvbuf->CopyFrom(hbuf, nbytes));
+                    res = check_recvbuf(hbuf, size, rank, elements, d, o, (niter + 1) * window);
+                    fret = report_testresult(argv[0], MPI_COMM_WORLD, sendbuf->get_memchar(), recvbuf->get_memchar(), res);
+#endif
+                    if (rank == 0) {
+                        printf("%14s %8s %6s %8s \t %10.2lf \t %10.2lf\n", acc_call_names[c], acc_op_names[o],
+                               acc_dtype_names[d], acc_hints_names[h], t / ((double)niter * window) * 1e6,
+                               (double)elements * tsize * window * niter * size / t / 1e6);
+                    }
+                }
+            }
+        }
+        MPI_Win_free (&win);
+    }
+
+ out:
+    if (MPI_WIN_NULL != win) {
+        MPI_Win_free (&win);
+    }
+    free (hbuf);
+
+    //Free buffers
+    FREE_BUFFER(sendbuf, tmp_sendbuf);
+    FREE_BUFFER(recvbuf, tmp_recvbuf);
+
+    delete (sendbuf);
+    delete (recvbuf);
+
+    if (MPI_SUCCESS != ret ) {
+        MPI_Abort (MPI_COMM_WORLD, 1);
+        return 1;
+    }
+    MPI_Finalize ();
+    return ret;
+}
@@ -0,0 +1,381 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include "mpi.h"
+
+#include <hip/hip_runtime.h>
+#include <chrono>
+#include <vector>
+
+#include "hip_mpitest_utils.h"
+#include "hip_mpitest_buffer.h"
+#include "hip_mpitest_bench.h"
+
+#define NITER_LONG   25
+#define NITER_SHORT  200
+#define NITER_THRESH 131072
+#define MAX_LIST     16
+int elements=1;
+hip_mpitest_buffer *sendbuf=NULL;
+hip_mpitest_buffer *recvbuf=NULL;
+
+/*
+** Completion strategies for passive target one-sided communication.
+**
+** Every process issues batches of MPI_Put or MPI_Get operations of elements
+** doubles, distributed round-robin over all other processes, on a window
+** created with MPI_Win_create on the receive buffer. Every batch ends with the
+** remote completion of all its operations, the strategy determines how the
+** operations are completed within the batch:
+**   flush        MPI_Win_flush after every operation
+**   flush_local  MPI_Win_flush_local after every operation, MPI_Win_flush_all
+**                at the end of the batch
+**   flush_all    MPI_Win_flush_all at the end of the batch
+**   request      MPI_Rput/MPI_Rget, MPI_Waitall and MPI_Win_flush_all at the end
+**                of the batch
+**   lock         MPI_Win_lock/MPI_Win_unlock around the operations of the batch
+**                to each target, all other strategies use a single
+**                MPI_Win_lock_all epoch
+** For every strategy and batch size the time per operation in us and the
+** bandwidth per process in MB/s are reported.
+**
+** The sweep is configured by environment variables:
+**   HIP_MPITEST_OSC_SYNC         comma separated list of strategies (default: all)
+**   HIP_MPITEST_OSC_OP           comma separated list of operations, put and/or get
+**                                (default put,get)
+**   HIP_MPITEST_OSC_OUTSTANDING  comma separated list of batch sizes, i.e. the number
+**                                of outstanding operations (default 1,4,16,64,256)
+*/
+
+#define OSC_SYNC_FLUSH       0
+#define OSC_SYNC_FLUSH_LOCAL 1
+#define OSC_SYNC_FLUSH_ALL   2
+#define OSC_SYNC_REQUEST     3
+#define OSC_SYNC_LOCK        4
+#define OSC_SYNC_LAST        5
+
+#define OSC_OP_PUT  0
+#define OSC_OP_GET  1
+#define OSC_OP_LAST 2
+
+static const char *osc_sync_names[] = {"flush", "flush_local", "flush_all", "request", "lock", NULL};
+static const char *osc_op_names[]   = {"put", "get", NULL};
+
+static int osc_ndepths=0, osc_depths[MAX_LIST];
+
+static void init_sendbuf (double *sendbuf, int count, int mynode)
+{
+    for (int i = 0; i < count; i++) {
+        sendbuf[i] = (double)(mynode + i);
+    }
+}
+
+static void init_recvbuf (double *recvbuf, int count)
+{
+    for (int i = 0; i < count; i++) {
+        recvbuf[i] = -1.0;
+    }
+}
+
+// every process puts into its own region of the window of all other processes
+static bool check_recvbuf (double *recvbuf, int nprocs, int rank, int count)
+{
+    bool res=true;
+
+    for (int r=0; r<nprocs; r++) {
+        if (r == rank) {
+            continue;
+        }
+        for (int i=0; i<count; i++) {
+            if (recvbuf[r*count+i] != (double)(r + i)) {
+                res = false;
+#ifdef VERBOSE
+                printf("[%d] recvbuf[%d] = %lf expected %lf\n", rank, r*count+i,
+                       recvbuf[r*count+i], (double)(r + i));
+#endif
+            }
+        }
+    }
+
+    return res;
+}
+
+static int osc_op (int op, bool rop, void *sbuf, int count, int target, MPI_Aint disp,
+                   MPI_Win win, MPI_Request *req)
+{
+    if (op == OSC_OP_PUT) {
+        return rop ? MPI_Rput (sbuf, count, MPI_DOUBLE, target, disp, count, MPI_DOUBLE, win, req) :
+            MPI_Put (sbuf, count, MPI_DOUBLE, target, disp, count, MPI_DOUBLE, win);
+    }
+    return rop ? MPI_Rget (sbuf, count, MPI_DOUBLE, target, disp, count, MPI_DOUBLE, win, req) :
+        MPI_Get (sbuf, count, MPI_DOUBLE, target, disp, count, MPI_DOUBLE, win);
+}
+
+/*
+** Executes niterations batches of depth operations. The operations access the
+** region of this process on all other processes round-robin, continuing with
+** the next target from one batch to the next. All strategies except lock are
+** executed inside a MPI_Win_lock_all epoch opened by the caller.
+*/
+static int osc_test (int sync, int op, void *sbuf, int count, int depth,
+                     MPI_Win win, MPI_Comm comm, MPI_Request *reqs, int niterations)
+{
+    int rank, size, ntargets, target, ret = MPI_SUCCESS;
+    MPI_Aint disp;
+
+    MPI_Comm_rank (comm, &rank);
+    MPI_Comm_size (comm, &size);
+    ntargets = size - 1;
+    disp     = (MPI_Aint)rank * count;
+
+    for (int i=0; i<niterations; i++) {
+        int first = (int)(((long)i * depth) % ntargets);
+
+        HIP_MPITEST_TRACE_BEGIN();
+        if (sync == OSC_SYNC_LOCK) {
+            for (int t=0; t<ntargets && t<depth; t++) {
+                target = (rank + 1 + (first + t) % ntargets) % size;
+                ret = MPI_Win_lock (MPI_LOCK_SHARED, target, 0, win);
+                if (MPI_SUCCESS != ret) {
+                    return ret;
+                }
+                for (int j=t; j<depth; j+=ntargets) {
+                    ret = osc_op (op, false, sbuf, count, target, disp, win, NULL);
+                    if (MPI_SUCCESS != ret) {
+                        return ret;
+                    }
+                }
+                ret = MPI_Win_unlock (target, win);
+                if (MPI_SUCCESS != ret) {
+                    return ret;
+                }
+            }
+        }
+        else {
+            for (int j=0; j<depth; j++) {
+                target = (rank + 1 + (first + j) % ntargets) % size;
+                ret = osc_op (op, sync == OSC_SYNC_REQUEST, sbuf, count, target, disp, win, &reqs[j]);
+                if (MPI_SUCCESS != ret) {
+                    return ret;
+                }
+                if (sync == OSC_SYNC_FLUSH) {
+                    ret = MPI_Win_flush (target, win);
+                }
+                else if (sync == OSC_SYNC_FLUSH_LOCAL) {
+                    ret = MPI_Win_flush_local (target, win);
+                }
+                if (MPI_SUCCESS != ret) {
+                    return ret;
+                }
+            }
+            if (sync == OSC_SYNC_REQUEST) {
+                ret = MPI_Waitall (depth, reqs, MPI_STATUSES_IGNORE);
+                if (MPI_SUCCESS != ret) {
+                    return ret;
+                }
+            }
+            if (sync != OSC_SYNC_FLUSH) {
+                ret = MPI_Win_flush_all (win);
+            }
+        }
+        HIP_MPITEST_TRACE_END(osc_op_names[op], count * depth, MPI_DOUBLE);
+        if (MPI_SUCCESS != ret) {
+            return ret;
+        }
+    }
+
+    return MPI_SUCCESS;
+}
+
+// Returns the maximum time of niter batches over all processes
+static int osc_time (int sync, int op, void *sbuf, int count, int depth, MPI_Win win,
+                     MPI_Comm comm, MPI_Request *reqs, int niter, double *t)
+{
+    std::chrono::high_resolution_clock::time_point t1s, t1e;
+    double tl;
+    int ret;
+
+    if (sync != OSC_SYNC_LOCK) {
+        ret = MPI_Win_lock_all (MPI_MODE_NOCHECK, win);
+        if (MPI_SUCCESS != ret) {
+            return ret;
+        }
+    }
+
+    //Warmup
+    ret = osc_test (sync, op, sbuf, count, depth, win, comm, reqs, 1);
+    if (MPI_SUCCESS != ret) {
+        return ret;
+    }
+
+    MPI_Barrier(comm);
+    t1s = std::chrono::high_resolution_clock::now();
+    ret = osc_test (sync, op, sbuf, count, depth, win, comm, reqs, niter);
+    if (MPI_SUCCESS != ret) {
+        return ret;
+    }
+    t1e = std::chrono::high_resolution_clock::now();
+    tl = std::chrono::duration<double>(t1e-t1s).count();
+
+    if (sync != OSC_SYNC_LOCK) {
+        ret = MPI_Win_unlock_all (win);
+        if (MPI_SUCCESS != ret) {
+            return ret;
+        }
+    }
+
+    MPI_Allreduce (&tl, t, 1, MPI_DOUBLE, MPI_MAX, comm);
+    return MPI_SUCCESS;
+}
+
+int main (int argc, char *argv[])
+{
+    int ret = MPI_SUCCESS;
+    int rank, size, niter, maxdepth=1;
+    int nsyncs, syncs[OSC_SYNC_LAST], nops, ops[OSC_OP_LAST];
+    double t;
+    double *tmp_sendbuf=NULL, *tmp_recvbuf=NULL;
+    MPI_Win win = MPI_WIN_NULL;
+    std::vector<MPI_Request> reqs;
+
+    bind_device();
+
+    MPI_Init      (&argc, &argv);
+    MPI_Comm_size (MPI_COMM_WORLD, &size);
+    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+
+    parse_args(argc, argv, MPI_COMM_WORLD);
+    if (size < 2) {
+        if (rank == 0) {
+            fprintf(stderr, "The flush benchmark requires at least two processes\n");
+        }
+        MPI_Abort (MPI_COMM_WORLD, 1);
+        return 1;
+    }
+
+    nsyncs = bench_parse_names ("HIP_MPITEST_OSC_SYNC", NULL, osc_sync_names, syncs, OSC_SYNC_LAST, MPI_COMM_WORLD);
+    nops   = bench_parse_names ("HIP_MPITEST_OSC_OP", NULL, osc_op_names, ops, OSC_OP_LAST, MPI_COMM_WORLD);
+    osc_ndepths = bench_parse_ints ("HIP_MPITEST_OSC_OUTSTANDING", "1,4,16,64,256", 1, false,
+                                    osc_depths, MAX_LIST, MPI_COMM_WORLD);
+    if (nsyncs < 0 || nops < 0 || osc_ndepths < 0) {
+        MPI_Abort (MPI_COMM_WORLD, 1);
+        return 1;
+    }
+    for (int d=0; d<osc_ndepths; d++) {
+        maxdepth = osc_depths[d] > maxdepth ? osc_depths[d] : maxdepth;
+    }
+    reqs.resize(maxdepth, MPI_REQUEST_NULL);
+    niter = elements >= NITER_THRESH ? NITER_LONG : NITER_SHORT;
+
+    // Initialise send buffer
+    ALLOCATE_SENDBUFFER(sendbuf, tmp_sendbuf, double, elements, sizeof(double),
+                        rank, MPI_COMM_WORLD, init_sendbuf, out);
+
+    // Initialize recv buffer, one region per origin
+    ALLOCATE_RECVBUFFER(recvbuf, tmp_recvbuf, double, size*elements, sizeof(double),
+                        rank, MPI_COMM_WORLD, init_recvbuf, out);
+
+    ret = MPI_Win_create (recvbuf->get_buffer(), (MPI_Aint)size*elements*sizeof(double), sizeof(double),
+                          MPI_INFO_NULL, MPI_COMM_WORLD, &win);
+    if (MPI_SUCCESS != ret) {
+        goto out;
+    }
+
+    if (rank == 0 ) {
+        printf("Benchmark: %s %c %c - %d processes\n\n", argv[0],  sendbuf->get_memchar(), recvbuf->get_memchar(), size);
+        printf("Message length %ld bytes\n\n", (long)elements * sizeof(double));
+        printf("%12s %4s %8s \t %10s \t %10s\n", "sync", "op", "ops", "us/op", "MB/s");
+        printf("================================================================\n");
+    }
+
+    for (int k=0; k<nops; k++) {
+        int o = ops[k];
+
+        for (int l=0; l<nsyncs; l++) {
+            int s = syncs[l];
+
+            for (int d=0; d<osc_ndepths; d++) {
+                int depth = osc_depths[d];
+
+                ret = osc_time (s, o, sendbuf->get_buffer(), elements, depth, win, MPI_COMM_WORLD,
+                                reqs.data(), niter, &t);
+                if (MPI_SUCCESS != ret) {
+                    fprintf(stderr, "Error in osc_test. Aborting\n");
+                    goto out;
+                }
+
+#if 0
+                // verify results
+                bool res, fret;
+                res = true;
+                MPI_Barrier (MPI_COMM_WORLD);
+                if (o == OSC_OP_PUT) {
+                    if (recvbuf->NeedsStagingBuffer()) {
+                        HIP_CHECK(recvbuf->CopyFrom(tmp_recvbuf, size*elements*sizeof(double)));
+                        res = check_recvbuf(tmp_recvbuf, size, rank, elements);
+                    }
+                    else {
+                        res = check_recvbuf((double*) recvbuf->get_buffer(), size, rank, elements);
+                    }
+                }
+                else {
+                    // gets overwrite the origin buffer, restore it for the next puts
+                    if (sendbuf->NeedsStagingBuffer()) {
+                        HIP_CHECK(sendbuf->CopyTo(tmp_sendbuf, elements*sizeof(double)));
+                    }
+                    else {
+                        init_sendbuf((double*) sendbuf->get_buffer(), elements, rank);
+                    }
+                }
+
+                fret = report_testresult(argv[0], MPI_COMM_WORLD, sendbuf->get_memchar(), recvbuf->get_memchar(), res);
+#endif
+                if (rank == 0) {
+                    printf("%12s %4s %8d \t %10.2lf \t %10.2lf\n", osc_sync_names[s], osc_op_names[o], depth,
+                           t / ((double)niter * depth) * 1e6,
+                           (double)elements * sizeof(double) * depth * niter / t / 1e6);
+                }
+            }
+        }
+    }
+
+ out:
+    if (MPI_WIN_NULL != win) {
+        MPI_Win_free (&win);
+    }
+
+    //Free buffers
+    FREE_BUFFER(sendbuf, tmp_sendbuf);
+    FREE_BUFFER(recvbuf, tmp_recvbuf);
+
+    delete (sendbuf);
+    delete (recvbuf);
+
+    if (MPI_SUCCESS != ret ) {
+        MPI_Abort (MPI_COMM_WORLD, 1);
+        return 1;
+    }
+    MPI_Finalize ();
+    return ret;
+}
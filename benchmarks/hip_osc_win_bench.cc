@@ -0,0 +1,498 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include "mpi.h"
+
+#include <hip/hip_runtime.h>
+#include <chrono>
+
+#include "hip_mpitest_utils.h"
+#include "hip_mpitest_buffer.h"
+#include "hip_mpitest_bench.h"
+
+#define NITER_LONG   25
+#define NITER_SHORT  200
+#define NITER_THRESH 131072
+int elements=1048576;
+hip_mpitest_buffer *sendbuf=NULL;
+hip_mpitest_buffer *recvbuf=NULL;
+
+/*
+** Window flavors for one-sided communication.
+**
+** Even ranks access the window of the next odd rank in a passive target epoch
+** (MPI_Win_lock_all). For every window flavor, operation and count of doubles
+** up to -n (multiplied by 4 starting at 1) the benchmark reports
+**   - the time to create the window in ms, including attaching the memory and
+**     exchanging its address for dynamic windows,
+**   - the latency of a single operation followed by MPI_Win_flush in us,
+**   - the bandwidth in MB/s of a window of operations followed by MPI_Win_flush.
+**
+** The sweep is configured by environment variables:
+**   HIP_MPITEST_OSC_WIN     comma separated list of window flavors (default: all)
+**                           create    MPI_Win_create on the receive buffer
+**                           allocate  MPI_Win_allocate
+**                           shared    MPI_Win_allocate_shared on the processes of a node
+**                           dynamic   MPI_Win_create_dynamic, receive buffer attached
+**   HIP_MPITEST_OSC_OP      comma separated list of operations (default put,get,store,load)
+**                           put, get  MPI_Put and MPI_Get
+**                           store,    direct copy to/from the segment of the target
+**                           load      returned by MPI_Win_shared_query, completed by
+**                                     MPI_Win_sync (shared windows only)
+**   HIP_MPITEST_OSC_WINDOW  number of operations between two flushes in the
+**                           bandwidth test (default 64)
+**
+** The origin buffer is the send buffer. Windows created by MPI_Win_create and
+** MPI_Win_create_dynamic expose the receive buffer, i.e. the memory type given
+** with -r, while the memory of windows allocated by the MPI library is host
+** memory. Shared windows are skipped if a pair of processes is not on the same
+** node.
+*/
+
+#define OSC_WIN_CREATE   0
+#define OSC_WIN_ALLOCATE 1
+#define OSC_WIN_SHARED   2
+#define OSC_WIN_DYNAMIC  3
+#define OSC_WIN_LAST     4
+
+#define OSC_OP_PUT   0
+#define OSC_OP_GET   1
+#define OSC_OP_STORE 2
+#define OSC_OP_LOAD  3
+#define OSC_OP_LAST  4
+
+static const char *osc_win_names[] = {"create", "allocate", "shared", "dynamic", NULL};
+static const char *osc_op_names[]  = {"put", "get", "store", "load", NULL};
+
+typedef struct osc_win_s {
+    MPI_Win   win;
+    MPI_Comm  comm;      // communicator the window was created on
+    int       target;    // rank of the target in comm, if this process is an origin
+    bool      origin;
+    void     *base;      // local window memory
+    bool      attached;
+    MPI_Aint  tdisp;     // displacement of the target memory
+    char     *tptr;      // target segment mapped into this process (shared windows)
+} osc_win_t;
+
+static void init_sendbuf (double *sendbuf, int count, int mynode)
+{
+    for (int i = 0; i < count; i++) {
+        sendbuf[i] = (double)(mynode + i);
+    }
+}
+
+static void init_recvbuf (double *recvbuf, int count)
+{
+    for (int i = 0; i < count; i++) {
+        recvbuf[i] = -1.0;
+    }
+}
+
+static bool check_recvbuf (double *recvbuf, int nprocs, int rank, int count)
+{
+    bool res=true;
+
+    // only odd ranks are targets of a put
+    if (rank % 2 == 0) {
+        return res;
+    }
+    for (int i=0; i<count; i++) {
+        if (recvbuf[i] != (double)(rank - 1 + i)) {
+            res = false;
+#ifdef VERBOSE
+            printf("recvbuf[%d] = %lf expected %lf\n", i, recvbuf[i], (double)(rank - 1 + i));
+#endif
+        }
+    }
+
+    return res;
+}
+
+/*
+** Creates a window of the given flavor on the communicator of the pairs and
+** opens the passive target epoch. For shared windows shmcomm contains the
+** processes of the node. The time is the maximum over all processes.
+*/
+static int osc_win_create (int flavor, void *rbuf, size_t nbytes, MPI_Comm shmcomm,
+                           osc_win_t *w, double *t)
+{
+    std::chrono::high_resolution_clock::time_point t1s, t1e;
+    int rank, size, partner, ret;
+    MPI_Aint addr, *addrs = NULL;
+    MPI_Info info = MPI_INFO_NULL;
+    double tl;
+
+    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+    MPI_Comm_size (MPI_COMM_WORLD, &size);
+    partner = (rank % 2 == 0) ? rank + 1 : rank - 1;
+
+    w->win      = MPI_WIN_NULL;
+    w->comm     = (flavor == OSC_WIN_SHARED) ? shmcomm : MPI_COMM_WORLD;
+    w->origin   = (rank % 2 == 0) && (partner < size);
+    w->target   = MPI_PROC_NULL;
+    w->base     = rbuf;
+    w->attached = false;
+    w->tdisp    = 0;
+    w->tptr     = NULL;
+
+    if (w->origin) {
+        MPI_Group wgroup, group;
+
+        // rank of the partner in the communicator of the window
+        MPI_Comm_group (MPI_COMM_WORLD, &wgroup);
+        MPI_Comm_group (w->comm, &group);
+        MPI_Group_translate_ranks (wgroup, 1, &partner, group, &w->target);
+        MPI_Group_free (&group);
+        MPI_Group_free (&wgroup);
+    }
+
+    MPI_Barrier (MPI_COMM_WORLD);
+    t1s = std::chrono::high_resolution_clock::now();
+    switch (flavor) {
+    case OSC_WIN_CREATE:
+        ret = MPI_Win_create (rbuf, nbytes, 1, MPI_INFO_NULL, w->comm, &w->win);
+        break;
+    case OSC_WIN_ALLOCATE:
+        ret = MPI_Win_allocate (nbytes, 1, MPI_INFO_NULL, w->comm, &w->base, &w->win);
+        break;
+    case OSC_WIN_SHARED:
+        // every process accesses only the segment of its partner
+        MPI_Info_create (&info);
+        MPI_Info_set (info, "alloc_shared_noncontig", "true");
+        ret = MPI_Win_allocate_shared (nbytes, 1, info, w->comm, &w->base, &w->win);
+        MPI_Info_free (&info);
+        break;
+    default:
+        ret = MPI_Win_create_dynamic (MPI_INFO_NULL, w->comm, &w->win);
+        if (MPI_SUCCESS != ret) {
+            break;
+        }
+        ret = MPI_Win_attach (w->win, rbuf, nbytes);
+        if (MPI_SUCCESS != ret) {
+            break;
+        }
+        w->attached = true;
+
+        addrs = (MPI_Aint *) malloc (size * sizeof(MPI_Aint));
+        if (NULL == addrs) {
+            ret = MPI_ERR_OTHER;
+            break;
+        }
+        MPI_Get_address (rbuf, &addr);
+        ret = MPI_Allgather (&addr, 1, MPI_AINT, addrs, 1, MPI_AINT, w->comm);
+        if (w->origin) {
+            w->tdisp = addrs[w->target];
+        }
+        free (addrs);
+        break;
+    }
+    t1e = std::chrono::high_resolution_clock::now();
+    if (MPI_SUCCESS != ret) {
+        return ret;
+    }
+    tl = std::chrono::duration<double>(t1e-t1s).count();
+    MPI_Allreduce (&tl, t, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+
+    if (flavor == OSC_WIN_SHARED && w->origin) {
+        MPI_Aint segsize;
+        int dispunit;
+
+        ret = MPI_Win_shared_query (w->win, w->target, &segsize, &dispunit, &w->tptr);
+        if (MPI_SUCCESS != ret) {
+            return ret;
+        }
+    }
+
+    return MPI_Win_lock_all (MPI_MODE_NOCHECK, w->win);
+}
+
+static void osc_win_free (osc_win_t *w)
+{
+    if (MPI_WIN_NULL == w->win) {
+        return;
+    }
+    MPI_Win_unlock_all (w->win);
+    if (w->attached) {
+        MPI_Win_detach (w->win, w->base);
+    }
+    MPI_Win_free (&w->win);
+}
+
+/*
+** Executes niterations times a window of operations on count doubles followed
+** by a flush. Direct copies use hipMemcpy if the origin buffer is device memory.
+*/
+static int osc_test (osc_win_t *w, int op, void *sbuf, int count, int window,
+                     bool devorigin, int niterations)
+{
+    size_t nbytes = (size_t)count * sizeof(double);
+    int ret = MPI_SUCCESS;
+
+    if (!w->origin) {
+        return MPI_SUCCESS;
+    }
+
+    for (int i=0; i<niterations; i++) {
+        HIP_MPITEST_TRACE_BEGIN();
+        for (int j=0; j<window; j++) {
+            switch (op) {
+            case OSC_OP_PUT:
+                ret = MPI_Put (sbuf, count, MPI_DOUBLE, w->target, w->tdisp, count, MPI_DOUBLE, w->win);
+                break;
+            case OSC_OP_GET:
+                ret = MPI_Get (sbuf, count, MPI_DOUBLE, w->target, w->tdisp, count, MPI_DOUBLE, w->win);
+                break;
+            case OSC_OP_STORE:
+                if (devorigin) {
+                    ret = (hipSuccess == hipMemcpy (w->tptr, sbuf, nbytes, hipMemcpyDefault)) ?
+                        MPI_SUCCESS : MPI_ERR_OTHER;
+                }
+                else {
+                    memcpy (w->tptr, sbuf, nbytes);
+                }
+                break;
+            default:
+                if (devorigin) {
+                    ret = (hipSuccess == hipMemcpy (sbuf, w->tptr, nbytes, hipMemcpyDefault)) ?
+                        MPI_SUCCESS : MPI_ERR_OTHER;
+                }
+                else {
+                    memcpy (sbuf, w->tptr, nbytes);
+                }
+                break;
+            }
+            if (MPI_SUCCESS != ret) {
+                return ret;
+            }
+        }
+        if (op == OSC_OP_PUT || op == OSC_OP_GET) {
+            ret = MPI_Win_flush (w->target, w->win);
+        }
+        else {
+            ret = MPI_Win_sync (w->win);
+        }
+        HIP_MPITEST_TRACE_END(osc_op_names[op], count * window, MPI_DOUBLE);
+        if (MPI_SUCCESS != ret) {
+            return ret;
+        }
+    }
+
+    return MPI_SUCCESS;
+}
+
+// Returns the maximum time of niter iterations over all processes
+static int osc_time (osc_win_t *w, int op, void *sbuf, int count, int window,
+                     bool devorigin, int niter, double *t)
+{
+    std::chrono::high_resolution_clock::time_point t1s, t1e;
+    double tl;
+    int ret;
+
+    //Warmup
+    ret = osc_test (w, op, sbuf, count, window, devorigin, 1);
+    if (MPI_SUCCESS != ret) {
+        return ret;
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    t1s = std::chrono::high_resolution_clock::now();
+    ret = osc_test (w, op, sbuf, count, window, devorigin, niter);
+    if (MPI_SUCCESS != ret) {
+        return ret;
+    }
+    t1e = std::chrono::high_resolution_clock::now();
+    tl = std::chrono::duration<double>(t1e-t1s).count();
+
+    MPI_Allreduce (&tl, t, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    return MPI_SUCCESS;
+}
+
+int main (int argc, char *argv[])
+{
+    int ret = MPI_SUCCESS;
+    int rank, size, shmsize, window, local, alllocal;
+    int nflavors, flavors[OSC_WIN_LAST], nops, ops[OSC_OP_LAST];
+    bool devorigin;
+    double tcreate, tlat, tbw;
+    double *tmp_sendbuf=NULL, *tmp_recvbuf=NULL;
+    MPI_Comm shmcomm = MPI_COMM_NULL;
+    osc_win_t w;
+    char *env;
+
+    bind_device();
+
+    MPI_Init      (&argc, &argv);
+    MPI_Comm_size (MPI_COMM_WORLD, &size);
+    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+
+    parse_args(argc, argv, MPI_COMM_WORLD);
+    if (size < 2) {
+        if (rank == 0) {
+            fprintf(stderr, "The window benchmark requires at least two processes\n");
+        }
+        MPI_Abort (MPI_COMM_WORLD, 1);
+        return 1;
+    }
+
+    nflavors = bench_parse_names ("HIP_MPITEST_OSC_WIN", NULL, osc_win_names, flavors, OSC_WIN_LAST, MPI_COMM_WORLD);
+    nops     = bench_parse_names ("HIP_MPITEST_OSC_OP", NULL, osc_op_names, ops, OSC_OP_LAST, MPI_COMM_WORLD);
+    if (nflavors < 0 || nops < 0) {
+        MPI_Abort (MPI_COMM_WORLD, 1);
+        return 1;
+    }
+    env    = getenv("HIP_MPITEST_OSC_WINDOW");
+    window = (NULL != env && atoi(env) > 0) ? atoi(env) : 64;
+    w.win  = MPI_WIN_NULL;
+
+    // shared windows require both processes of every pair to be on the same node
+    MPI_Comm_split_type (MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &shmcomm);
+    MPI_Comm_size (shmcomm, &shmsize);
+    {
+        MPI_Group wgroup, shmgroup;
+        int partner = (rank % 2 == 0) ? rank + 1 : rank - 1, lpartner = 0;
+
+        MPI_Comm_group (MPI_COMM_WORLD, &wgroup);
+        MPI_Comm_group (shmcomm, &shmgroup);
+        if (partner < size) {
+            MPI_Group_translate_ranks (wgroup, 1, &partner, shmgroup, &lpartner);
+        }
+        local = (lpartner != MPI_UNDEFINED);
+        MPI_Group_free (&shmgroup);
+        MPI_Group_free (&wgroup);
+    }
+    MPI_Allreduce (&local, &alllocal, 1, MPI_INT, MPI_LAND, MPI_COMM_WORLD);
+
+    // Initialise send buffer
+    ALLOCATE_SENDBUFFER(sendbuf, tmp_sendbuf, double, elements, sizeof(double),
+                        rank, MPI_COMM_WORLD, init_sendbuf, out);
+
+    // Initialize recv buffer
+    ALLOCATE_RECVBUFFER(recvbuf, tmp_recvbuf, double, elements, sizeof(double),
+                        rank, MPI_COMM_WORLD, init_recvbuf, out);
+    devorigin = (sendbuf->get_memchar() == 'D');
+
+    if (rank == 0 ) {
+        printf("Benchmark: %s %c %c - %d processes\n\n", argv[0],  sendbuf->get_memchar(), recvbuf->get_memchar(), size);
+        printf("%8s %6s %10s \t %10s \t %10s \t %10s\n", "window", "op", "count", "create ms", "lat us", "MB/s");
+        printf("============================================================================\n");
+    }
+
+    for (int k=0; k<nflavors; k++) {
+        int f = flavors[k];
+
+        if (f == OSC_WIN_SHARED && !alllocal) {
+            if (rank == 0) {
+                printf("%8s skipped, not all pairs of processes are on the same node\n", osc_win_names[f]);
+            }
+            continue;
+        }
+        for (int l=0; l<nops; l++) {
+            int o = ops[l];
+
+            if ((o == OSC_OP_STORE || o == OSC_OP_LOAD) && f != OSC_WIN_SHARED) {
+                continue;
+            }
+
+            ret = osc_win_create (f, recvbuf->get_buffer(), elements * sizeof(double), shmcomm,
+                                  &w, &tcreate);
+            if (MPI_SUCCESS != ret) {
+                fprintf(stderr, "Error creating %s window. Aborting\n", osc_win_names[f]);
+                goto out;
+            }
+
+            for (int count=1; count<=elements; count*=4) {
+                int niter = count >= NITER_THRESH ? NITER_LONG : NITER_SHORT;
+
+                ret = osc_time (&w, o, sendbuf->get_buffer(), count, 1, devorigin, niter, &tlat);
+                if (MPI_SUCCESS != ret) {
+                    fprintf(stderr, "Error in osc_test. Aborting\n");
+                    goto out;
+                }
+                ret = osc_time (&w, o, sendbuf->get_buffer(), count, window, devorigin, niter, &tbw);
+                if (MPI_SUCCESS != ret) {
+                    fprintf(stderr, "Error in osc_test. Aborting\n");
+                    goto out;
+                }
+
+#if 0
+                // verify results
+                bool res, fret;
+                res = true;
+                if (o == OSC_OP_PUT || o == OSC_OP_STORE) {
+                    // all origins are done when osc_time returns
+                    MPI_Win_sync (w.win);
+                    if (w.base != recvbuf->get_buffer()) {
+                        res = check_recvbuf((double*) w.base, size, rank, count);
+                    }
+                    else if (recvbuf->NeedsStagingBuffer()) {
+                        HIP_CHECK(recvbuf->CopyFrom(tmp_recvbuf, elements*sizeof(double)));
+                        res = check_recvbuf(tmp_recvbuf, size, rank, count);
+                    }
+                    else {
+                        res = check_recvbuf((double*) recvbuf->get_buffer(), size, rank, count);
+                    }
+                }
+                else if (w.origin) {
+                    // gets and loads overwrite the origin buffer, restore it for the next puts
+                    if (sendbuf->NeedsStagingBuffer()) {
+                        HIP_CHECK(sendbuf->CopyTo(tmp_sendbuf, elements*sizeof(double)));
+                    }
+                    else {
+                        init_sendbuf((double*) sendbuf->get_buffer(), elements, rank);
+                    }
+                }
+
+                fret = report_testresult(argv[0], MPI_COMM_WORLD, sendbuf->get_memchar(), recvbuf->get_memchar(), res);
+#endif
+                if (rank == 0) {
+                    printf("%8s %6s %10d \t %10.3lf \t %10.2lf \t %10.2lf\n", osc_win_names[f], osc_op_names[o],
+                           count, tcreate * 1e3, tlat / niter * 1e6,
+                           (double)count * sizeof(double) * window * niter / tbw / 1e6);
+                }
+            }
+            osc_win_free (&w);
+        }
+    }
+
+ out:
+    osc_win_free (&w);
+    if (MPI_COMM_NULL != shmcomm) {
+        MPI_Comm_free (&shmcomm);
+    }
+
+    //Free buffers
+    FREE_BUFFER(sendbuf, tmp_sendbuf);
+    FREE_BUFFER(recvbuf, tmp_recvbuf);
+
+    delete (sendbuf);
+    delete (recvbuf);
+
+    if (MPI_SUCCESS != ret ) {
+        MPI_Abort (MPI_COMM_WORLD, 1);
+        return 1;
+    }
+    MPI_Finalize ();
+    return ret;
+}
@@ -0,0 +1,498 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include "mpi.h"
+
+#include <hip/hip_runtime.h>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+#include "hip_mpitest_utils.h"
+#include "hip_mpitest_buffer.h"
+
+#define NITER_LONG   25
+#define NITER_SHORT  200
+#define NITER_THRESH 131072
+int elements=100;
+hip_mpitest_buffer *sendbuf=NULL;
+hip_mpitest_buffer *recvbuf=NULL;
+
+/*
+** Partitioned point-to-point communication (MPI_Psend_init/MPI_Precv_init).
+**
+** Even ranks send to the next odd rank. The message of elements doubles is
+** split into partitions, which are produced by a set of producer threads on
+** the sender: each thread produces the partitions p with p % nthreads == tid,
+** waits the production time for each of them and marks it ready with
+** MPI_Pready. With a single producer the partitions are marked ready in order
+** by the main thread, as a stand-in for the completion of a device kernel
+** producing the data progressively. The receiver polls MPI_Parrived.
+**
+** For each message length the time from the start of the production to the
+** arrival of the first and the last partition at the receiver is reported,
+** together with the time to last byte of a single persistent send of the same
+** total size started after all partitions have been produced. A ratio below
+** one means that the implementation overlaps the transfer of the ready
+** partitions with the production of the others.
+**
+** The benchmark is configured by environment variables:
+**   HIP_MPITEST_PART_PARTITIONS  number of partitions (default 8)
+**   HIP_MPITEST_PART_THREADS     number of producer threads (default: one per
+**                                partition), requires MPI_THREAD_MULTIPLE
+**   HIP_MPITEST_PART_DELAY       production time per partition in microseconds
+**                                (default 0)
+*/
+
+#if HIP_MPITEST_PARTITIONED
+
+static int    part_partitions=8;
+static int    part_nthreads=8;
+static double part_delay=0.0;
+
+// producer threads, blocked on part_cond between iterations and woken up by
+// incrementing the generation, such that idle producers do not take the cores
+// of the main thread and of the progress thread of the MPI library
+static std::vector<std::thread> part_threads;
+static std::mutex               part_mutex;
+static std::condition_variable  part_cond;
+static int                      part_generation=0;
+static int                      part_done=0;
+static bool                     part_stop=false;
+static MPI_Request              part_request;
+static bool                     part_pready;
+
+static void part_produce (int partition)
+{
+    std::chrono::high_resolution_clock::time_point ts = std::chrono::high_resolution_clock::now();
+
+    // stand-in for the computation of the partition
+    while (std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - ts).count() < part_delay) {
+    }
+    if (part_pready) {
+        MPI_Pready (partition, part_request);
+    }
+}
+
+static void part_producer (int tid)
+{
+    int generation = 0;
+
+    while (1) {
+        {
+            std::unique_lock<std::mutex> lock(part_mutex);
+            part_cond.wait(lock, [&] { return part_generation != generation || part_stop; });
+            if (part_stop) {
+                break;
+            }
+            generation = part_generation;
+        }
+        for (int p=tid; p<part_partitions; p+=part_nthreads) {
+            part_produce (p);
+        }
+        {
+            std::lock_guard<std::mutex> lock(part_mutex);
+            part_done++;
+        }
+        part_cond.notify_all();
+    }
+}
+
+// produce all partitions, marking them ready with MPI_Pready if pready is set
+static void part_produce_all (MPI_Request request, bool pready)
+{
+    part_request = request;
+    part_pready  = pready;
+    if (part_threads.empty()) {
+        for (int p=0; p<part_partitions; p++) {
+            part_produce (p);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(part_mutex);
+        part_done = 0;
+        part_generation++;
+    }
+    part_cond.notify_all();
+
+    std::unique_lock<std::mutex> lock(part_mutex);
+    part_cond.wait(lock, [] { return part_done == part_nthreads; });
+}
+
+static int part_init (MPI_Comm comm, int provided)
+{
+    char *env;
+    int rank, size;
+
+    MPI_Comm_rank (comm, &rank);
+    MPI_Comm_size (comm, &size);
+
+    if (size < 2) {
+        if (rank == 0) {
+            fprintf(stderr, "The partitioned benchmark requires at least two processes\n");
+        }
+        return MPI_ERR_ARG;
+    }
+
+    env = getenv("HIP_MPITEST_PART_PARTITIONS");
+    if (NULL != env) {
+        part_partitions = atoi(env);
+    }
+    part_nthreads = part_partitions;
+    env = getenv("HIP_MPITEST_PART_THREADS");
+    if (NULL != env) {
+        part_nthreads = atoi(env);
+    }
+    env = getenv("HIP_MPITEST_PART_DELAY");
+    if (NULL != env) {
+        part_delay = atof(env) * 1e-6;
+    }
+    if (part_partitions < 1 || part_nthreads < 1 || part_nthreads > part_partitions) {
+        if (rank == 0) {
+            fprintf(stderr, "Invalid number of partitions (%d) or producer threads (%d)\n",
+                    part_partitions, part_nthreads);
+        }
+        return MPI_ERR_ARG;
+    }
+    if (part_nthreads > 1 && provided < MPI_THREAD_MULTIPLE) {
+        if (rank == 0) {
+            fprintf(stderr, "MPI_THREAD_MULTIPLE not provided, using a single producer\n");
+        }
+        part_nthreads = 1;
+    }
+
+    // producer threads are only needed on the sending processes
+    if (part_nthreads > 1 && rank % 2 == 0 && rank + 1 < size) {
+        for (int t=0; t<part_nthreads; t++) {
+            part_threads.push_back(std::thread(part_producer, t));
+        }
+    }
+    return MPI_SUCCESS;
+}
+
+static void part_finalize (void)
+{
+    {
+        std::lock_guard<std::mutex> lock(part_mutex);
+        part_stop = true;
+    }
+    part_cond.notify_all();
+    for (auto &t : part_threads) {
+        t.join();
+    }
+    part_threads.clear();
+}
+
+static void init_sendbuf (double *sendbuf, int count, int mynode)
+{
+    for (int i = 0; i < count; i++) {
+        sendbuf[i] = (double)(mynode + i);
+    }
+}
+
+static void init_recvbuf (double *recvbuf, int count)
+{
+    for (int i = 0; i < count; i++) {
+        recvbuf[i] = -1.0;
+    }
+}
+
+static bool check_recvbuf (double *recvbuf, int nprocs, int rank, int count)
+{
+    bool res=true;
+
+    // only odd ranks with an even partner receive data
+    if (rank % 2 == 0) {
+        return res;
+    }
+    for (int i=0; i<count; i++) {
+        if (recvbuf[i] != (double)(rank - 1 + i)) {
+            res = false;
+#ifdef VERBOSE
+            printf("recvbuf[%d] = %lf expected %lf\n", i, recvbuf[i], (double)(rank - 1 + i));
+#endif
+        }
+    }
+
+    return res;
+}
+
+/*
+** Executes niterations partitioned (partitioned=true) or persistent transfers.
+** On the receiver, tfirst and tlast accumulate the time from the start of the
+** iteration to the arrival of the first and last partition.
+*/
+static int part_test (void *sendbuf, void *recvbuf, int count, bool partitioned,
+                      MPI_Comm comm, int niterations, double *tfirst, double *tlast)
+{
+    int rank, size, ret;
+    int tag = 253;
+    MPI_Request req = MPI_REQUEST_NULL;
+    std::chrono::high_resolution_clock::time_point ts;
+    std::vector<int> arrived(part_partitions);
+
+    MPI_Comm_rank (comm, &rank);
+    MPI_Comm_size (comm, &size);
+    *tfirst = 0.0;
+    *tlast  = 0.0;
+
+    bool sender   = (rank % 2 == 0) && (rank + 1 < size);
+    bool receiver = (rank % 2 == 1);
+    int  partcount = count / part_partitions;
+
+    if (partitioned && sender) {
+        ret = MPI_Psend_init (sendbuf, part_partitions, partcount, MPI_DOUBLE, rank + 1, tag,
+                              comm, MPI_INFO_NULL, &req);
+    }
+    else if (partitioned && receiver) {
+        ret = MPI_Precv_init (recvbuf, part_partitions, partcount, MPI_DOUBLE, rank - 1, tag,
+                              comm, MPI_INFO_NULL, &req);
+    }
+    else if (sender) {
+        ret = MPI_Send_init (sendbuf, count, MPI_DOUBLE, rank + 1, tag, comm, &req);
+    }
+    else if (receiver) {
+        ret = MPI_Recv_init (recvbuf, count, MPI_DOUBLE, rank - 1, tag, comm, &req);
+    }
+    else {
+        ret = MPI_SUCCESS;
+    }
+    if (MPI_SUCCESS != ret) {
+        return ret;
+    }
+
+    for (int i=0; i<niterations; i++) {
+        if (receiver) {
+            ret = MPI_Start (&req);
+            if (MPI_SUCCESS != ret) {
+                goto out;
+            }
+        }
+
+        // the production starts at the same time on all processes
+        MPI_Barrier (comm);
+        ts = std::chrono::high_resolution_clock::now();
+        HIP_MPITEST_TRACE_BEGIN();
+        if (sender && partitioned) {
+            ret = MPI_Start (&req);
+            if (MPI_SUCCESS != ret) {
+                goto out;
+            }
+            part_produce_all (req, true);
+            ret = MPI_Wait (&req, MPI_STATUS_IGNORE);
+        }
+        else if (sender) {
+            part_produce_all (MPI_REQUEST_NULL, false);
+            ret = MPI_Start (&req);
+            if (MPI_SUCCESS != ret) {
+                goto out;
+            }
+            ret = MPI_Wait (&req, MPI_STATUS_IGNORE);
+        }
+        else if (receiver && partitioned) {
+            int narrived = 0;
+            std::fill(arrived.begin(), arrived.end(), 0);
+            while (narrived < part_partitions) {
+                for (int p=0; p<part_partitions; p++) {
+                    if (arrived[p]) {
+                        continue;
+                    }
+                    ret = MPI_Parrived (req, p, &arrived[p]);
+                    if (MPI_SUCCESS != ret) {
+                        goto out;
+                    }
+                    if (arrived[p]) {
+                        double t = std::chrono::duration<double>(std::chrono::high_resolution_clock::now()-ts).count();
+                        if (narrived == 0) {
+                            *tfirst += t;
+                        }
+                        narrived++;
+                    }
+                }
+            }
+            *tlast += std::chrono::duration<double>(std::chrono::high_resolution_clock::now()-ts).count();
+            ret = MPI_Wait (&req, MPI_STATUS_IGNORE);
+        }
+        else if (receiver) {
+            ret = MPI_Wait (&req, MPI_STATUS_IGNORE);
+            double t = std::chrono::duration<double>(std::chrono::high_resolution_clock::now()-ts).count();
+            *tfirst += t;
+            *tlast  += t;
+        }
+        HIP_MPITEST_TRACE_END(partitioned ? "MPI_Psend/MPI_Precv" : "MPI_Send_init/MPI_Recv_init",
+                              count, MPI_DOUBLE);
+        if (MPI_SUCCESS != ret) {
+            goto out;
+        }
+    }
+
+ out:
+    if (MPI_REQUEST_NULL != req) {
+        MPI_Request_free (&req);
+    }
+    return ret;
+}
+
+int main (int argc, char *argv[])
+{
+    int ret;
+    int rank, size, provided;
+    int max_elements;
+    double tpfirst, tplast, tfirst, tlast, tmax[3], tloc[3];
+    double *tmp_sendbuf=NULL, *tmp_recvbuf=NULL;
+
+    bind_device();
+
+    MPI_Init_thread (&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+    MPI_Comm_size (MPI_COMM_WORLD, &size);
+    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+
+    parse_args(argc, argv, MPI_COMM_WORLD);
+    ret = part_init(MPI_COMM_WORLD, provided);
+    if (MPI_SUCCESS != ret) {
+        MPI_Abort (MPI_COMM_WORLD, 1);
+        return 1;
+    }
+
+    max_elements = elements;
+
+    if (rank == 0 ) {
+        printf("Benchmark: %s %c %c - %d processes\n", argv[0],  sendbuf->get_memchar(), recvbuf->get_memchar(), size);
+        printf("Partitions: %d producer threads: %d production time per partition: %.1lf us\n\n",
+               part_partitions, part_nthreads, part_delay * 1e6);
+        printf("No. of elems \t msg. length \t first part. \t last part. \t persistent \t ratio\n");
+        printf("==================================================================================\n");
+    }
+
+    for (elements=part_partitions; elements<=max_elements; elements *=2 ) {
+        int niter = elements >= NITER_THRESH ? NITER_LONG : NITER_SHORT;
+        tmp_sendbuf = NULL;
+        tmp_recvbuf = NULL;
+
+        // Initialise send buffer
+        ALLOCATE_SENDBUFFER(sendbuf, tmp_sendbuf, double, elements, sizeof(double),
+                            rank, MPI_COMM_WORLD, init_sendbuf, out);
+
+        // Initialize recv buffer
+        ALLOCATE_RECVBUFFER(recvbuf, tmp_recvbuf, double, elements, sizeof(double),
+                            rank, MPI_COMM_WORLD, init_recvbuf, out);
+
+        //Warmup
+        ret = part_test (sendbuf->get_buffer(), recvbuf->get_buffer(), elements, true,
+                         MPI_COMM_WORLD, 1, &tpfirst, &tplast);
+        if (MPI_SUCCESS != ret) {
+            fprintf(stderr, "Error in part_test. Aborting\n");
+            goto out;
+        }
+
+        // execute the partitioned test
+        ret = part_test (sendbuf->get_buffer(), recvbuf->get_buffer(), elements, true,
+                         MPI_COMM_WORLD, niter, &tpfirst, &tplast);
+        if (MPI_SUCCESS != ret) {
+            fprintf(stderr, "Error in part_test. Aborting\n");
+            goto out;
+        }
+
+#if 0
+        // verify results
+        bool res, fret;
+        res = true;
+        if (recvbuf->NeedsStagingBuffer()) {
+            HIP_CHECK(recvbuf->CopyFrom(tmp_recvbuf, elements*sizeof(double)));
+            res = check_recvbuf(tmp_recvbuf, size, rank, elements);
+        }
+        else {
+            res = check_recvbuf((double*) recvbuf->get_buffer(), size, rank, elements);
+        }
+
+        fret = report_testresult(argv[0], MPI_COMM_WORLD, sendbuf->get_memchar(), recvbuf->get_memchar(), res);
+#endif
+
+        // reference: persistent send of the same size after all partitions have been produced
+        ret = part_test (sendbuf->get_buffer(), recvbuf->get_buffer(), elements, false,
+                         MPI_COMM_WORLD, 1, &tfirst, &tlast);
+        if (MPI_SUCCESS != ret) {
+            fprintf(stderr, "Error in part_test. Aborting\n");
+            goto out;
+        }
+        ret = part_test (sendbuf->get_buffer(), recvbuf->get_buffer(), elements, false,
+                         MPI_COMM_WORLD, niter, &tfirst, &tlast);
+        if (MPI_SUCCESS != ret) {
+            fprintf(stderr, "Error in part_test. Aborting\n");
+            goto out;
+        }
+
+        // average over iterations, maximum over receivers
+        tloc[0] = tpfirst / niter;
+        tloc[1] = tplast / niter;
+        tloc[2] = tlast / niter;
+        MPI_Reduce (tloc, tmax, 3, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+        if (rank == 0) {
+            printf("%12d \t %11ld \t %11.6lf \t %10.6lf \t %10.6lf \t %5.3lf\n", elements,
+                   (long)elements * sizeof(double), tmax[0], tmax[1], tmax[2], tmax[1]/tmax[2]);
+        }
+
+        //Free buffers
+        FREE_BUFFER(sendbuf, tmp_sendbuf);
+        FREE_BUFFER(recvbuf, tmp_recvbuf);
+    }
+ out:
+    if (ret != MPI_SUCCESS) {
+        FREE_BUFFER(sendbuf, tmp_sendbuf);
+        FREE_BUFFER(recvbuf, tmp_recvbuf);
+    }
+    delete (sendbuf);
+    delete (recvbuf);
+
+    part_finalize();
+    MPI_Finalize ();
+    return ret;
+}
+
+#else
+
+int main (int argc, char *argv[])
+{
+    int rank;
+
+    bind_device();
+
+    MPI_Init      (&argc, &argv);
+    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+
+    parse_args(argc, argv, MPI_COMM_WORLD);
+    if (rank == 0) {
+        printf("Partitioned communication is not supported by the MPI library\n");
+    }
+    delete (sendbuf);
+    delete (recvbuf);
+    MPI_Finalize ();
+    return 0;
+}
+
+#endif
@@ -0,0 +1,296 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include "mpi.h"
+
+#include <hip/hip_runtime.h>
+#include <chrono>
+#include <vector>
+
+#include "hip_mpitest_utils.h"
+#include "hip_mpitest_buffer.h"
+#include "hip_mpitest_bench.h"
+
+#define NITER_LONG   25
+#define NITER_SHORT  200
+#define NITER_THRESH 131072
+#define MAX_LIST     16
+int elements=100;
+hip_mpitest_buffer *sendbuf=NULL;
+hip_mpitest_buffer *recvbuf=NULL;
+
+/*
+** Pipelined transfer of a large message in chunks.
+**
+** Even ranks send a message of elements doubles to the next odd rank. The
+** message is split into chunks, which are sent with MPI_Isend and received
+** with MPI_Irecv keeping at most window operations outstanding on each side:
+** whenever the window is full, the oldest operation is completed before the
+** next chunk is posted. For every chunk size and window depth the bandwidth
+** in MB/s is reported together with the ratio to a single MPI_Isend/MPI_Irecv
+** of the entire message.
+**
+** The sweep is configured by environment variables:
+**   HIP_MPITEST_PIPE_CHUNK   comma separated list of chunk sizes in bytes, with
+**                            an optional k or m suffix (default 64k,256k,1m,4m)
+**   HIP_MPITEST_PIPE_WINDOW  comma separated list of window depths (default 1,2,4,8)
+** Chunk sizes larger than the message are clamped to the message size, which
+** is measured once per window depth.
+*/
+
+static int pipe_nchunks=0, pipe_chunks[MAX_LIST];
+static int pipe_nwindows=0, pipe_windows[MAX_LIST];
+
+static void init_sendbuf (double *sendbuf, int count, int mynode)
+{
+    for (int i = 0; i < count; i++) {
+        sendbuf[i] = (double)(mynode + i);
+    }
+}
+
+static void init_recvbuf (double *recvbuf, int count)
+{
+    for (int i = 0; i < count; i++) {
+        recvbuf[i] = -1.0;
+    }
+}
+
+static bool check_recvbuf (double *recvbuf, int nprocs, int rank, int count)
+{
+    bool res=true;
+
+    // only odd ranks receive data
+    if (rank % 2 == 0) {
+        return res;
+    }
+    for (int i=0; i<count; i++) {
+        if (recvbuf[i] != (double)(rank - 1 + i)) {
+            res = false;
+#ifdef VERBOSE
+            printf("recvbuf[%d] = %lf expected %lf\n", i, recvbuf[i], (double)(rank - 1 + i));
+#endif
+        }
+    }
+
+    return res;
+}
+
+/*
+** Transfers count doubles niterations times in chunks of chunk doubles with
+** at most window outstanding operations. A chunk of count doubles and a
+** window of one is a monolithic transfer.
+*/
+static int pipe_test (void *sendbuf, void *recvbuf, int count, int chunk, int window,
+                      MPI_Comm comm, int niterations)
+{
+    int rank, size, ret = MPI_SUCCESS;
+    int tag = 254;
+    std::vector<MPI_Request> reqs(window, MPI_REQUEST_NULL);
+
+    MPI_Comm_rank (comm, &rank);
+    MPI_Comm_size (comm, &size);
+
+    bool sender   = (rank % 2 == 0) && (rank + 1 < size);
+    bool receiver = (rank % 2 == 1);
+    if (!sender && !receiver) {
+        return MPI_SUCCESS;
+    }
+
+    for (int i=0; i<niterations; i++) {
+        int slot = 0;
+
+        HIP_MPITEST_TRACE_BEGIN();
+        for (int offset=0; offset<count; offset+=chunk) {
+            int len = (count - offset) < chunk ? (count - offset) : chunk;
+
+            // the slots are reused in order, i.e. the oldest operation is completed first
+            if (MPI_REQUEST_NULL != reqs[slot]) {
+                ret = MPI_Wait (&reqs[slot], MPI_STATUS_IGNORE);
+                if (MPI_SUCCESS != ret) {
+                    return ret;
+                }
+            }
+            if (sender) {
+                ret = MPI_Isend ((double *)sendbuf + offset, len, MPI_DOUBLE, rank + 1, tag, comm, &reqs[slot]);
+            }
+            else {
+                ret = MPI_Irecv ((double *)recvbuf + offset, len, MPI_DOUBLE, rank - 1, tag, comm, &reqs[slot]);
+            }
+            if (MPI_SUCCESS != ret) {
+                return ret;
+            }
+            slot = (slot + 1) % window;
+        }
+        ret = MPI_Waitall (window, reqs.data(), MPI_STATUSES_IGNORE);
+        HIP_MPITEST_TRACE_END(sender ? "MPI_Isend" : "MPI_Irecv", count, MPI_DOUBLE);
+        if (MPI_SUCCESS != ret) {
+            return ret;
+        }
+    }
+
+    return MPI_SUCCESS;
+}
+
+// Returns the maximum time of niter transfers over all processes
+static int pipe_time (void *sendbuf, void *recvbuf, int count, int chunk, int window,
+                      MPI_Comm comm, int niter, double *t)
+{
+    std::chrono::high_resolution_clock::time_point t1s, t1e;
+    double tl;
+    int ret;
+
+    //Warmup
+    ret = pipe_test (sendbuf, recvbuf, count, chunk, window, comm, 1);
+    if (MPI_SUCCESS != ret) {
+        return ret;
+    }
+
+    MPI_Barrier(comm);
+    t1s = std::chrono::high_resolution_clock::now();
+    ret = pipe_test (sendbuf, recvbuf, count, chunk, window, comm, niter);
+    if (MPI_SUCCESS != ret) {
+        return ret;
+    }
+    t1e = std::chrono::high_resolution_clock::now();
+    tl = std::chrono::duration<double>(t1e-t1s).count();
+
+    MPI_Allreduce (&tl, t, 1, MPI_DOUBLE, MPI_MAX, comm);
+    return MPI_SUCCESS;
+}
+
+int main (int argc, char *argv[])
+{
+    int ret = MPI_SUCCESS;
+    int rank, size, niter;
+    double tmono, tpipe, mb;
+    double *tmp_sendbuf=NULL, *tmp_recvbuf=NULL;
+    bool whole=false;
+
+    bind_device();
+
+    MPI_Init      (&argc, &argv);
+    MPI_Comm_size (MPI_COMM_WORLD, &size);
+    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+
+    parse_args(argc, argv, MPI_COMM_WORLD);
+    if (size < 2) {
+        if (rank == 0) {
+            fprintf(stderr, "The pipeline benchmark requires at least two processes\n");
+        }
+        MPI_Abort (MPI_COMM_WORLD, 1);
+        return 1;
+    }
+
+    pipe_nchunks  = bench_parse_ints ("HIP_MPITEST_PIPE_CHUNK", "64k,256k,1m,4m", (int)sizeof(double), true,
+                                      pipe_chunks, MAX_LIST, MPI_COMM_WORLD);
+    pipe_nwindows = bench_parse_ints ("HIP_MPITEST_PIPE_WINDOW", "1,2,4,8", 1, false,
+                                      pipe_windows, MAX_LIST, MPI_COMM_WORLD);
+    if (pipe_nchunks < 0 || pipe_nwindows < 0) {
+        MPI_Abort (MPI_COMM_WORLD, 1);
+        return 1;
+    }
+    niter = elements >= NITER_THRESH ? NITER_LONG : NITER_SHORT;
+    mb    = (double)elements * sizeof(double) / 1e6;
+
+    // Initialise send buffer
+    ALLOCATE_SENDBUFFER(sendbuf, tmp_sendbuf, double, elements, sizeof(double),
+                        rank, MPI_COMM_WORLD, init_sendbuf, out);
+
+    // Initialize recv buffer
+    ALLOCATE_RECVBUFFER(recvbuf, tmp_recvbuf, double, elements, sizeof(double),
+                        rank, MPI_COMM_WORLD, init_recvbuf, out);
+
+    ret = pipe_time (sendbuf->get_buffer(), recvbuf->get_buffer(), elements, elements, 1,
+                     MPI_COMM_WORLD, niter, &tmono);
+    if (MPI_SUCCESS != ret) {
+        fprintf(stderr, "Error in pipe_test. Aborting\n");
+        goto out;
+    }
+
+    if (rank == 0 ) {
+        printf("Benchmark: %s %c %c - %d processes\n\n", argv[0],  sendbuf->get_memchar(), recvbuf->get_memchar(), size);
+        printf("Message length %ld bytes, monolithic transfer %.2lf MB/s\n\n",
+               (long)elements * sizeof(double), mb * niter / tmono);
+        printf("%12s %8s %8s \t %10s \t %6s\n", "chunk", "chunks", "window", "MB/s", "ratio");
+        printf("================================================================\n");
+    }
+
+    for (int c=0; c<pipe_nchunks; c++) {
+        // chunks larger than the message are clamped to the message size,
+        // which is measured only once
+        int chunk = pipe_chunks[c] / sizeof(double);
+        if (chunk < 1) {
+            continue;
+        }
+        if (chunk >= elements) {
+            if (whole) {
+                continue;
+            }
+            chunk = elements;
+            whole = true;
+        }
+        for (int w=0; w<pipe_nwindows; w++) {
+            ret = pipe_time (sendbuf->get_buffer(), recvbuf->get_buffer(), elements, chunk,
+                             pipe_windows[w], MPI_COMM_WORLD, niter, &tpipe);
+            if (MPI_SUCCESS != ret) {
+                fprintf(stderr, "Error in pipe_test. Aborting\n");
+                goto out;
+            }
+
+#if 0
+            // verify results
+            bool res, fret;
+            res = true;
+            if (recvbuf->NeedsStagingBuffer()) {
+                HIP_CHECK(recvbuf->CopyFrom(tmp_recvbuf, elements*sizeof(double)));
+                res = check_recvbuf(tmp_recvbuf, size, rank, elements);
+            }
+            else {
+                res = check_recvbuf((double*) recvbuf->get_buffer(), size, rank, elements);
+            }
+
+            fret = report_testresult(argv[0], MPI_COMM_WORLD, sendbuf->get_memchar(), recvbuf->get_memchar(), res);
+#endif
+            if (rank == 0) {
+                printf("%12ld %8d %8d \t %10.2lf \t %6.3lf\n", (long)chunk * sizeof(double),
+                       (elements + chunk - 1) / chunk, pipe_windows[w], mb * niter / tpipe, tmono / tpipe);
+            }
+        }
+    }
+
+ out:
+    //Free buffers
+    FREE_BUFFER(sendbuf, tmp_sendbuf);
+    FREE_BUFFER(recvbuf, tmp_recvbuf);
+
+    delete (sendbuf);
+    delete (recvbuf);
+
+    if (MPI_SUCCESS != ret ) {
+        MPI_Abort (MPI_COMM_WORLD, 1);
+        return 1;
+    }
+    MPI_Finalize ();
+    return ret;
+}
@@ -0,0 +1,357 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#include <stdio.h>
+#include "mpi.h"
+
+#include <hip/hip_runtime.h>
+#include <chrono>
+
+#include "hip_mpitest_utils.h"
+#include "hip_mpitest_buffer.h"
+#include "hip_mpitest_reduce.h"
+#include "hip_mpitest_reduce_kernel.h"
+
+#define NITER_LONG   25
+#define NITER_SHORT  200
+#define NITER_THRESH 1048576
+int elements=100;
+hip_mpitest_buffer *sendbuf=NULL;
+hip_mpitest_buffer *recvbuf=NULL;
+
+/*
+** Throughput of the local reduction engine of the MPI library.
+**
+** For every element type and operation given with --dtype and --op (comma
+** separated lists, or 'all') and every count up to the number of elements
+** given with -n, the throughput of
+**   mpi:    MPI_Reduce_local on the send and receive buffer memory types
+**   host:   a reference reduction loop on malloc'ed host memory
+**   device: a reference reduction kernel on hipMalloc'ed device memory
+** is reported in GB/s of one input operand, together with the ratios mpi/host
+** and mpi/device. A device buffer reduction with the throughput of the host
+** reference rather than the device reference is most likely executed by
+** the library on the host.
+*/
+
+static hip_mpitest_reduction *reduction=NULL;
+
+static void init_sendbuf (char *sendbuf, int count, int mynode)
+{
+    reduction->init_sendbuf (sendbuf, count, mynode);
+}
+
+static void init_recvbuf (char *recvbuf, int count)
+{
+    reduction->init_recvbuf (recvbuf, count);
+}
+
+static int reduce_local_test (void *sendbuf, void *recvbuf, int count,
+                              MPI_Datatype datatype, MPI_Op op, int niterations);
+
+static double reduce_local_time (double t, int niter, MPI_Comm comm)
+{
+    double tsum=0.0;
+    int size;
+
+    MPI_Comm_size (comm, &size);
+    MPI_Reduce(&t, &tsum, 1, MPI_DOUBLE, MPI_SUM, 0, comm);
+    return tsum/(size*niter);
+}
+
+static double reduce_local_host (int count, int rank, int niter)
+{
+    std::chrono::high_resolution_clock::time_point t1s, t1e;
+    size_t extent = reduction->get_extent();
+    char *in    = (char *) malloc (count * extent);
+    char *inout = (char *) malloc (count * extent);
+    double t = 0.0;
+
+    if (NULL == in || NULL == inout) {
+        goto out;
+    }
+    init_sendbuf (in, count, rank);
+    init_recvbuf (inout, count);
+
+    reduction->reduce_host (in, inout, count);
+    t1s = std::chrono::high_resolution_clock::now();
+    for (int i=0; i<niter; i++) {
+        reduction->reduce_host (in, inout, count);
+    }
+    t1e = std::chrono::high_resolution_clock::now();
+    t = std::chrono::duration<double>(t1e-t1s).count();
+
+ out:
+    free (in);
+    free (inout);
+    return t;
+}
+
+// Returns a negative time if no device or no kernel for the reduction is available
+static double reduce_local_device (const char *dtype, int count, int niter)
+{
+    std::chrono::high_resolution_clock::time_point t1s, t1e;
+    size_t extent = reduction->get_extent();
+    void *in=NULL, *inout=NULL;
+    hipStream_t stream=NULL;
+    int ret=hipSuccess, ndevices=0;
+    double t = -1.0;
+
+    if (hipGetDeviceCount(&ndevices) != hipSuccess || ndevices == 0 ||
+        !hip_mpitest_reduce_kernel_supported(dtype, reduction->get_op())) {
+        return t;
+    }
+
+    HIP_CHECK(hipStreamCreate(&stream));
+    HIP_CHECK(hipMalloc(&in, count * extent));
+    HIP_CHECK(hipMalloc(&inout, count * extent));
+    HIP_CHECK(hipMemset(in, 0, count * extent));
+    HIP_CHECK(hipMemset(inout, 0, count * extent));
+
+    HIP_CHECK(hip_mpitest_reduce_kernel_launch(dtype, reduction->get_op(), in, inout, count, stream));
+    HIP_CHECK(hipStreamSynchronize(stream));
+    t1s = std::chrono::high_resolution_clock::now();
+    for (int i=0; i<niter; i++) {
+        HIP_CHECK(hip_mpitest_reduce_kernel_launch(dtype, reduction->get_op(), in, inout, count, stream));
+    }
+    HIP_CHECK(hipStreamSynchronize(stream));
+    t1e = std::chrono::high_resolution_clock::now();
+    t = std::chrono::duration<double>(t1e-t1s).count();
+
+ out:
+    if (NULL != in) {
+        hipFree (in);
+    }
+    if (NULL != inout) {
+        hipFree (inout);
+    }
+    if (NULL != stream) {
+        hipStreamDestroy (stream);
+    }
+    return ret == hipSuccess ? t : -1.0;
+}
+
+static int reduce_local_run (const char *dtype, int count, MPI_Comm comm)
+{
+    int ret = MPI_SUCCESS;
+    int rank, niter, has_device;
+    size_t extent = reduction->get_extent();
+    char *tmp_sendbuf=NULL, *tmp_recvbuf=NULL;
+    std::chrono::high_resolution_clock::time_point t1s, t1e;
+    double tmpi, thost, tdevice;
+
+    MPI_Comm_rank (comm, &rank);
+    niter = (long)count * extent >= NITER_THRESH ? NITER_LONG : NITER_SHORT;
+
+    // Initialise send buffer
+    ALLOCATE_SENDBUFFER(sendbuf, tmp_sendbuf, char, count, extent,
+                        rank, comm, init_sendbuf, out);
+
+    // Initialize recv buffer
+    ALLOCATE_RECVBUFFER(recvbuf, tmp_recvbuf, char, count, extent,
+                        rank, comm, init_recvbuf, out);
+
+    //Warmup
+    ret = reduce_local_test (sendbuf->get_buffer(), recvbuf->get_buffer(), count,
+                             reduction->get_mpi_type(), reduction->get_mpi_op(), 1);
+    if (MPI_SUCCESS != ret) {
+        fprintf(stderr, "Error in reduce_local_test. Aborting\n");
+        goto out;
+    }
+
+    MPI_Barrier(comm);
+    t1s = std::chrono::high_resolution_clock::now();
+    ret = reduce_local_test (sendbuf->get_buffer(), recvbuf->get_buffer(), count,
+                             reduction->get_mpi_type(), reduction->get_mpi_op(), niter);
+    if (MPI_SUCCESS != ret) {
+        fprintf(stderr, "Error in reduce_local_test. Aborting\n");
+        goto out;
+    }
+    t1e = std::chrono::high_resolution_clock::now();
+    tmpi = std::chrono::duration<double>(t1e-t1s).count();
+
+#if 0
+    // verify results of a single reduction on freshly initialized buffers
+    bool res, fret;
+    res = true;
+    if (recvbuf->NeedsStagingBuffer()) {
+        init_recvbuf(tmp_recvbuf, count);
+        HIP_CHECK(recvbuf->CopyTo(tmp_recvbuf, count*extent));
+    }
+    else {
+        init_recvbuf((char *)recvbuf->get_buffer(), count);
+    }
+    ret = reduce_local_test (sendbuf->get_buffer(), recvbuf->get_buffer(), count,
+                             reduction->get_mpi_type(), reduction->get_mpi_op(), 1);
+    if (MPI_SUCCESS != ret) {
+        fprintf(stderr, "Error in reduce_local_test. Aborting\n");
+        goto out;
+    }
+    if (recvbuf->NeedsStagingBuffer()) {
+        HIP_CHECK(recvbuf->CopyFrom(tmp_recvbuf, count*extent));
+        res = reduction->check_reduce_local(tmp_recvbuf, rank, count);
+    }
+    else {
+        res = reduction->check_reduce_local(recvbuf->get_buffer(), rank, count);
+    }
+
+    fret = report_testresult((char *)reduction->get_name(), comm, sendbuf->get_memchar(), recvbuf->get_memchar(), res);
+#endif
+
+    thost   = reduce_local_host (count, rank, niter);
+    tdevice = reduce_local_device (dtype, count, niter);
+
+    // the device reference is only reported if it is available on all processes
+    MPI_Allreduce (MPI_IN_PLACE, &tdevice, 1, MPI_DOUBLE, MPI_MIN, comm);
+    has_device = tdevice >= 0.0;
+
+    tmpi  = reduce_local_time(tmpi, niter, comm);
+    thost = reduce_local_time(thost, niter, comm);
+    if (has_device) {
+        tdevice = reduce_local_time(tdevice, niter, comm);
+    }
+    if (rank == 0) {
+        double gb = (double)count * extent / 1e9;
+        char devstr[32], ratiostr[32];
+
+        snprintf(devstr, sizeof(devstr), "%10s", "-");
+        snprintf(ratiostr, sizeof(ratiostr), "%10s", "-");
+        if (has_device) {
+            snprintf(devstr, sizeof(devstr), "%10.2lf", gb/tdevice);
+            snprintf(ratiostr, sizeof(ratiostr), "%10.3lf", tdevice/tmpi);
+        }
+        printf("%-18s %10d %12ld \t %10.2lf %10.2lf %s \t %10.3lf %s\n", reduction->get_name(),
+               count, (long)count * extent, gb/tmpi, gb/thost, devstr, thost/tmpi, ratiostr);
+    }
+
+ out:
+    //Free buffers
+    FREE_BUFFER(sendbuf, tmp_sendbuf);
+    FREE_BUFFER(recvbuf, tmp_recvbuf);
+
+    return ret;
+}
+
+// Returns a copy of a comma separated list, with 'all' replaced by all names
+static char *reduce_local_list (const char *list, const char **names)
+{
+    char *res;
+
+    if (strcmp(list, "all") != 0) {
+        return strdup(list);
+    }
+
+    size_t len = 1;
+    for (int t=0; names[t] != NULL; t++) {
+        len += strlen(names[t]) + 1;
+    }
+    res = (char *)calloc(len, 1);
+    for (int t=0; names[t] != NULL; t++) {
+        strcat(res, t == 0 ? "" : ",");
+        strcat(res, names[t]);
+    }
+    return res;
+}
+
+int main (int argc, char *argv[])
+{
+    int ret = MPI_SUCCESS;
+    int rank, size;
+    char *dtypes, *ops, *dtype, *op, *saveptr1, *saveptr2;
+
+    bind_device();
+
+    MPI_Init      (&argc, &argv);
+    MPI_Comm_size (MPI_COMM_WORLD, &size);
+    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+
+    parse_args(argc, argv, MPI_COMM_WORLD);
+
+    dtypes = reduce_local_list (hip_mpitest_dtype, hip_mpitest_dtype_names);
+    ops    = reduce_local_list (hip_mpitest_op, hip_mpitest_op_names);
+
+    if (rank == 0 ) {
+        printf("Benchmark: %s %c %c - %d processes\n\n", argv[0],  sendbuf->get_memchar(), recvbuf->get_memchar(), size);
+        printf("%-18s %10s %12s \t %10s %10s %10s \t %10s %10s\n", "Reduction", "count", "bytes",
+               "mpi GB/s", "host GB/s", "dev GB/s", "mpi/host", "mpi/dev");
+        printf("==================================================================================================================\n");
+    }
+
+    for (dtype = strtok_r(dtypes, ",", &saveptr1); dtype != NULL; dtype = strtok_r(NULL, ",", &saveptr1)) {
+        char *oplist = strdup(ops);
+        for (op = strtok_r(oplist, ",", &saveptr2); op != NULL; op = strtok_r(NULL, ",", &saveptr2)) {
+            reduction = hip_mpitest_reduction_create(dtype, op);
+            if (NULL == reduction) {
+                // not every operation is defined for every datatype
+                if (rank == 0) {
+                    printf("%s %s: invalid combination, skipped\n", dtype, op);
+                }
+                continue;
+            }
+            for (int count = 1; count <= elements; count *= 2) {
+                ret = reduce_local_run(dtype, count, MPI_COMM_WORLD);
+                if (MPI_SUCCESS != ret) {
+                    break;
+                }
+            }
+            delete (reduction);
+            reduction = NULL;
+            if (MPI_SUCCESS != ret) {
+                free (oplist);
+                goto out;
+            }
+        }
+        free (oplist);
+    }
+
+ out:
+    free (dtypes);
+    free (ops);
+    delete (sendbuf);
+    delete (recvbuf);
+
+    if (MPI_SUCCESS != ret ) {
+        MPI_Abort (MPI_COMM_WORLD, 1);
+        return 1;
+    }
+    MPI_Finalize ();
+    return ret;
+}
+
+
+static int reduce_local_test (void *sendbuf, void *recvbuf, int count,
+                              MPI_Datatype datatype, MPI_Op op, int niterations)
+{
+    int ret;
+
+    for (int i=0; i<niterations; i++) {
+        HIP_MPITEST_TRACE_BEGIN();
+        ret = MPI_Reduce_local (sendbuf, recvbuf, count, datatype, op);
+        HIP_MPITEST_TRACE_END("MPI_Reduce_local", count, datatype);
+        if (MPI_SUCCESS != ret) {
+            return ret;
+        }
+    }
+
+    return MPI_SUCCESS;
+}
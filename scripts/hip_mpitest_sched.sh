@@ -0,0 +1,320 @@
+#!/bin/bash
+###############################################################################
+# Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to
+# deal in the Software without restriction, including without limitation the
+# rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+# sell copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+###############################################################################
+
+#
+# Parallel scheduler for the test scripts.
+#
+# Tests are queued with SchedAdd and executed by SchedRun, which starts as many
+# tests at the same time as the GPUs and cores of the node allow. Every test
+# gets min(np, number of GPUs) GPUs through HIP_VISIBLE_DEVICES and
+# np*HIP_MPITEST_SCHED_CORES_PER_RANK cores through taskset (mpirun itself does
+# not bind in that case), runs in a private working directory and is killed
+# after HIP_MPITEST_SCHED_TIMEOUT seconds. Failed tests are retried up to
+# HIP_MPITEST_SCHED_RETRIES times, tests passing only in a retry are reported
+# as flaky. Every attempt N of test IDX writes its output to IDX.tryN.log in the
+# log directory and runs in the working directory IDX.tryN, which is removed if
+# the attempt passed. SchedRun returns 0 if all tests passed and 1 otherwise.
+#
+# The scheduler is configured by environment variables:
+#   HIP_MPITEST_SCHED_JOBS            maximum number of concurrent tests
+#                                     (default 0, i.e. limited by the resources only)
+#   HIP_MPITEST_SCHED_GPUS            number of GPUs (default: GPUs in the KFD topology)
+#   HIP_MPITEST_SCHED_CORES           cores to run on, e.g. 0-15,32-47
+#                                     (default: cores the script is allowed to run on)
+#   HIP_MPITEST_SCHED_CORES_PER_RANK  cores per process (default 1)
+#   HIP_MPITEST_SCHED_TIMEOUT         timeout per test in seconds (default 600)
+#   HIP_MPITEST_SCHED_RETRIES         number of retries of a failed test (default 1)
+#   HIP_MPITEST_SCHED_LOGDIR          directory for the logs (default: new directory in $TMPDIR)
+#   HIP_MPITEST_SCHED_WORKDIR         directory in which a new directory for the working
+#                                     directories is created (default: the log directory)
+#   HIP_MPITEST_SCHED_VERBOSE         1 prints the output of every test when it finishes,
+#                                     0 only the output of failed tests (default 0)
+#
+
+SCHED_SRCDIR=$(cd "$(dirname "${BASH_SOURCE[0]}")/../src" && pwd)
+
+SCHED_JOBS=${HIP_MPITEST_SCHED_JOBS:-0}
+SCHED_CPR=${HIP_MPITEST_SCHED_CORES_PER_RANK:-1}
+SCHED_TIMEOUT=${HIP_MPITEST_SCHED_TIMEOUT:-600}
+SCHED_RETRIES=${HIP_MPITEST_SCHED_RETRIES:-1}
+SCHED_VERBOSE=${HIP_MPITEST_SCHED_VERBOSE:-0}
+
+SCHED_NP=()
+SCHED_LABEL=()
+SCHED_CMD=()
+
+# Expands a list of ranges like 0-3,8 into one number per line
+SchedExpandList() {
+
+    local IFS=,
+    for RANGE in $1 ; do
+	if [[ $RANGE == *-* ]] ; then
+	    seq ${RANGE%-*} ${RANGE#*-}
+	else
+	    echo $RANGE
+	fi
+    done
+}
+
+SchedDetectGpus() {
+
+    local NGPUS=0
+    for GPUID in /sys/class/kfd/kfd/topology/nodes/*/gpu_id ; do
+	if [ -r $GPUID ] && [ "$(cat $GPUID)" != "0" ] ; then
+	    let NGPUS=NGPUS+1
+	fi
+    done
+    echo $NGPUS
+}
+
+# SchedAdd <np> <label> <mpirun arguments>
+SchedAdd() {
+
+    SCHED_NP+=("$1")
+    SCHED_LABEL+=("$2")
+    shift 2
+    SCHED_CMD+=("$*")
+}
+
+# Reserves the GPUs and cores of test $1, sets SCHED_ALLOC_GPUS and SCHED_ALLOC_CORES
+SchedAlloc() {
+
+    local NP=${SCHED_NP[$1]}
+    local NG=$NP NC=$((NP * SCHED_CPR)) GPUS="" CORES="" FOUND
+
+    [ $NG -gt $SCHED_NGPUS ] && NG=$SCHED_NGPUS
+    [ $NC -gt ${#SCHED_CORE_IDS[@]} ] && NC=${#SCHED_CORE_IDS[@]}
+
+    FOUND=0
+    for ((G=0; G<SCHED_NGPUS && FOUND<NG; G++)) ; do
+	if [ ${SCHED_GPU_FREE[$G]} -eq 1 ] ; then
+	    GPUS="$GPUS $G"
+	    let FOUND=FOUND+1
+	fi
+    done
+    [ $FOUND -lt $NG ] && return 1
+
+    FOUND=0
+    for ((C=0; C<${#SCHED_CORE_IDS[@]} && FOUND<NC; C++)) ; do
+	if [ ${SCHED_CORE_FREE[$C]} -eq 1 ] ; then
+	    CORES="$CORES $C"
+	    let FOUND=FOUND+1
+	fi
+    done
+    [ $FOUND -lt $NC ] && return 1
+
+    for G in $GPUS ; do
+	SCHED_GPU_FREE[$G]=0
+    done
+    for C in $CORES ; do
+	SCHED_CORE_FREE[$C]=0
+    done
+    SCHED_ALLOC_GPUS=$GPUS
+    SCHED_ALLOC_CORES=$CORES
+    return 0
+}
+
+SchedStart() {
+
+    local IDX=$1 TRY=$((SCHED_TRIES[$1] + 1)) GPULIST="" CPULIST=""
+    local DIR="$SCHED_WORKDIR/$1.try$TRY" RCFILE="$SCHED_LOGDIR/$1.rc"
+
+    for G in $SCHED_ALLOC_GPUS ; do
+	GPULIST="$GPULIST${GPULIST:+,}$G"
+    done
+    for C in $SCHED_ALLOC_CORES ; do
+	CPULIST="$CPULIST${CPULIST:+,}${SCHED_CORE_IDS[$C]}"
+    done
+    SCHED_RUN_GPUS[$IDX]=$SCHED_ALLOC_GPUS
+    SCHED_RUN_CORES[$IDX]=$SCHED_ALLOC_CORES
+    SCHED_RUN_START[$IDX]=$SECONDS
+
+    rm -f "$RCFILE"
+    mkdir -p "$DIR"
+    (
+	cd "$DIR"
+	if [ -n "$GPULIST" ] ; then
+	    export HIP_VISIBLE_DEVICES=$GPULIST
+	fi
+	if [ $SCHED_PIN -eq 1 ] ; then
+	    timeout -k 30 $SCHED_TIMEOUT taskset -c $CPULIST mpirun --bind-to none ${SCHED_CMD[$IDX]}
+	else
+	    timeout -k 30 $SCHED_TIMEOUT mpirun ${SCHED_CMD[$IDX]}
+	fi
+	echo $? > "$RCFILE.tmp"
+	mv "$RCFILE.tmp" "$RCFILE"
+    ) > "$SCHED_LOGDIR/$IDX.try$TRY.log" 2>&1 < /dev/null &
+    SCHED_RUN_PID[$IDX]=$!
+}
+
+# Releases the resources of test $1 and reports its result, returns 1 if it has to be retried
+SchedFinish() {
+
+    local IDX=$1 TRY=$((SCHED_TRIES[$1] + 1)) RC STATUS ELAPSED
+    local DIR="$SCHED_WORKDIR/$1.try$TRY" LOG="$SCHED_LOGDIR/$1.try$TRY.log"
+
+    RC=$(cat "$SCHED_LOGDIR/$IDX.rc")
+    ELAPSED=$((SECONDS - SCHED_RUN_START[$IDX]))
+    wait ${SCHED_RUN_PID[$IDX]}
+    for G in ${SCHED_RUN_GPUS[$IDX]} ; do
+	SCHED_GPU_FREE[$G]=1
+    done
+    for C in ${SCHED_RUN_CORES[$IDX]} ; do
+	SCHED_CORE_FREE[$C]=1
+    done
+    let SCHED_TRIES[$IDX]=SCHED_TRIES[$IDX]+1
+
+    if [ "$RC" = "0" ] ; then
+	if [ ${SCHED_TRIES[$IDX]} -gt 1 ] ; then
+	    STATUS="FLAKY"
+	    SCHED_FLAKY_LIST+=("${SCHED_LABEL[$IDX]} ($SCHED_LOGDIR/$IDX.try*.log)")
+	else
+	    STATUS="PASS"
+	fi
+	let SUCCESS=SUCCESS+1
+    elif [ ${SCHED_TRIES[$IDX]} -le $SCHED_RETRIES ] ; then
+	STATUS="RETRY"
+    else
+	# timeout returns 124, or 137 if the test had to be killed, which an OOM kill also does
+	if [ "$RC" = "124" ] || { [ "$RC" = "137" ] && [ $ELAPSED -ge $SCHED_TIMEOUT ] ; } ; then
+	    STATUS="TIMEOUT"
+	else
+	    STATUS="FAIL"
+	fi
+	let FAILED=FAILED+1
+	SCHED_FAILED_LIST+=("${SCHED_LABEL[$IDX]} ($SCHED_LOGDIR/$IDX.try*.log)")
+    fi
+
+    if [ $STATUS != "RETRY" ] ; then
+	let COUNTER=COUNTER+1
+    fi
+    printf "[%4d/%d] %-7s %s (%ds)\n" $COUNTER ${#SCHED_CMD[@]} $STATUS "${SCHED_LABEL[$IDX]}" $ELAPSED
+    if [ "$SCHED_VERBOSE" = "1" ] || { [ $STATUS != "PASS" ] && [ $STATUS != "FLAKY" ] ; } ; then
+	cat "$LOG"
+    fi
+    if [ "$RC" = "0" ] ; then
+	rm -rf "$DIR"
+    fi
+
+    [ $STATUS = "RETRY" ] && return 1
+    return 0
+}
+
+SchedRun() {
+
+    local PENDING=() RUNNING=() NEXT STARTED
+
+    if [ -n "$HIP_MPITEST_SCHED_GPUS" ] ; then
+	SCHED_NGPUS=$HIP_MPITEST_SCHED_GPUS
+    else
+	SCHED_NGPUS=$(SchedDetectGpus)
+    fi
+    if [ -n "$HIP_MPITEST_SCHED_CORES" ] ; then
+	SCHED_CORE_IDS=($(SchedExpandList "$HIP_MPITEST_SCHED_CORES"))
+    else
+	SCHED_CORE_IDS=($(SchedExpandList "$(awk '/^Cpus_allowed_list/ {print $2}' /proc/self/status)"))
+    fi
+    if [ ${#SCHED_CORE_IDS[@]} -eq 0 ] ; then
+	SCHED_CORE_IDS=($(seq 0 $(($(nproc) - 1))))
+    fi
+    SCHED_PIN=0
+    if command -v taskset > /dev/null ; then
+	SCHED_PIN=1
+    fi
+    SCHED_LOGDIR=${HIP_MPITEST_SCHED_LOGDIR:-$(mktemp -d "${TMPDIR:-/tmp}/hip_mpitest.XXXXXX")}
+    mkdir -p "$SCHED_LOGDIR"
+    SCHED_WORKDIR=$SCHED_LOGDIR
+    if [ -n "$HIP_MPITEST_SCHED_WORKDIR" ] ; then
+	SCHED_WORKDIR=$(mktemp -d "$HIP_MPITEST_SCHED_WORKDIR/hip_mpitest.XXXXXX") || return 1
+    fi
+
+    SCHED_GPU_FREE=()
+    for ((G=0; G<SCHED_NGPUS; G++)) ; do
+	SCHED_GPU_FREE[$G]=1
+    done
+    SCHED_CORE_FREE=()
+    for ((C=0; C<${#SCHED_CORE_IDS[@]}; C++)) ; do
+	SCHED_CORE_FREE[$C]=1
+    done
+    SCHED_TRIES=()
+    SCHED_FLAKY_LIST=()
+    SCHED_FAILED_LIST=()
+    for ((I=0; I<${#SCHED_CMD[@]}; I++)) ; do
+	PENDING+=($I)
+	SCHED_TRIES[$I]=0
+    done
+
+    let COUNTER=0
+    let SUCCESS=0
+    let FAILED=0
+
+    printf "Running %d tests on %d GPUs and %d cores, logs in %s, working directories in %s\n\n" \
+	   ${#SCHED_CMD[@]} $SCHED_NGPUS ${#SCHED_CORE_IDS[@]} "$SCHED_LOGDIR" "$SCHED_WORKDIR"
+
+    while [ ${#PENDING[@]} -gt 0 ] || [ ${#RUNNING[@]} -gt 0 ] ; do
+	# start every pending test that fits, in the order they were added
+	NEXT=()
+	for IDX in ${PENDING[@]} ; do
+	    if { [ $SCHED_JOBS -eq 0 ] || [ ${#RUNNING[@]} -lt $SCHED_JOBS ] ; } && SchedAlloc $IDX ; then
+		SchedStart $IDX
+		RUNNING+=($IDX)
+	    else
+		NEXT+=($IDX)
+	    fi
+	done
+	PENDING=(${NEXT[@]})
+
+	NEXT=()
+	STARTED=${#RUNNING[@]}
+	for IDX in ${RUNNING[@]} ; do
+	    if [ -f "$SCHED_LOGDIR/$IDX.rc" ] ; then
+		if ! SchedFinish $IDX ; then
+		    PENDING+=($IDX)
+		fi
+	    else
+		NEXT+=($IDX)
+	    fi
+	done
+	RUNNING=(${NEXT[@]})
+	if [ ${#RUNNING[@]} -eq $STARTED ] ; then
+	    sleep 0.2
+	fi
+    done
+
+    # only the working directories of failed attempts are left
+    if [ "$SCHED_WORKDIR" != "$SCHED_LOGDIR" ] ; then
+	rmdir "$SCHED_WORKDIR" 2> /dev/null
+    fi
+
+    printf "\n Executed %d Tests (%d passed %d failed)\n" $COUNTER $SUCCESS $FAILED
+    if [ ${#SCHED_FLAKY_LIST[@]} -gt 0 ] ; then
+	printf "\n Passed only after a retry:\n"
+	printf "   %s\n" "${SCHED_FLAKY_LIST[@]}"
+    fi
+    if [ ${#SCHED_FAILED_LIST[@]} -gt 0 ] ; then
+	printf "\n Failed:\n"
+	printf "   %s\n" "${SCHED_FAILED_LIST[@]}"
+	return 1
+    fi
+    return 0
+}
@@ -120,6 +120,12 @@ ExecTestSm1A "hip_type_resized_short"   "2" "32"         "D H M O R"
 ExecTestSm1A "hip_type_resized_long"    "2" "32"         "D H M O R"
 ExecTestSm1A "hip_type_struct_short"    "2" "32"         "D H M O R"
 ExecTestSm1A "hip_type_struct_long"     "2" "32"         "D H M O R"
+ExecTestSm1A "hip_type_vector"          "2" "32"         "D H M O R"
+ExecTestSm1A "hip_type_hvector"         "2" "32"         "D H M O R"
+ExecTestSm1A "hip_type_indexed"         "2" "32"         "D H M O R"
+ExecTestSm1A "hip_type_indexed_block"   "2" "32"         "D H M O R"
+ExecTestSm1A "hip_type_subarray"        "2" "32"         "D H M O R"
+ExecTestSm1A "hip_type_darray"          "2" "32"         "D H M O R"
 ExecTestSm1A "hip_allreduce"            "4" "32 1048576" "D"
 ExecTestSm1A "hip_reduce"               "4" "32 1048576" "D"
 ExecTestSm1A "hip_reduce_local"         "1" "32"         "D"
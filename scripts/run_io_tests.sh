@@ -26,22 +26,16 @@
 # Alternative is to use RNDV_SCHEME=put_zcopy if one wants to use proto v2
 OPTIONS=" --mca pml ^ucx --mca osc ^ucx --mca smsc_accelerator_priority 80 --mca coll ^hcoll"
 
+# the tests run in the file system of the directory the script is started from
+HIP_MPITEST_SCHED_WORKDIR=${HIP_MPITEST_SCHED_WORKDIR:-$PWD}
+
+source "$(dirname "${BASH_SOURCE[0]}")/hip_mpitest_sched.sh"
+
 ExecTest() {
 
-    let COUNTER=COUNTER+1
-    mpirun $OPTIONS -np $2 ../src/$1
-    if [ $? -eq 0 ]
-    then
-	let SUCCESS=SUCCESS+1
-    else
-	let FAILED=FAILED+1
-    fi
+    SchedAdd "$2" "$1 -np $2" $OPTIONS -np $2 $SCHED_SRCDIR/$1
 }
 
-let COUNTER=0
-let SUCCESS=0
-let FAILED=0
-
 ExecTest "hip_file_write"        "1"
 ExecTest "hip_file_iwrite"       "1"
 ExecTest "hip_file_iwrite_mult"  "1"
@@ -54,4 +48,5 @@ ExecTest "hip_file_iread_mult"   "1"
 ExecTest "hip_file_read_all"     "4"
 ExecTest "hip_file_read_all_2D"  "4"
 
-printf "\n Executed %d Tests (%d passed %d failed)\n" $COUNTER $SUCCESS $FAILED
+SchedRun
+exit $?
@@ -189,13 +189,21 @@ int allgather_test (void *sendbuf, void *recvbuf, int count,
 
     for (int i=0; i<niterations; i++) {
 #if defined HIP_MPITEST_GATHER
+        HIP_MPITEST_TRACE_BEGIN();
         ret = MPI_Gather (sendbuf, count, datatype, recvbuf, count, datatype, 0, comm);
+        HIP_MPITEST_TRACE_END("MPI_Gather", count, datatype);
 #elif defined HIP_MPITEST_GATHERV
+        HIP_MPITEST_TRACE_BEGIN();
         ret = MPI_Gatherv (sendbuf, count, datatype, recvbuf, rcounts, rdispls, datatype, 0, comm);
+        HIP_MPITEST_TRACE_END("MPI_Gatherv", count, datatype);
 #elif defined HIP_MPITEST_ALLGATHERV
+        HIP_MPITEST_TRACE_BEGIN();
         ret = MPI_Allgatherv (sendbuf, count, datatype, recvbuf, rcounts, rdispls, datatype, comm);
+        HIP_MPITEST_TRACE_END("MPI_Allgatherv", count, datatype);
 #else
+        HIP_MPITEST_TRACE_BEGIN();
         ret = MPI_Allgather (sendbuf, count, datatype, recvbuf, count, datatype, comm);
+        HIP_MPITEST_TRACE_END("MPI_Allgather", count, datatype);
 #endif
         if (MPI_SUCCESS != ret) {
             goto out;
@@ -163,9 +163,13 @@ int allreduce_test ( void *sendbuf, void *recvbuf, int count,
 
     for (int i=0; i<niterations; i++) {
 #ifdef HIP_MPITEST_REDUCE
+        HIP_MPITEST_TRACE_BEGIN();
         ret = MPI_Reduce (sendbuf, recvbuf, count, datatype, op, 0, comm);
+        HIP_MPITEST_TRACE_END("MPI_Reduce", count, datatype);
 #else
+        HIP_MPITEST_TRACE_BEGIN();
         ret = MPI_Allreduce (sendbuf, recvbuf, count, datatype, op, comm);
+        HIP_MPITEST_TRACE_END("MPI_Allreduce", count, datatype);
 #endif
         if (MPI_SUCCESS != ret) {
             return ret;
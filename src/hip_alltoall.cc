@@ -196,10 +196,14 @@ int alltoall_test ( void *sendbuf, void *recvbuf, int count,
 
     for (int i=0; i<niterations; i++) {
 #ifdef HIP_MPITEST_ALLTOALLV
+        HIP_MPITEST_TRACE_BEGIN();
         ret = MPI_Alltoallv(sendbuf, scounts, sdispls, datatype,
                             recvbuf, rcounts, rdispls, datatype, comm);
+        HIP_MPITEST_TRACE_END("MPI_Alltoallv", count, datatype);
 #else
+        HIP_MPITEST_TRACE_BEGIN();
         ret = MPI_Alltoall(sendbuf, count, datatype, recvbuf, count, datatype, comm);
+        HIP_MPITEST_TRACE_END("MPI_Alltoall", count, datatype);
 #endif
         if (MPI_SUCCESS != ret) {
             goto out;
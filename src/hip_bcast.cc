@@ -140,6 +140,7 @@ int main (int argc, char *argv[])
 int bcast_test (void *buf, int count, MPI_Datatype datatype, MPI_Comm comm)
 {
     int ret;
+    HIP_MPITEST_TRACE_BEGIN();
 #ifdef HIP_MPITEST_IBCAST
     MPI_Request req;
 
@@ -148,8 +149,10 @@ int bcast_test (void *buf, int count, MPI_Datatype datatype, MPI_Comm comm)
         return ret;
     }
     ret = MPI_Wait (&req, MPI_STATUS_IGNORE);
+    HIP_MPITEST_TRACE_END("MPI_Ibcast", count, datatype);
 #else
     ret = MPI_Bcast (buf, count, datatype, 0, comm);
+    HIP_MPITEST_TRACE_END("MPI_Bcast", count, datatype);
 #endif
 
     return ret;
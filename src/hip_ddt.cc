@@ -29,6 +29,7 @@
 
 #include "hip_mpitest_utils.h"
 #include "hip_mpitest_datatype.h"
+#include "hip_mpitest_datatype_catalog.h"
 #include "hip_mpitest_buffer.h"
 
 
@@ -56,7 +57,11 @@ int main (int argc, char *argv[])
 
     parse_args(argc, argv, comm);
 
-    hip_mpitest_datatype *dat = new (TEST_DATATYPE);
+    // the datatype selected at runtime replaces the compile time default
+    hip_mpitest_datatype *dat = hip_mpitest_datatype_select(comm);
+    if (NULL == dat) {
+        dat = new (TEST_DATATYPE);
+    }
     char *tmp_sendbuf=NULL, *tmp_recvbuf=NULL;
 
     // Initialise send buffer
@@ -137,6 +142,7 @@ int type_p2p_nb_test ( void *sendbuf, void *recvbuf, int count,
     if (right == size) right = 0;
 
     for (int i=0; i<niterations; i++) {
+      HIP_MPITEST_TRACE_BEGIN();
       ret = MPI_Irecv (recvbuf, count, datatype, left, tag, comm, &reqs[1]);
       if (MPI_SUCCESS != ret) {
 	return ret;
@@ -146,6 +152,7 @@ int type_p2p_nb_test ( void *sendbuf, void *recvbuf, int count,
 	return ret;
       }
       ret = MPI_Waitall(2, reqs, MPI_STATUSES_IGNORE);
+      HIP_MPITEST_TRACE_END("MPI_Isend/MPI_Irecv", count, datatype);
       if (MPI_SUCCESS != ret) {
 	return ret;
       }
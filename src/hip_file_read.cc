@@ -33,14 +33,12 @@
 
 #include "hip_mpitest_utils.h"
 #include "hip_mpitest_buffer.h"
+#include "hip_mpitest_rawio.h"
 
 int elements=64*1024*1024;
 hip_mpitest_buffer *sendbuf=NULL;
 hip_mpitest_buffer *recvbuf=NULL;
 
-static void SL_write (int hdl, void *buf, size_t num);
-
-
 static void init_sendbuf (long *sendbuf, int count, int unused)
 {
     for (long i = 0; i < count; i++) {
@@ -80,7 +78,8 @@ int file_read_test (void *sendbuf, int count,
 
 int main (int argc, char *argv[])
 {
-    int ret, fd, old_mask, perm;
+    int ret;
+    char outfile[256], infile[256];
     int rank, size;
     MPI_File fh;
     double t1;
@@ -99,6 +98,8 @@ int main (int argc, char *argv[])
     }
 
     parse_args(argc, argv, MPI_COMM_WORLD);
+    hip_mpitest_io_path ("testout.out", outfile, sizeof(outfile));
+    hip_mpitest_io_path ("testin.in", infile, sizeof(infile));
 
     long *tmp_sendbuf=NULL, *tmp_recvbuf=NULL;
     // Initialise send buffer
@@ -116,24 +117,16 @@ int main (int argc, char *argv[])
                         rank, MPI_COMM_WORLD, init_recvbuf, out);
 
     // Create input file
-    old_mask = umask(022);
-    umask (old_mask);
-    perm = old_mask^0666;
-
-    fd = open ("testout.out", O_CREAT|O_WRONLY, perm );
-    if (-1 == fd) {
+    if (0 != hip_mpitest_rawio_write (outfile, sendbuf->get_buffer(), elements*sizeof(long), 0)) {
         fprintf(stderr, "Error in creating input file. Aborting\n");
         ret = MPI_ERR_OTHER;
         goto out;
     }
-
-    SL_write(fd, sendbuf->get_buffer(), elements*sizeof(long));
-    close (fd);
-    rename ("testout.out", "testin.in");
+    rename (outfile, infile);
     MPI_Barrier(MPI_COMM_WORLD);
 
     // execute file_read test
-    MPI_File_open(MPI_COMM_SELF, "testin.in", MPI_MODE_RDONLY,
+    MPI_File_open(MPI_COMM_SELF, infile, MPI_MODE_RDONLY,
                   MPI_INFO_NULL, &fh);
     MPI_Barrier(MPI_COMM_WORLD);
     t1s = std::chrono::high_resolution_clock::now();
@@ -173,7 +166,7 @@ int main (int argc, char *argv[])
 
     delete (sendbuf);
     delete (recvbuf);
-    unlink("testin.in");
+    unlink(infile);
 
     if (MPI_SUCCESS != ret) {
         MPI_Abort (MPI_COMM_WORLD, 1);
@@ -187,6 +180,7 @@ int file_read_test (void *recvbuf, int count, MPI_Datatype datatype, MPI_File fh
 {
     int ret;
 
+    HIP_MPITEST_TRACE_BEGIN();
 #ifdef HIP_MPITEST_FILE_IREAD
     MPI_Request *req;
     int i;
@@ -210,8 +204,10 @@ int file_read_test (void *recvbuf, int count, MPI_Datatype datatype, MPI_File fh
     }
 
     MPI_Waitall (NBLOCKS, req, MPI_STATUS_IGNORE);
+    HIP_MPITEST_TRACE_END("MPI_File_iread", count, datatype);
 #else
     ret = MPI_File_read (fh, recvbuf, count, datatype, MPI_STATUS_IGNORE);
+    HIP_MPITEST_TRACE_END("MPI_File_read", count, datatype);
 #endif
 
  out:
@@ -220,32 +216,3 @@ int file_read_test (void *recvbuf, int count, MPI_Datatype datatype, MPI_File fh
 #endif
     return ret;
 }
-
-void SL_write (int hdl, void *buf, size_t num )
-{
-    int lcount=0;
-    int a;
-    char *wbuf = ( char *)buf;
-
-    do {
-    a = write ( hdl, wbuf, num);
-    if ( a == -1 ) {
-        if ( errno == EINTR || errno == EAGAIN ||
-             errno == EINPROGRESS || errno == EWOULDBLOCK) {
-            continue;
-        } else {
-            printf("SL_write: error while writing to file %d %s\n", hdl, strerror(errno));
-            return;
-        }
-        lcount++;
-        a=0;
-    }
-
-    num -= a;
-    wbuf += a;
-
-    } while ( num > 0 );
-
-    return;
-}
-
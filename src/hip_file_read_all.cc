@@ -33,14 +33,12 @@
 
 #include "hip_mpitest_utils.h"
 #include "hip_mpitest_buffer.h"
+#include "hip_mpitest_rawio.h"
 
 int elements=64*1024*1024;
 hip_mpitest_buffer *sendbuf=NULL;
 hip_mpitest_buffer *recvbuf=NULL;
 
-static void SL_write (int hdl, void *buf, size_t num);
-
-
 static void init_sendbuf (long *sendbuf, int count, int unused)
 {
     for (long i = 0; i < count; i++) {
@@ -76,7 +74,8 @@ int file_read_all_test (void *sendbuf, int count,
 
 int main (int argc, char *argv[])
 {
-    int ret, fd, old_mask, perm;
+    int ret;
+    char outfile[256], infile[256];
     int rank, size;
     MPI_File fh;
     double t1;
@@ -93,6 +92,8 @@ int main (int argc, char *argv[])
     MPI_Comm_rank (MPI_COMM_WORLD, &rank);
 
     parse_args(argc, argv, MPI_COMM_WORLD);
+    hip_mpitest_io_path ("testout.out", outfile, sizeof(outfile));
+    hip_mpitest_io_path ("testin.in", infile, sizeof(infile));
 
     long *tmp_sendbuf=NULL, *tmp_recvbuf=NULL;
     // Initialise send buffer
@@ -112,25 +113,17 @@ int main (int argc, char *argv[])
 
     // Create input file
     if (rank == 0) {
-        old_mask = umask(022);
-        umask (old_mask);
-        perm = old_mask^0666;
-
-        fd = open ("testout.out", O_CREAT|O_WRONLY, perm );
-        if (-1 == fd) {
+        if (0 != hip_mpitest_rawio_write (outfile, sendbuf->get_buffer(), elements*size*sizeof(long), 0)) {
             fprintf(stderr, "Error in creating input file. Aborting\n");
             ret = MPI_ERR_OTHER;
             goto out;
         }
-
-        SL_write(fd, sendbuf->get_buffer(), elements*size*sizeof(long));
-        close (fd);
-        rename ("testout.out", "testin.in");
+        rename (outfile, infile);
     }
     MPI_Barrier(MPI_COMM_WORLD);
 
     // execute file_read test
-    MPI_File_open(MPI_COMM_WORLD, "testin.in", MPI_MODE_RDONLY,
+    MPI_File_open(MPI_COMM_WORLD, infile, MPI_MODE_RDONLY,
                   MPI_INFO_NULL, &fh);
 
     blength = elements;
@@ -174,7 +167,7 @@ int main (int argc, char *argv[])
     if (rank == 0) {
         FREE_BUFFER(sendbuf, tmp_sendbuf);
         delete (sendbuf);
-        unlink("testin.in");
+        unlink(infile);
     }
 
     FREE_BUFFER(recvbuf, tmp_recvbuf);
@@ -195,35 +188,8 @@ int file_read_all_test (void *recvbuf, int count, MPI_Datatype datatype, MPI_Fil
 {
     int ret;
 
+    HIP_MPITEST_TRACE_BEGIN();
     ret = MPI_File_read_all (fh, recvbuf, count, datatype, MPI_STATUS_IGNORE);
+    HIP_MPITEST_TRACE_END("MPI_File_read_all", count, datatype);
     return ret;
 }
-
-void SL_write (int hdl, void *buf, size_t num )
-{
-    int lcount=0;
-    int a;
-    char *wbuf = ( char *)buf;
-
-    do {
-    a = write ( hdl, wbuf, num);
-    if ( a == -1 ) {
-        if ( errno == EINTR || errno == EAGAIN ||
-             errno == EINPROGRESS || errno == EWOULDBLOCK) {
-            continue;
-        } else {
-            printf("SL_write: error while writing to file %d %s\n", hdl, strerror(errno));
-            return;
-        }
-        lcount++;
-        a=0;
-    }
-
-    num -= a;
-    wbuf += a;
-
-    } while ( num > 0 );
-
-    return;
-}
-
@@ -33,6 +33,7 @@
 
 #include "hip_mpitest_utils.h"
 #include "hip_mpitest_buffer.h"
+#include "hip_mpitest_rawio.h"
 
 int elements=64*1024*1024;
 hip_mpitest_buffer *sendbuf=NULL;
@@ -42,9 +43,6 @@ static int coord[2];
 static int procs_per_dim;
 static int nelem_per_dim;
 
-static void SL_write (int hdl, void *buf, size_t num);
-
-
 static void init_sendbuf (long *sendbuf, int count, int unused)
 {
     for (long i = 0; i < count; i++) {
@@ -87,7 +85,8 @@ int file_read_all_test (void *sendbuf, int count,
 
 int main (int argc, char *argv[])
 {
-    int ret, fd, old_mask, perm;
+    int ret;
+    char outfile[256], infile[256];
     int rank, size;
     MPI_File fh;
     double t1;
@@ -100,6 +99,8 @@ int main (int argc, char *argv[])
     MPI_Comm_rank (MPI_COMM_WORLD, &rank);
 
     parse_args(argc, argv, MPI_COMM_WORLD);
+    hip_mpitest_io_path ("testout.out", outfile, sizeof(outfile));
+    hip_mpitest_io_path ("testin.in", infile, sizeof(infile));
 
     // Verify that the number of processes is a perfect square
     procs_per_dim = sqrt(size);
@@ -136,20 +137,12 @@ int main (int argc, char *argv[])
 
     // Create input file
     if (rank == 0) {
-        old_mask = umask(022);
-        umask (old_mask);
-        perm = old_mask^0666;
-
-        fd = open ("testout.out", O_CREAT|O_WRONLY, perm );
-        if (-1 == fd) {
+        if (0 != hip_mpitest_rawio_write (outfile, sendbuf->get_buffer(), elements*size*sizeof(long), 0)) {
             fprintf(stderr, "Error in creating input file. Aborting\n");
             ret = MPI_ERR_OTHER;
             goto out;
         }
-
-        SL_write(fd, sendbuf->get_buffer(), elements*size*sizeof(long));
-        close (fd);
-        rename ("testout.out", "testin.in");
+        rename (outfile, infile);
     }
     MPI_Barrier(MPI_COMM_WORLD);
 
@@ -175,7 +168,7 @@ int main (int argc, char *argv[])
     MPI_Type_create_subarray(2, arrsizeV, gridsizeV, startV, MPI_ORDER_C, MPI_LONG, &fview);
     MPI_Type_commit (&fview);
 
-    MPI_File_open(gridComm, "testin.in", MPI_MODE_RDONLY,
+    MPI_File_open(gridComm, infile, MPI_MODE_RDONLY,
                   MPI_INFO_NULL, &fh);
     MPI_File_set_view (fh, 0, MPI_LONG, fview, "native", MPI_INFO_NULL);
 
@@ -211,7 +204,7 @@ int main (int argc, char *argv[])
     if (rank == 0) {
         FREE_BUFFER(sendbuf, tmp_sendbuf);
         delete (sendbuf);
-        unlink("testin.in");
+        unlink(infile);
     }
 
     FREE_BUFFER(recvbuf, tmp_recvbuf);
@@ -231,35 +224,8 @@ int file_read_all_test (void *recvbuf, int count, MPI_Datatype datatype, MPI_Fil
 {
     int ret;
 
+    HIP_MPITEST_TRACE_BEGIN();
     ret = MPI_File_read_all (fh, recvbuf, count, datatype, MPI_STATUS_IGNORE);
+    HIP_MPITEST_TRACE_END("MPI_File_read_all", count, datatype);
     return ret;
 }
-
-void SL_write (int hdl, void *buf, size_t num )
-{
-    int lcount=0;
-    int a;
-    char *wbuf = ( char *)buf;
-
-    do {
-    a = write ( hdl, wbuf, num);
-    if ( a == -1 ) {
-        if ( errno == EINTR || errno == EAGAIN ||
-             errno == EINPROGRESS || errno == EWOULDBLOCK) {
-            continue;
-        } else {
-            printf("SL_write: error while writing to file %d %s\n", hdl, strerror(errno));
-            return;
-        }
-        lcount++;
-        a=0;
-    }
-
-    num -= a;
-    wbuf += a;
-
-    } while ( num > 0 );
-
-    return;
-}
-
@@ -80,6 +80,7 @@ int file_write_test (void *sendbuf, int count,
 int main (int argc, char *argv[])
 {
     int ret;
+    char outfile[256];
     int rank, size;
     MPI_File fh;
     double t1;
@@ -98,6 +99,7 @@ int main (int argc, char *argv[])
     }
 
     parse_args(argc, argv, MPI_COMM_WORLD);
+    hip_mpitest_io_path ("testout.out", outfile, sizeof(outfile));
 
     long *tmp_sendbuf=NULL, *tmp_recvbuf=NULL;
     // Initialise send buffer
@@ -109,7 +111,7 @@ int main (int argc, char *argv[])
                         rank, MPI_COMM_WORLD, init_recvbuf, out);
 
     // execute file_write test
-    MPI_File_open(MPI_COMM_SELF, "testout.out", MPI_MODE_CREATE|MPI_MODE_WRONLY,
+    MPI_File_open(MPI_COMM_SELF, outfile, MPI_MODE_CREATE|MPI_MODE_WRONLY,
                   MPI_INFO_NULL, &fh);
     MPI_Barrier(MPI_COMM_WORLD);
     t1s = std::chrono::high_resolution_clock::now();
@@ -129,7 +131,7 @@ int main (int argc, char *argv[])
     bool res, fret;
     res = true;
     int fd;
-    fd = open ("testout.out", O_RDONLY );
+    fd = open (outfile, O_RDONLY );
     if ( -1 != fd ) {
         SL_read(fd, tmp_recvbuf, elements * sizeof(long));
         res = check_recvbuf(tmp_recvbuf, size, rank, elements);
@@ -149,7 +151,7 @@ int main (int argc, char *argv[])
     delete (sendbuf);
     delete (recvbuf);
 
-    unlink("testout.out");
+    unlink(outfile);
     if (MPI_SUCCESS != ret) {
         MPI_Abort (MPI_COMM_WORLD, 1);
         return 1;
@@ -162,6 +164,7 @@ int file_write_test (void *sendbuf, int count, MPI_Datatype datatype, MPI_File f
 {
     int ret;
 
+    HIP_MPITEST_TRACE_BEGIN();
 #ifdef HIP_MPITEST_FILE_IWRITE
     MPI_Request *req;
     int i;
@@ -185,8 +188,10 @@ int file_write_test (void *sendbuf, int count, MPI_Datatype datatype, MPI_File f
     }
 
     MPI_Waitall (NBLOCKS, req, MPI_STATUS_IGNORE);
+    HIP_MPITEST_TRACE_END("MPI_File_iwrite", count, datatype);
 #else
     ret = MPI_File_write (fh, sendbuf, count, datatype, MPI_STATUS_IGNORE);
+    HIP_MPITEST_TRACE_END("MPI_File_write", count, datatype);
 #endif
 
  out:
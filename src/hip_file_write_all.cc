@@ -76,6 +76,7 @@ int file_write_all_test (void *sendbuf, int count,
 int main (int argc, char *argv[])
 {
     int ret;
+    char outfile[256];
     int rank, size;
     MPI_File fh;
     double t1;
@@ -92,6 +93,7 @@ int main (int argc, char *argv[])
     MPI_Comm_rank (MPI_COMM_WORLD, &rank);
 
     parse_args(argc, argv, MPI_COMM_WORLD);
+    hip_mpitest_io_path ("testout.out", outfile, sizeof(outfile));
 
     long *tmp_sendbuf=NULL, *tmp_recvbuf=NULL;
     // Initialise send buffer
@@ -105,7 +107,7 @@ int main (int argc, char *argv[])
     }
 
     // open file and set file view
-    MPI_File_open(MPI_COMM_WORLD, "testout.out", MPI_MODE_CREATE|MPI_MODE_WRONLY,
+    MPI_File_open(MPI_COMM_WORLD, outfile, MPI_MODE_CREATE|MPI_MODE_WRONLY,
                   MPI_INFO_NULL, &fh);
 
     blength = elements;
@@ -135,7 +137,7 @@ int main (int argc, char *argv[])
     res = true;
     if (rank == 0) {
         int fd;
-        fd = open ("testout.out", O_RDONLY );
+        fd = open (outfile, O_RDONLY );
         if ( -1 != fd ) {
             SL_read(fd, tmp_recvbuf, elements * size * sizeof(long));
             res = check_recvbuf(tmp_recvbuf, size, rank, elements);
@@ -156,7 +158,7 @@ int main (int argc, char *argv[])
     if (rank == 0) {
         FREE_BUFFER(recvbuf, tmp_recvbuf);
         delete (recvbuf);
-        unlink("testout.out");
+        unlink(outfile);
     }
 
     MPI_Type_free(&tmptype);
@@ -174,7 +176,9 @@ int file_write_all_test (void *sendbuf, int count, MPI_Datatype datatype, MPI_Fi
 {
     int ret;
 
+    HIP_MPITEST_TRACE_BEGIN();
     ret = MPI_File_write_all (fh, sendbuf, count, datatype, MPI_STATUS_IGNORE);
+    HIP_MPITEST_TRACE_END("MPI_File_write_all", count, datatype);
     return ret;
 }
 
@@ -25,6 +25,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <sys/mman.h>
 
 #include "mpi.h"
 
@@ -42,7 +43,7 @@ static int coord[2];
 static int procs_per_dim;
 static int nelem_per_dim;
 
-static void SL_read ( int hdl, void *buf, size_t num);
+static bool SL_pread ( int hdl, void *buf, size_t num, off_t offset);
 
 static void init_sendbuf (long *sendbuf, int count, int unused)
 {
@@ -56,27 +57,73 @@ static void init_sendbuf (long *sendbuf, int count, int unused)
     }
 }
 
-static void init_recvbuf (long *recvbuf, int count)
+/*
+** Every process verifies its own block of the file in place. The rows of the
+** block are mapped into memory with a single mmap, if that fails they are read
+** one after the other with pread.
+*/
+static bool check_file (const char *filename)
 {
-    for (long i = 0; i < count; i++) {
-        recvbuf[i] = 0.0;
+    bool res=true;
+    long gdim = (long)procs_per_dim * nelem_per_dim;
+    long first = (long)coord[0] * nelem_per_dim * gdim + (long)coord[1] * nelem_per_dim;
+    off_t start = (first * sizeof(long)) & ~((off_t)sysconf(_SC_PAGESIZE) - 1);
+    off_t end = (first + (nelem_per_dim - 1) * gdim + nelem_per_dim) * sizeof(long);
+    char *map = (char *)MAP_FAILED;
+    long *row = NULL;
+    struct stat st;
+    int fd;
+
+    fd = open (filename, O_RDONLY);
+    if (-1 == fd) {
+        return false;
+    }
+    // accessing a mapping beyond the end of the file raises SIGBUS
+    if (0 != fstat (fd, &st) || st.st_size < end) {
+        close (fd);
+        return false;
     }
-}
 
-static bool check_recvbuf(long *recvbuf, int nprocs, int rank_unused, int count)
-{
-    bool res=true;
+    map = (char *)mmap (NULL, end - start, PROT_READ, MAP_SHARED, fd, start);
+    if (MAP_FAILED == map) {
+        row = (long *) malloc (nelem_per_dim * sizeof(long));
+        if (NULL == row) {
+            close (fd);
+            return false;
+        }
+    }
+
+    for (long i = 0; i < nelem_per_dim && res; i++) {
+        long idx = first + i * gdim;
+        long *p;
 
-    for (long i=0; i<count*nprocs; i++) {
-        if (recvbuf[i] != i+1) {
-            res = false;
+        if (MAP_FAILED != map) {
+            p = (long *)(map + idx * sizeof(long) - start);
+        }
+        else {
+            if (!SL_pread(fd, row, nelem_per_dim * sizeof(long), idx * sizeof(long))) {
+                res = false;
+                break;
+            }
+            p = row;
+        }
+        for (long j = 0; j < nelem_per_dim; j++) {
+            if (p[j] != idx + j + 1) {
+                res = false;
 #ifdef VERBOSE
-            printf("recvbuf[%d] = %ld\n", i, recvbuf[i]);
+                printf("file[%ld] = %ld\n", idx + j, p[j]);
 #endif
-            break;
+                break;
+            }
         }
     }
 
+    if (MAP_FAILED != map) {
+        munmap (map, end - start);
+    }
+    free (row);
+    close (fd);
+
     return res;
 }
 
@@ -86,6 +133,7 @@ int file_write_all_test (void *sendbuf, int count,
 int main (int argc, char *argv[])
 {
     int ret;
+    char outfile[256];
     int rank, size;
     MPI_File fh;
     double t1;
@@ -98,6 +146,7 @@ int main (int argc, char *argv[])
     MPI_Comm_rank (MPI_COMM_WORLD, &rank);
 
     parse_args(argc, argv, MPI_COMM_WORLD);
+    hip_mpitest_io_path ("testout.out", outfile, sizeof(outfile));
 
     // Verify that the number of processes is a perfect square
     procs_per_dim = sqrt(size);
@@ -116,17 +165,11 @@ int main (int argc, char *argv[])
     MPI_Cart_create(MPI_COMM_WORLD, 2, dim, period, reorder, &gridComm);
     MPI_Cart_coords(gridComm, rank, 2, coord);
 
-    long *tmp_sendbuf=NULL, *tmp_recvbuf=NULL;
+    long *tmp_sendbuf=NULL;
     // Initialise send buffer
     ALLOCATE_SENDBUFFER(sendbuf, tmp_sendbuf, long, elements, sizeof(long),
                         rank, MPI_COMM_WORLD, init_sendbuf, out);
 
-    if (rank == 0) {
-        // Initialize recv buffer
-        ALLOCATE_RECVBUFFER(recvbuf, tmp_recvbuf, long, elements*size, sizeof(long),
-                            rank, MPI_COMM_WORLD, init_recvbuf, out);
-    }
-
     // open file and set file view
     MPI_Datatype fview;
     int startV[2];
@@ -150,7 +193,7 @@ int main (int argc, char *argv[])
     MPI_Type_create_subarray(2, arrsizeV, gridsizeV, startV, MPI_ORDER_C, MPI_LONG, &fview);
     MPI_Type_commit (&fview);
 
-    MPI_File_open(gridComm, "testout.out", MPI_MODE_CREATE|MPI_MODE_WRONLY,
+    MPI_File_open(gridComm, outfile, MPI_MODE_CREATE|MPI_MODE_WRONLY,
                   MPI_INFO_NULL, &fh);
     MPI_File_set_view (fh, 0, MPI_LONG, fview, "native", MPI_INFO_NULL);
 
@@ -167,18 +210,10 @@ int main (int argc, char *argv[])
     t1e = std::chrono::high_resolution_clock::now();
     t1 = std::chrono::duration<double>(t1e-t1s).count();
 
-    // verify results
+    // verify results, report_testresult reduces the result of all processes
     bool res, fret;
-    res = true;
-    if (rank == 0) {
-        int fd;
-        fd = open ("testout.out", O_RDONLY );
-        if ( -1 != fd ) {
-            SL_read(fd, tmp_recvbuf, elements * size * sizeof(long));
-            res = check_recvbuf(tmp_recvbuf, size, rank, elements);
-            close (fd);
-        }
-    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    res = check_file (outfile);
 
     fret = report_testresult(argv[0], MPI_COMM_WORLD, sendbuf->get_memchar(),
                              '-', res);
@@ -189,11 +224,10 @@ int main (int argc, char *argv[])
     //Free buffers
     FREE_BUFFER(sendbuf, tmp_sendbuf);
     delete (sendbuf);
+    delete (recvbuf);
 
     if (rank == 0) {
-        FREE_BUFFER(recvbuf, tmp_recvbuf);
-        delete (recvbuf);
-        unlink("testout.out");
+        unlink(outfile);
     }
 
     MPI_Type_free(&fview);
@@ -210,40 +244,38 @@ int file_write_all_test (void *sendbuf, int count, MPI_Datatype datatype, MPI_Fi
 {
     int ret;
 
+    HIP_MPITEST_TRACE_BEGIN();
     ret = MPI_File_write_all (fh, sendbuf, count, datatype, MPI_STATUS_IGNORE);
+    HIP_MPITEST_TRACE_END("MPI_File_write_all", count, datatype);
     return ret;
 }
 
-void SL_read ( int hdl, void *buf, size_t num )
+bool SL_pread ( int hdl, void *buf, size_t num, off_t offset )
 {
-    int lcount=0;
-    int a;
+    ssize_t a;
     char *wbuf = (char *)buf;
-    do {
-        a = read (hdl, wbuf, num);
 
-        if(0 == a && num > 0){
-            printf("\nSL_read: Warning: # Bytes read are less than "
-                   "expected file size %d %s\n", hdl, strerror(errno));
-            return;
+    while ( num > 0 ) {
+        a = pread (hdl, wbuf, num, offset);
+
+        if ( 0 == a ) {
+            printf("\nSL_pread: Warning: # Bytes read are less than "
+                   "expected file size %d\n", hdl);
+            return false;
         }
 
         if ( a == -1 ) {
-            if (errno == EINTR       || errno == EAGAIN     ||
-                errno == EINPROGRESS || errno == EWOULDBLOCK) {
+            if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) {
                 continue;
-            } else {
-                printf("SL_read: error while reading from file %d %s\n", hdl, strerror(errno));
-                return;
             }
-            lcount++;
-            a=0;
+            printf("SL_pread: error while reading from file %d %s\n", hdl, strerror(errno));
+            return false;
         }
 
-        num -= a;
-        wbuf += a;
-
-    } while ( num > 0 &&  lcount < 20 );
+        num    -= a;
+        wbuf   += a;
+        offset += a;
+    }
 
-    return;
+    return true;
 }
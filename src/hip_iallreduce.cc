@@ -163,6 +163,8 @@ int iallreduce_test ( void *sendbuf, void *recvbuf, int count,
     MPI_Request request;
 
     for (int i=0; i<niterations; i++) {
+        // the trace event covers the operation from posting to completion
+        HIP_MPITEST_TRACE_BEGIN();
 #ifdef HIP_MPITEST_IREDUCE
         ret = MPI_Ireduce (sendbuf, recvbuf, count, datatype, op, 0, comm, &request);
 #else
@@ -175,6 +177,11 @@ int iallreduce_test ( void *sendbuf, void *recvbuf, int count,
         if (MPI_SUCCESS != ret) {
             return ret;
         }
+#ifdef HIP_MPITEST_IREDUCE
+        HIP_MPITEST_TRACE_END("MPI_Ireduce", count, datatype);
+#else
+        HIP_MPITEST_TRACE_END("MPI_Iallreduce", count, datatype);
+#endif
     }
 
     return MPI_SUCCESS;
@@ -27,25 +27,184 @@
 #include <unistd.h>
 #include <string.h>
 #include <stdlib.h>
+#include <limits.h>
 
 #include "mpi.h"
+#include "hip_mpitest_mpit.h"
+#include "hip_mpitest_skew.h"
 
 
-static void bench_performance (char *exec, MPI_Comm comm, char sendtype, char recvtype,
-                               int elements, long nBytes, int niter, double time)
+/*
+** Parses the comma separated list of names in the environment variable name
+** (default: defval, or all names if defval is NULL) into list, the indices
+** into the NULL terminated array names in the order given. Returns the number
+** of entries, at most maxlist, or -1 if a name is unknown or the list is empty,
+** which rank 0 reports.
+*/
+static inline int bench_parse_names (const char *name, const char *defval, const char **names,
+                                     int *list, int maxlist, MPI_Comm comm)
+{
+    char *env = getenv(name);
+    char *saveptr, *str;
+    int rank, n = 0;
+
+    if (NULL == env && NULL == defval) {
+        for (n=0; names[n] != NULL && n < maxlist; n++) {
+            list[n] = n;
+        }
+        return n;
+    }
+
+    MPI_Comm_rank (comm, &rank);
+    str = strdup(NULL != env ? env : defval);
+    for (char *s = strtok_r(str, ",", &saveptr); s != NULL && n < maxlist;
+         s = strtok_r(NULL, ",", &saveptr)) {
+        int i;
+        for (i=0; names[i] != NULL; i++) {
+            if (strcmp(s, names[i]) == 0) {
+                list[n++] = i;
+                break;
+            }
+        }
+        if (NULL == names[i]) {
+            if (rank == 0) {
+                fprintf(stderr, "Invalid value in %s: %s\n", name, s);
+            }
+            n = -1;
+            break;
+        }
+    }
+    if (0 == n && rank == 0) {
+        fprintf(stderr, "Empty list in %s\n", name);
+    }
+    free (str);
+    return n > 0 ? n : -1;
+}
+
+/*
+** Parses the comma separated list of integers in the environment variable name
+** (default: defval) into list. Every entry has to be at least minval, with sizes
+** an entry may carry a k or m suffix. Returns the number of entries, at most
+** maxlist, or -1 if an entry is invalid or the list is empty, which rank 0 reports.
+*/
+static inline int bench_parse_ints (const char *name, const char *defval, int minval, bool sizes,
+                                    int *list, int maxlist, MPI_Comm comm)
+{
+    char *env = getenv(name);
+    char *saveptr, *str = strdup(NULL != env ? env : defval);
+    int rank, n = 0;
+
+    MPI_Comm_rank (comm, &rank);
+    for (char *s = strtok_r(str, ",", &saveptr); s != NULL && n < maxlist;
+         s = strtok_r(NULL, ",", &saveptr)) {
+        char *end;
+        long val = strtol(s, &end, 10);
+
+        if (sizes && (*end == 'k' || *end == 'K')) {
+            val *= 1024;
+            end++;
+        }
+        else if (sizes && (*end == 'm' || *end == 'M')) {
+            val *= 1024 * 1024;
+            end++;
+        }
+        if (end == s || *end != '\0' || val < minval || val > INT_MAX) {
+            if (rank == 0) {
+                fprintf(stderr, "Invalid value in %s: %s\n", name, s);
+            }
+            n = -1;
+            break;
+        }
+        list[n++] = (int)val;
+    }
+    if (0 == n && rank == 0) {
+        fprintf(stderr, "Empty list in %s\n", name);
+    }
+    free (str);
+    return n > 0 ? n : -1;
+}
+
+/*
+** Creates an info object from a comma separated list of key=value pairs, e.g.
+** the I/O hints in HIP_MPITEST_IO_HINTS. Entries without a value are skipped,
+** MPI_INFO_NULL is returned if there is no pair at all.
+*/
+static inline MPI_Info bench_create_info (const char *hints)
+{
+    MPI_Info info = MPI_INFO_NULL;
+    char *saveptr, *str = strdup(hints);
+
+    for (char *s = strtok_r(str, ",", &saveptr); s != NULL; s = strtok_r(NULL, ",", &saveptr)) {
+        char *value = strchr(s, '=');
+        if (NULL == value) {
+            continue;
+        }
+        *value++ = '\0';
+        if (MPI_INFO_NULL == info) {
+            MPI_Info_create (&info);
+        }
+        MPI_Info_set (info, s, value);
+    }
+    free (str);
+    return info;
+}
+
+/*
+** rankBytes is optional and used by benchmarks in which the processes move
+** different amounts of data (e.g. MPI_Alltoallv): it is the number of bytes
+** sent plus received by this process in one iteration. If provided, the
+** minimum, average and maximum per-process bandwidth in MB/s and the
+** imbalance (maximum over average per-process volume) are reported as well.
+*/
+static inline void bench_performance (char *exec, MPI_Comm comm, char sendtype, char recvtype,
+                                      int elements, long nBytes, int niter, double time,
+                                      long rankBytes=-1)
 {
     int rank, size;
     double t1_sum=0.0;
     double t1_avg=0.0;
+    double pvals[HIP_MPITEST_MPIT_MAX_PVARS], pvals_sum[HIP_MPITEST_MPIT_MAX_PVARS];
+    int npvars;
+    double entry_spread, exit_spread, lifo;
+    bool skew;
+    double bw, vol, bw_min, bw_sum, bw_max, vol_sum, vol_max;
+
+    // sample the performance variables before communicating the timings
+    npvars = bench_mpit_end (pvals);
 
     MPI_Comm_rank (comm, &rank);
     MPI_Comm_size (comm, &size);
 
     MPI_Reduce(&time, &t1_sum, 1, MPI_DOUBLE, MPI_SUM, 0, comm);
+    if (npvars > 0) {
+        PMPI_Reduce(pvals, pvals_sum, npvars, MPI_DOUBLE, MPI_SUM, 0, comm);
+    }
+    skew = bench_skew_end (comm, niter, &entry_spread, &exit_spread, &lifo);
+    if (rankBytes >= 0) {
+        bw = time > 0.0 ? ((double)rankBytes * niter) / (time * 1e6) : 0.0;
+        vol = (double)rankBytes;
+        MPI_Reduce(&bw, &bw_min, 1, MPI_DOUBLE, MPI_MIN, 0, comm);
+        MPI_Reduce(&bw, &bw_max, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+        MPI_Reduce(&bw, &bw_sum, 1, MPI_DOUBLE, MPI_SUM, 0, comm);
+        MPI_Reduce(&vol, &vol_max, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+        MPI_Reduce(&vol, &vol_sum, 1, MPI_DOUBLE, MPI_SUM, 0, comm);
+    }
 
     if (rank == 0) {
         t1_avg = t1_sum/(size*niter);
-        printf("%10d \t %10lu \t %lf\n", elements, (size_t)nBytes, t1_avg);
+        printf("%10d \t %10lu \t %lf", elements, (size_t)nBytes, t1_avg);
+        if (rankBytes >= 0) {
+            printf(" \t bw_min=%.2lf bw_avg=%.2lf bw_max=%.2lf imbalance=%.2lf", bw_min,
+                   bw_sum/size, bw_max, vol_sum > 0.0 ? vol_max/(vol_sum/size) : 1.0);
+        }
+        if (skew) {
+            printf(" \t entry_spread=%lf exit_spread=%lf lifo=%lf", entry_spread, exit_spread, lifo);
+        }
+        // performance variables are summed up over all processes
+        for (int i=0; i<npvars; i++) {
+            bench_mpit_print (i, pvals_sum[i]);
+        }
+        printf("\n");
     }
 }
 
@@ -28,6 +28,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <hip/hip_runtime.h>
+#include "hip_mpitest_pmpi.h"
+#include "hip_mpitest_trace.h"
 
 
 enum HIP_MPITEST_MEMTYPE {
@@ -96,12 +98,16 @@ class hip_mpitest_buffer_host: public hip_mpitest_buffer {
     }
 
     hipError_t CopyTo(void *src, size_t nBytes) {
+	HIP_MPITEST_TRACE_BEGIN();
 	memcpy(buffer, src, nBytes);
+	HIP_MPITEST_TRACE_COPY("CopyTo", nBytes, 'H', memchar);
 	return hipSuccess;
     }
 
     hipError_t CopyFrom(void *dst, size_t nBytes) {
+	HIP_MPITEST_TRACE_BEGIN();
 	memcpy(dst, buffer, nBytes);
+	HIP_MPITEST_TRACE_COPY("CopyFrom", nBytes, memchar, 'H');
 	return hipSuccess;
     }
 };
@@ -129,18 +135,22 @@ class hip_mpitest_buffer_device: public hip_mpitest_buffer {
     }
 
     hipError_t CopyTo(void *src, size_t nBytes) {
+	HIP_MPITEST_TRACE_BEGIN();
 	hipError_t err = hipMemcpy(buffer, src, nBytes, hipMemcpyDefault);
-        if (err != hipSuccess) {
-            return err;
+        if (err == hipSuccess) {
+            err = hipStreamSynchronize(0);
         }
-        return hipStreamSynchronize(0);
+	HIP_MPITEST_TRACE_COPY("CopyTo", nBytes, 'H', memchar);
+        return err;
     }
     hipError_t CopyFrom(void *dst, size_t nBytes) {
+	HIP_MPITEST_TRACE_BEGIN();
 	hipError_t err = hipMemcpy(dst, buffer, nBytes, hipMemcpyDefault);
-        if (err != hipSuccess) {
-            return err;
+        if (err == hipSuccess) {
+            err = hipStreamSynchronize(0);
         }
-        return hipStreamSynchronize(0);
+	HIP_MPITEST_TRACE_COPY("CopyFrom", nBytes, memchar, 'H');
+        return err;
     }
 
 };
@@ -169,19 +179,23 @@ class hip_mpitest_buffer_managed: public hip_mpitest_buffer {
     }
 
     hipError_t CopyTo(void *src, size_t nBytes) {
+	HIP_MPITEST_TRACE_BEGIN();
 	hipError_t err = hipMemcpy(buffer, src, nBytes, hipMemcpyDefault);
-        if (err != hipSuccess) {
-            return err;
+        if (err == hipSuccess) {
+            err = hipStreamSynchronize(0);
         }
-        return hipStreamSynchronize(0);
+	HIP_MPITEST_TRACE_COPY("CopyTo", nBytes, 'H', memchar);
+        return err;
     }
 
     hipError_t CopyFrom(void *dst, size_t nBytes) {
+	HIP_MPITEST_TRACE_BEGIN();
 	hipError_t err = hipMemcpy(dst, buffer, nBytes, hipMemcpyDefault);
-        if (err != hipSuccess) {
-            return err;
+        if (err == hipSuccess) {
+            err = hipStreamSynchronize(0);
         }
-        return hipStreamSynchronize(0);
+	HIP_MPITEST_TRACE_COPY("CopyFrom", nBytes, memchar, 'H');
+        return err;
     }
 };
 
@@ -208,19 +222,23 @@ class hip_mpitest_buffer_hostmalloc: public hip_mpitest_buffer {
     }
 
     hipError_t CopyTo(void *src, size_t nBytes) {
+	HIP_MPITEST_TRACE_BEGIN();
 	hipError_t err = hipMemcpy(buffer, src, nBytes, hipMemcpyDefault);
-        if (err != hipSuccess) {
-            return err;
+        if (err == hipSuccess) {
+            err = hipStreamSynchronize(0);
         }
-        return hipStreamSynchronize(0);
+	HIP_MPITEST_TRACE_COPY("CopyTo", nBytes, 'H', memchar);
+        return err;
     }
 
     hipError_t CopyFrom(void *dst, size_t nBytes) {
+	HIP_MPITEST_TRACE_BEGIN();
 	hipError_t err = hipMemcpy(dst, buffer, nBytes, hipMemcpyDefault);
-        if (err != hipSuccess) {
-            return err;
+        if (err == hipSuccess) {
+            err = hipStreamSynchronize(0);
         }
-        return hipStreamSynchronize(0);
+	HIP_MPITEST_TRACE_COPY("CopyFrom", nBytes, memchar, 'H');
+        return err;
     }
 };
 
@@ -254,12 +272,16 @@ class hip_mpitest_buffer_hostregister: public hip_mpitest_buffer {
     }
 
     hipError_t CopyTo(void *src, size_t nBytes) {
+	HIP_MPITEST_TRACE_BEGIN();
 	memcpy(buffer, src, nBytes);
+	HIP_MPITEST_TRACE_COPY("CopyTo", nBytes, 'H', memchar);
 	return hipSuccess;
     }
 
     hipError_t CopyFrom(void *dst, size_t nBytes) {
+	HIP_MPITEST_TRACE_BEGIN();
 	memcpy(dst, buffer, nBytes);
+	HIP_MPITEST_TRACE_COPY("CopyFrom", nBytes, memchar, 'H');
 	return hipSuccess;
     }
 };
@@ -293,6 +315,8 @@ class hip_mpitest_buffer_hostregister: public hip_mpitest_buffer {
         }                                                                                             \
         _init((_type *)_sendbuf->get_buffer(), _elements, _rank);                                     \
       }                                                                                               \
+      HIP_MPITEST_PMPI_REGISTER(_sendbuf, _elements * _extent);                                       \
+      HIP_MPITEST_TRACE_SENDBUF(_sendbuf);                                                            \
       report_buffertype(_comm, "Sendbuf", sendbuf);                                                   \
     }                                                                                                 \
 }
@@ -325,6 +349,8 @@ class hip_mpitest_buffer_hostregister: public hip_mpitest_buffer {
         }                                                                                             \
         _init((_type*)_recvbuf->get_buffer(), _elements);	                                      \
       }                                                                                               \
+      HIP_MPITEST_PMPI_REGISTER(_recvbuf, _elements * _extent);                                       \
+      HIP_MPITEST_TRACE_RECVBUF(_recvbuf);                                                            \
       report_buffertype(_comm, "Recvbuf", _recvbuf);                                                  \
     }                                                                                                 \
 }
@@ -333,6 +359,7 @@ class hip_mpitest_buffer_hostregister: public hip_mpitest_buffer {
     if (_buf->NeedsStagingBuffer() ){ \
        free (_tmp_buf);               \
     }                                 \
+    HIP_MPITEST_PMPI_DEREGISTER(_buf);\
     HIP_CHECK(_buf->Free());          \
 }
 
@@ -0,0 +1,80 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#ifndef __HIP_MPITEST_CLOCK__
+#define __HIP_MPITEST_CLOCK__
+
+#include <chrono>
+#include "mpi.h"
+
+#define HIP_MPITEST_CLOCK_NPINGS 20
+#define HIP_MPITEST_CLOCK_TAG    4711
+
+static inline double hip_mpitest_clock_now (void)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+** Estimates the offset of the local clock to the clock of rank 0 of comm,
+** i.e. t_rank0 = t_local + offset. Rank 0 answers HIP_MPITEST_CLOCK_NPINGS
+** ping-pongs of every other process with its current time. Each process
+** uses the sample with the smallest round-trip time and assumes that the
+** time of rank 0 was taken halfway through the round-trip. The messages
+** bypass the PMPI profiling layer to not count as traffic of the benchmark.
+*/
+static inline double hip_mpitest_clock_sync (MPI_Comm comm)
+{
+    int rank, size;
+    double offset=0.0, rtt_min=-1.0;
+    double t0, t1, troot;
+
+    MPI_Comm_rank (comm, &rank);
+    MPI_Comm_size (comm, &size);
+
+    if (rank == 0) {
+        for (int peer=1; peer<size; peer++) {
+            for (int i=0; i<HIP_MPITEST_CLOCK_NPINGS; i++) {
+                PMPI_Recv (&t0, 1, MPI_DOUBLE, peer, HIP_MPITEST_CLOCK_TAG, comm, MPI_STATUS_IGNORE);
+                troot = hip_mpitest_clock_now();
+                PMPI_Send (&troot, 1, MPI_DOUBLE, peer, HIP_MPITEST_CLOCK_TAG, comm);
+            }
+        }
+    }
+    else {
+        for (int i=0; i<HIP_MPITEST_CLOCK_NPINGS; i++) {
+            t0 = hip_mpitest_clock_now();
+            PMPI_Send (&t0, 1, MPI_DOUBLE, 0, HIP_MPITEST_CLOCK_TAG, comm);
+            PMPI_Recv (&troot, 1, MPI_DOUBLE, 0, HIP_MPITEST_CLOCK_TAG, comm, MPI_STATUS_IGNORE);
+            t1 = hip_mpitest_clock_now();
+            if (rtt_min < 0.0 || (t1 - t0) < rtt_min) {
+                rtt_min = t1 - t0;
+                offset  = troot - (t0 + t1) / 2.0;
+            }
+        }
+    }
+
+    return offset;
+}
+
+#endif
@@ -24,12 +24,57 @@
 #ifndef __HIP_MPITEST_DATATYPE__
 #define __HIP_MPITEST_DATATYPE__
 
+#include <stdlib.h>
+#include <vector>
+
 #include "mpi.h"
 
+#ifndef GAPSIZE
+#define GAPSIZE 32
+#endif
+
+// default block length and number of blocks of the vector, indexed,
+// subarray and darray test datatypes
+#ifdef A_WIDTH
+#define HIP_TYPE_WIDTH A_WIDTH
+#else
+#define HIP_TYPE_WIDTH 256
+#endif
+#ifndef HIP_TYPE_NBLOCKS
+#define HIP_TYPE_NBLOCKS 8
+#endif
+
+/*
+** The layout of the test datatypes can be changed at runtime with the
+** environment variables HIP_MPITEST_DDT_BLOCKLEN (number of integers per
+** block, at least 1) and HIP_MPITEST_DDT_GAP (number of integers between
+** two blocks, at least 0). If not set or out of range, the compile time
+** defaults A_WIDTH and GAPSIZE are used.
+*/
+static int hip_mpitest_datatype_param (const char *name, int defval, int minval)
+{
+    char *env = getenv(name);
+    if (NULL != env && atoi(env) >= minval) {
+        return atoi(env);
+    }
+    return defval;
+}
+
+/*
+** All test datatypes are built from MPI_INT with a lower bound of 0. An
+** implementation provides the number of integers in one instance of the
+** datatype and the offset of each of them (in units of integers) relative
+** to the start of the instance. The initialization and verification of
+** the buffers is based on these offsets: element e of instance i holds
+** rank*3+i, all integers in the gaps of the send buffer hold the rank and
+** are expected to stay -1 in the receive buffer.
+*/
 class hip_mpitest_datatype {
  protected:
     MPI_Datatype datatype;
  public:
+    virtual ~hip_mpitest_datatype() {}
+
     MPI_Datatype get_mpi_type() {
 	return datatype;
     }
@@ -44,16 +89,89 @@ class hip_mpitest_datatype {
 	return type_size;
     }
     virtual int get_num_elements()=0;
-    virtual void init_sendbuf   (void *sendbuf, int count, int mynode)=0;
-    virtual void init_recvbuf   (void *recvbuf, int count)=0;
-    virtual bool check_recvbuf  (void *recvbuf, int numprocs, int rank, int count)=0;
+    virtual MPI_Aint get_element_offset(int e)=0;
+
+    void init_sendbuf (void *sbuf, int count, int mynode)
+    {
+        int *sendbuf = (int *) sbuf;
+        MPI_Aint n = get_extent() / sizeof(int);
+        int nelems = get_num_elements();
+
+        for (MPI_Aint l=0; l<count*n; l++) {
+            sendbuf[l] = mynode;
+        }
+        for (int i=0; i<count; i++) {
+            for (int e=0; e<nelems; e++) {
+                sendbuf[i*n + get_element_offset(e)] = mynode * 3 + i;
+            }
+        }
+    }
+
+    void init_recvbuf (void *rbuf, int count)
+    {
+        int *recvbuf = (int *) rbuf;
+        MPI_Aint n = get_extent() / sizeof(int);
+
+        for (MPI_Aint l=0; l<count*n; l++) {
+            recvbuf[l] = -1;
+        }
+    }
+
+    bool check_recvbuf (void *rbuf, int numprocs, int rank, int count)
+    {
+        bool res = true;
+        int *recvbuf = (int *) rbuf;
+        MPI_Aint n = get_extent() / sizeof(int);
+        int nelems = get_num_elements();
+        int recvfrom = rank - 1;
+        if (recvfrom < 0 ) recvfrom = numprocs -1;
+
+        std::vector<bool> used(n, false);
+        for (int e=0; e<nelems; e++) {
+            used[get_element_offset(e)] = true;
+        }
+
+        for (int i=0; i<count; i++) {
+            for (MPI_Aint l=0; l<n; l++) {
+                int expected = used[l] ? (recvfrom*3)+i : -1;
+                if (recvbuf[i*n + l] != expected) {
+                    res = false;
+#ifdef VERBOSE
+                    printf("recvbuf[%ld] = %d expected %d\n", (long)(i*n + l), recvbuf[i*n + l], expected);
+#endif
+                }
+            }
+        }
+
+        return res;
+    }
 };
 
 
 #if defined (HIP_TYPE_RESIZED)
 #include "hip_type_resized.h"
+#define TEST_DATATYPE hip_type_resized
 #elif defined (HIP_TYPE_STRUCT)
 #include "hip_type_struct.h"
+#define TEST_DATATYPE hip_type_struct
+#elif defined (HIP_TYPE_VECTOR)
+#include "hip_type_vector.h"
+#define TEST_DATATYPE hip_type_vector
+#elif defined (HIP_TYPE_HVECTOR)
+#include "hip_type_hvector.h"
+#define TEST_DATATYPE hip_type_hvector
+#elif defined (HIP_TYPE_INDEXED)
+#include "hip_type_indexed.h"
+#define TEST_DATATYPE hip_type_indexed
+#elif defined (HIP_TYPE_INDEXED_BLOCK)
+#include "hip_type_indexed_block.h"
+#define TEST_DATATYPE hip_type_indexed_block
+#elif defined (HIP_TYPE_SUBARRAY)
+#include "hip_type_subarray.h"
+#define TEST_DATATYPE hip_type_subarray
+#elif defined (HIP_TYPE_DARRAY)
+#include "hip_type_darray.h"
+#define TEST_DATATYPE hip_type_darray
 #endif
 
 #endif // __HIP_MPITEST_DATATYPE__
@@ -0,0 +1,106 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#ifndef __HIP_MPITEST_DATATYPE_CATALOG__
+#define __HIP_MPITEST_DATATYPE_CATALOG__
+
+#include <string.h>
+
+#include "mpi.h"
+#include "hip_mpitest_datatype.h"
+#include "hip_type_struct.h"
+#include "hip_type_resized.h"
+#include "hip_type_vector_struct.h"
+#include "hip_type_vector.h"
+#include "hip_type_hvector.h"
+#include "hip_type_indexed.h"
+#include "hip_type_indexed_block.h"
+#include "hip_type_subarray.h"
+#include "hip_type_darray.h"
+
+/*
+** Runtime selection of the test datatypes by name. blocklen is the number
+** of integers per contiguous block and gap the number of integers between
+** two blocks. If blocklen or gap are negative, the defaults of the datatype
+** (HIP_MPITEST_DDT_BLOCKLEN, HIP_MPITEST_DDT_GAP or the compile time
+** defaults) are used.
+*/
+[[maybe_unused]] static const char *hip_mpitest_datatype_names[] = {
+    "struct",
+    "resized",
+    "vector_struct",
+    "vector",
+    "hvector",
+    "indexed",
+    "indexed_block",
+    "subarray",
+    "darray",
+    NULL
+};
+
+#define HIP_MPITEST_DATATYPE_CREATE(_name, _typename, _class, _blocklen, _gap) { \
+    if (strcmp(_name, _typename) == 0) {                                         \
+        if (_blocklen < 0 || _gap < 0) {                                         \
+            return new _class();                                                 \
+        }                                                                        \
+        return new _class(_blocklen, _gap);                                      \
+    }                                                                            \
+}
+
+static hip_mpitest_datatype* hip_mpitest_datatype_create (const char *name, int blocklen, int gap)
+{
+    HIP_MPITEST_DATATYPE_CREATE(name, "struct",        hip_type_struct,        blocklen, gap);
+    HIP_MPITEST_DATATYPE_CREATE(name, "resized",       hip_type_resized,       blocklen, gap);
+    HIP_MPITEST_DATATYPE_CREATE(name, "vector_struct", hip_type_vector_struct, blocklen, gap);
+    HIP_MPITEST_DATATYPE_CREATE(name, "vector",        hip_type_vector,        blocklen, gap);
+    HIP_MPITEST_DATATYPE_CREATE(name, "hvector",       hip_type_hvector,       blocklen, gap);
+    HIP_MPITEST_DATATYPE_CREATE(name, "indexed",       hip_type_indexed,       blocklen, gap);
+    HIP_MPITEST_DATATYPE_CREATE(name, "indexed_block", hip_type_indexed_block, blocklen, gap);
+    HIP_MPITEST_DATATYPE_CREATE(name, "subarray",      hip_type_subarray,      blocklen, gap);
+    HIP_MPITEST_DATATYPE_CREATE(name, "darray",        hip_type_darray,        blocklen, gap);
+
+    return NULL;
+}
+
+// Returns the datatype selected with HIP_MPITEST_DDT_TYPE, NULL if not set
+static inline hip_mpitest_datatype* hip_mpitest_datatype_select (MPI_Comm comm)
+{
+    char *name = getenv("HIP_MPITEST_DDT_TYPE");
+    hip_mpitest_datatype *dat;
+
+    if (NULL == name) {
+        return NULL;
+    }
+    dat = hip_mpitest_datatype_create(name, -1, -1);
+    if (NULL == dat) {
+        int rank;
+        MPI_Comm_rank (comm, &rank);
+        if (rank == 0) {
+            printf("Invalid datatype in HIP_MPITEST_DDT_TYPE: %s\n", name);
+        }
+        MPI_Abort (comm, 1);
+    }
+    return dat;
+}
+
+#endif
@@ -0,0 +1,355 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#ifndef __HIP_MPITEST_MPIT__
+#define __HIP_MPITEST_MPIT__
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <regex.h>
+
+#include "mpi.h"
+
+/*
+** Sampling of MPI_T performance variables around a benchmark region.
+**
+** The performance variables whose name matches the regular expression in
+** the environment variable HIP_MPITEST_PVARS are read when the benchmark
+** region starts (bench_mpit_begin) and when it ends (bench_mpit_end). For
+** counters, aggregates and timers the difference is reported, for all other
+** classes (levels, sizes, watermarks, ...) the value at the end of the region.
+** Variables bound to a communicator are bound to the communicator of the
+** benchmark, variables bound to other MPI objects are skipped.
+*/
+
+#define HIP_MPITEST_MPIT_MAX_PVARS 32
+#define HIP_MPITEST_MPIT_NAMELEN   128
+
+typedef struct hip_mpitest_pvar_s {
+    char               name[HIP_MPITEST_MPIT_NAMELEN];
+    int                var_class;
+    MPI_Datatype       datatype;
+    int                count;
+    bool               delta;
+    MPI_T_pvar_handle  handle;
+    double             start;
+} hip_mpitest_pvar_t;
+
+static MPI_T_pvar_session  hip_mpitest_pvar_session;
+static hip_mpitest_pvar_t  hip_mpitest_pvars[HIP_MPITEST_MPIT_MAX_PVARS];
+static int                 hip_mpitest_npvars=0;
+static bool                hip_mpitest_mpit_active=false;
+
+static inline bool bench_mpit_supported_type (MPI_Datatype datatype)
+{
+    return (datatype == MPI_INT || datatype == MPI_UNSIGNED ||
+            datatype == MPI_UNSIGNED_LONG || datatype == MPI_UNSIGNED_LONG_LONG ||
+            datatype == MPI_COUNT || datatype == MPI_DOUBLE);
+}
+
+static inline const char* bench_mpit_class_name (int var_class)
+{
+    switch (var_class) {
+    case MPI_T_PVAR_CLASS_STATE:         return "state";
+    case MPI_T_PVAR_CLASS_LEVEL:         return "level";
+    case MPI_T_PVAR_CLASS_SIZE:          return "size";
+    case MPI_T_PVAR_CLASS_PERCENTAGE:    return "percentage";
+    case MPI_T_PVAR_CLASS_HIGHWATERMARK: return "highwatermark";
+    case MPI_T_PVAR_CLASS_LOWWATERMARK:  return "lowwatermark";
+    case MPI_T_PVAR_CLASS_COUNTER:       return "counter";
+    case MPI_T_PVAR_CLASS_AGGREGATE:     return "aggregate";
+    case MPI_T_PVAR_CLASS_TIMER:         return "timer";
+    default:                             return "generic";
+    }
+}
+
+// Returns the sum of all elements of a performance variable
+static inline double bench_mpit_read (hip_mpitest_pvar_t *pvar)
+{
+    double value = 0.0;
+    void *buf;
+    int tsize;
+
+    MPI_Type_size (pvar->datatype, &tsize);
+    buf = malloc (pvar->count * tsize);
+    if (NULL == buf) {
+        return 0.0;
+    }
+    if (MPI_SUCCESS != MPI_T_pvar_read (hip_mpitest_pvar_session, pvar->handle, buf)) {
+        free (buf);
+        return 0.0;
+    }
+
+    for (int i=0; i<pvar->count; i++) {
+        if (pvar->datatype == MPI_INT) {
+            value += ((int *)buf)[i];
+        }
+        else if (pvar->datatype == MPI_UNSIGNED) {
+            value += ((unsigned *)buf)[i];
+        }
+        else if (pvar->datatype == MPI_UNSIGNED_LONG) {
+            value += ((unsigned long *)buf)[i];
+        }
+        else if (pvar->datatype == MPI_UNSIGNED_LONG_LONG) {
+            value += ((unsigned long long *)buf)[i];
+        }
+        else if (pvar->datatype == MPI_COUNT) {
+            value += ((MPI_Count *)buf)[i];
+        }
+        else {
+            value += ((double *)buf)[i];
+        }
+    }
+
+    free (buf);
+    return value;
+}
+
+/*
+** Reorders the sampled variables into the order of rank 0 and drops all
+** variables that are not available on every process, such that index i
+** refers to the same variable on all processes when the values are reduced.
+** Uses the PMPI interface to not count as traffic of the benchmark.
+*/
+static inline void bench_mpit_match (MPI_Comm comm, int rank)
+{
+    char names[HIP_MPITEST_MPIT_MAX_PVARS][HIP_MPITEST_MPIT_NAMELEN];
+    int found[HIP_MPITEST_MPIT_MAX_PVARS], present[HIP_MPITEST_MPIT_MAX_PVARS];
+    int everywhere[HIP_MPITEST_MPIT_MAX_PVARS];
+    bool keep[HIP_MPITEST_MPIT_MAX_PVARS];
+    hip_mpitest_pvar_t matched[HIP_MPITEST_MPIT_MAX_PVARS];
+    int nroot = hip_mpitest_npvars, nmatched = 0, ndropped, maxdropped;
+
+    if (rank == 0) {
+        for (int i=0; i<hip_mpitest_npvars; i++) {
+            memcpy (names[i], hip_mpitest_pvars[i].name, HIP_MPITEST_MPIT_NAMELEN);
+        }
+    }
+    PMPI_Bcast (&nroot, 1, MPI_INT, 0, comm);
+    PMPI_Bcast (names, nroot * HIP_MPITEST_MPIT_NAMELEN, MPI_CHAR, 0, comm);
+
+    for (int i=0; i<hip_mpitest_npvars; i++) {
+        keep[i] = false;
+    }
+    for (int j=0; j<nroot; j++) {
+        found[j] = -1;
+        for (int i=0; i<hip_mpitest_npvars; i++) {
+            if (!keep[i] && 0 == strcmp (names[j], hip_mpitest_pvars[i].name)) {
+                found[j] = i;
+                keep[i]  = true;
+                break;
+            }
+        }
+        present[j] = found[j] >= 0 ? 1 : 0;
+    }
+    if (nroot > 0) {
+        PMPI_Allreduce (present, everywhere, nroot, MPI_INT, MPI_MIN, comm);
+    }
+
+    for (int j=0; j<nroot; j++) {
+        if (found[j] < 0) {
+            continue;
+        }
+        if (everywhere[j]) {
+            matched[nmatched++] = hip_mpitest_pvars[found[j]];
+        }
+        else {
+            keep[found[j]] = false;
+        }
+    }
+    for (int i=0; i<hip_mpitest_npvars; i++) {
+        if (!keep[i]) {
+            MPI_T_pvar_handle_free (hip_mpitest_pvar_session, &hip_mpitest_pvars[i].handle);
+        }
+    }
+
+    ndropped = hip_mpitest_npvars - nmatched;
+    PMPI_Allreduce (&ndropped, &maxdropped, 1, MPI_INT, MPI_MAX, comm);
+    if (rank == 0 && maxdropped > 0) {
+        fprintf(stderr, "Performance variables differ between processes, "
+                "dropping variables not available on all processes\n");
+    }
+
+    for (int i=0; i<nmatched; i++) {
+        hip_mpitest_pvars[i] = matched[i];
+    }
+    hip_mpitest_npvars = nmatched;
+}
+
+static inline void bench_mpit_init (MPI_Comm comm)
+{
+    char *pattern = getenv("HIP_MPITEST_PVARS");
+    int rank, provided, num, ret, ok;
+    bool compiled, initialized = false;
+    regex_t regex;
+
+    if (NULL == pattern) {
+        return;
+    }
+
+    MPI_Comm_rank (comm, &rank);
+    compiled = 0 == regcomp (&regex, pattern, REG_EXTENDED | REG_NOSUB);
+    if (compiled) {
+        ret = MPI_T_init_thread (MPI_THREAD_SINGLE, &provided);
+        initialized = MPI_SUCCESS == ret;
+        if (!initialized) {
+            fprintf(stderr, "Could not initialize the MPI_T interface\n");
+        }
+    }
+    else if (rank == 0) {
+        fprintf(stderr, "Invalid regular expression in HIP_MPITEST_PVARS: %s\n", pattern);
+    }
+
+    // bench_mpit_match is collective, either all processes sample or none
+    ok = initialized ? 1 : 0;
+    PMPI_Allreduce (MPI_IN_PLACE, &ok, 1, MPI_INT, MPI_MIN, comm);
+    if (!ok) {
+        if (initialized) {
+            MPI_T_finalize ();
+        }
+        if (compiled) {
+            regfree (&regex);
+        }
+        if (rank == 0) {
+            fprintf(stderr, "Performance variables are not sampled\n");
+        }
+        return;
+    }
+    MPI_T_pvar_session_create (&hip_mpitest_pvar_session);
+    MPI_T_pvar_get_num (&num);
+
+    for (int i=0; i<num && hip_mpitest_npvars < HIP_MPITEST_MPIT_MAX_PVARS; i++) {
+        char name[HIP_MPITEST_MPIT_NAMELEN];
+        int namelen = HIP_MPITEST_MPIT_NAMELEN, desclen = 0;
+        int verbosity, var_class, bind, readonly, continuous, atomic;
+        MPI_Datatype datatype;
+        MPI_T_enum enumtype;
+        hip_mpitest_pvar_t *pvar = &hip_mpitest_pvars[hip_mpitest_npvars];
+
+        ret = MPI_T_pvar_get_info (i, name, &namelen, &verbosity, &var_class, &datatype,
+                                   &enumtype, NULL, &desclen, &bind, &readonly,
+                                   &continuous, &atomic);
+        if (MPI_SUCCESS != ret || 0 != regexec (&regex, name, 0, NULL, 0)) {
+            continue;
+        }
+        if (!bench_mpit_supported_type(datatype) ||
+            (bind != MPI_T_BIND_NO_OBJECT && bind != MPI_T_BIND_MPI_COMM)) {
+            continue;
+        }
+
+        ret = MPI_T_pvar_handle_alloc (hip_mpitest_pvar_session, i,
+                                       bind == MPI_T_BIND_MPI_COMM ? &comm : NULL,
+                                       &pvar->handle, &pvar->count);
+        if (MPI_SUCCESS != ret || pvar->count < 1) {
+            continue;
+        }
+        if (!continuous) {
+            ret = MPI_T_pvar_start (hip_mpitest_pvar_session, pvar->handle);
+            if (MPI_SUCCESS != ret) {
+                MPI_T_pvar_handle_free (hip_mpitest_pvar_session, &pvar->handle);
+                continue;
+            }
+        }
+
+        strncpy (pvar->name, name, HIP_MPITEST_MPIT_NAMELEN);
+        pvar->name[HIP_MPITEST_MPIT_NAMELEN-1] = '\0';
+        pvar->var_class = var_class;
+        pvar->datatype  = datatype;
+        pvar->delta     = (var_class == MPI_T_PVAR_CLASS_COUNTER   ||
+                           var_class == MPI_T_PVAR_CLASS_AGGREGATE ||
+                           var_class == MPI_T_PVAR_CLASS_TIMER);
+        pvar->start     = 0.0;
+        hip_mpitest_npvars++;
+    }
+    regfree (&regex);
+
+    // all processes have to report the same set of variables in the same order
+    bench_mpit_match (comm, rank);
+    hip_mpitest_mpit_active = true;
+
+    if (rank == 0) {
+        printf("Sampling %d performance variable(s) matching '%s':\n", hip_mpitest_npvars, pattern);
+        for (int i=0; i<hip_mpitest_npvars; i++) {
+            printf("  %-48s %-14s %s\n", hip_mpitest_pvars[i].name,
+                   bench_mpit_class_name(hip_mpitest_pvars[i].var_class),
+                   hip_mpitest_pvars[i].delta ? "(delta)" : "(value at end)");
+        }
+        printf("\n");
+    }
+}
+
+static inline void bench_mpit_begin (void)
+{
+    if (!hip_mpitest_mpit_active) {
+        return;
+    }
+    for (int i=0; i<hip_mpitest_npvars; i++) {
+        hip_mpitest_pvars[i].start = bench_mpit_read (&hip_mpitest_pvars[i]);
+    }
+}
+
+// values has to provide space for HIP_MPITEST_MPIT_MAX_PVARS elements
+static inline int bench_mpit_end (double *values)
+{
+    if (!hip_mpitest_mpit_active) {
+        return 0;
+    }
+    for (int i=0; i<hip_mpitest_npvars; i++) {
+        values[i] = bench_mpit_read (&hip_mpitest_pvars[i]);
+        if (hip_mpitest_pvars[i].delta) {
+            values[i] -= hip_mpitest_pvars[i].start;
+        }
+    }
+    return hip_mpitest_npvars;
+}
+
+/*
+** Prints the value of performance variable i as returned by bench_mpit_end
+** (or summed over processes), using a floating point format for variables
+** of type MPI_DOUBLE and an integer format for all other types.
+*/
+static inline void bench_mpit_print (int i, double value)
+{
+    if (hip_mpitest_pvars[i].datatype == MPI_DOUBLE) {
+        printf(" \t %s=%g", hip_mpitest_pvars[i].name, value);
+    }
+    else {
+        printf(" \t %s=%lld", hip_mpitest_pvars[i].name, (long long)value);
+    }
+}
+
+static inline void bench_mpit_finalize (void)
+{
+    if (!hip_mpitest_mpit_active) {
+        return;
+    }
+    for (int i=0; i<hip_mpitest_npvars; i++) {
+        MPI_T_pvar_handle_free (hip_mpitest_pvar_session, &hip_mpitest_pvars[i].handle);
+    }
+    MPI_T_pvar_session_free (&hip_mpitest_pvar_session);
+    MPI_T_finalize ();
+    hip_mpitest_mpit_active = false;
+}
+
+#endif
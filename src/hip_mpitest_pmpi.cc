@@ -0,0 +1,1237 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+/*
+** PMPI profiling layer of the testsuite.
+**
+** Every wrapped MPI function records the number of calls, the number of bytes
+** and a log2 histogram of the call latency. Statistics are kept separately for
+** each function, communicator (or window/file) and memory type of the send
+** and receive buffer. The memory type is determined by looking up the buffer
+** address in the table of buffers registered by the ALLOCATE_SENDBUFFER/
+** ALLOCATE_RECVBUFFER macros, unknown buffers are reported as '-'.
+**
+** The number of bytes is the amount of data described by the send arguments
+** of a call, or by the receive arguments for receive-only operations. For
+** non-blocking operations the latency is the time to post the operation;
+** the completion time is accounted for in the MPI_Wait/MPI_Test functions.
+**
+** The statistics of all processes are aggregated on rank 0 in MPI_Finalize
+** and printed to stdout, or to the file named by the environment variable
+** HIP_MPITEST_PMPI_OUTPUT if set. The layer is not thread safe.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libgen.h>
+#include <chrono>
+
+#include "mpi.h"
+#include "hip_mpitest_pmpi.h"
+
+#define HIP_MPITEST_PMPI_MAX_BUFFERS 64
+#define HIP_MPITEST_PMPI_MAX_ENTRIES 1024
+#define HIP_MPITEST_PMPI_NBINS       28
+#define HIP_MPITEST_PMPI_NAMELEN     32
+
+#define HIP_MPITEST_PMPI_FUNCTIONS(_F)                                      \
+    _F(MPI_Send)             _F(MPI_Ssend)            _F(MPI_Bsend)          \
+    _F(MPI_Recv)             _F(MPI_Sendrecv)         _F(MPI_Isend)          \
+    _F(MPI_Issend)           _F(MPI_Irecv)            _F(MPI_Send_init)      \
+    _F(MPI_Recv_init)        _F(MPI_Start)            _F(MPI_Startall)       \
+    _F(MPI_Wait)             _F(MPI_Waitall)          _F(MPI_Test)           \
+    _F(MPI_Testall)          _F(MPI_Barrier)          _F(MPI_Bcast)          \
+    _F(MPI_Ibcast)           _F(MPI_Reduce)           _F(MPI_Ireduce)        \
+    _F(MPI_Allreduce)        _F(MPI_Iallreduce)       _F(MPI_Reduce_local)   \
+    _F(MPI_Reduce_scatter)   _F(MPI_Reduce_scatter_block)                    \
+    _F(MPI_Scan)             _F(MPI_Exscan)           _F(MPI_Gather)         \
+    _F(MPI_Gatherv)          _F(MPI_Scatter)          _F(MPI_Scatterv)       \
+    _F(MPI_Allgather)        _F(MPI_Allgatherv)       _F(MPI_Alltoall)       \
+    _F(MPI_Alltoallv)        _F(MPI_Pack)             _F(MPI_Unpack)         \
+    _F(MPI_Put)              _F(MPI_Get)              _F(MPI_Rput)           \
+    _F(MPI_Rget)             _F(MPI_Accumulate)       _F(MPI_Raccumulate)    \
+    _F(MPI_Get_accumulate)   _F(MPI_Win_fence)        _F(MPI_Win_lock)       \
+    _F(MPI_Win_unlock)       _F(MPI_Win_lock_all)     _F(MPI_Win_unlock_all) \
+    _F(MPI_Win_flush)        _F(MPI_Win_flush_all)    _F(MPI_Win_flush_local)\
+    _F(MPI_File_open)        _F(MPI_File_close)       _F(MPI_File_write)     \
+    _F(MPI_File_write_at)    _F(MPI_File_write_all)   _F(MPI_File_iwrite)    \
+    _F(MPI_File_iwrite_at)   _F(MPI_File_iwrite_all)  _F(MPI_File_read)      \
+    _F(MPI_File_read_at)     _F(MPI_File_read_all)    _F(MPI_File_iread)     \
+    _F(MPI_File_iread_at)    _F(MPI_File_iread_all)
+
+#define HIP_MPITEST_PMPI_ENUM(_f) _f##_ID,
+#define HIP_MPITEST_PMPI_NAME(_f) #_f,
+
+enum HIP_MPITEST_PMPI_FUNC {
+    HIP_MPITEST_PMPI_FUNCTIONS(HIP_MPITEST_PMPI_ENUM)
+    HIP_MPITEST_PMPI_FUNC_LAST
+};
+
+static const char *hip_mpitest_pmpi_names[HIP_MPITEST_PMPI_FUNC_LAST] = {
+    HIP_MPITEST_PMPI_FUNCTIONS(HIP_MPITEST_PMPI_NAME)
+};
+
+enum HIP_MPITEST_PMPI_OBJ {
+    HIP_MPITEST_PMPI_OBJ_NONE=0,
+    HIP_MPITEST_PMPI_OBJ_COMM,
+    HIP_MPITEST_PMPI_OBJ_WIN,
+    HIP_MPITEST_PMPI_OBJ_FILE
+};
+
+typedef struct hip_mpitest_pmpi_buffer_s {
+    const char *addr;
+    size_t      nBytes;
+    char        memchar;
+} hip_mpitest_pmpi_buffer_t;
+
+typedef struct hip_mpitest_pmpi_stats_s {
+    int    func;
+    char   object[HIP_MPITEST_PMPI_NAMELEN];
+    char   smem;
+    char   rmem;
+    long   calls;
+    long   bytes;
+    double time;
+    double tmin;
+    double tmax;
+    long   hist[HIP_MPITEST_PMPI_NBINS];
+} hip_mpitest_pmpi_stats_t;
+
+typedef struct hip_mpitest_pmpi_key_s {
+    int      func;
+    int      objkind;
+    MPI_Fint handle;
+    char     smem;
+    char     rmem;
+} hip_mpitest_pmpi_key_t;
+
+static hip_mpitest_pmpi_buffer_t hip_mpitest_pmpi_buffers[HIP_MPITEST_PMPI_MAX_BUFFERS];
+static int                       hip_mpitest_pmpi_nbuffers=0;
+
+static hip_mpitest_pmpi_key_t    hip_mpitest_pmpi_keys[HIP_MPITEST_PMPI_MAX_ENTRIES];
+static hip_mpitest_pmpi_stats_t  hip_mpitest_pmpi_entries[HIP_MPITEST_PMPI_MAX_ENTRIES];
+static int                       hip_mpitest_pmpi_nentries=0;
+static long                      hip_mpitest_pmpi_dropped=0;
+static char                      hip_mpitest_pmpi_exec[64] = "unknown";
+
+typedef std::chrono::high_resolution_clock::time_point hip_mpitest_pmpi_time_t;
+
+#define PMPI_PROF_START hip_mpitest_pmpi_time_t _t1s = std::chrono::high_resolution_clock::now()
+
+
+/*
+** Buffer registration
+*/
+extern "C" void hip_mpitest_pmpi_register_buffer (const void *addr, size_t nBytes, char memchar)
+{
+    int i;
+
+    for (i=0; i<hip_mpitest_pmpi_nbuffers; i++) {
+        if (hip_mpitest_pmpi_buffers[i].addr == addr) {
+            break;
+        }
+    }
+    if (i == hip_mpitest_pmpi_nbuffers) {
+        if (hip_mpitest_pmpi_nbuffers == HIP_MPITEST_PMPI_MAX_BUFFERS) {
+            return;
+        }
+        hip_mpitest_pmpi_nbuffers++;
+    }
+    hip_mpitest_pmpi_buffers[i].addr    = (const char *)addr;
+    hip_mpitest_pmpi_buffers[i].nBytes  = nBytes;
+    hip_mpitest_pmpi_buffers[i].memchar = memchar;
+}
+
+extern "C" void hip_mpitest_pmpi_deregister_buffer (const void *addr)
+{
+    for (int i=0; i<hip_mpitest_pmpi_nbuffers; i++) {
+        if (hip_mpitest_pmpi_buffers[i].addr == addr) {
+            hip_mpitest_pmpi_nbuffers--;
+            hip_mpitest_pmpi_buffers[i] = hip_mpitest_pmpi_buffers[hip_mpitest_pmpi_nbuffers];
+            return;
+        }
+    }
+}
+
+static char hip_mpitest_pmpi_memtype (const void *addr)
+{
+    const char *caddr = (const char *)addr;
+
+    if (NULL == addr || MPI_IN_PLACE == addr) {
+        return '-';
+    }
+    for (int i=0; i<hip_mpitest_pmpi_nbuffers; i++) {
+        if (caddr >= hip_mpitest_pmpi_buffers[i].addr &&
+            caddr <  hip_mpitest_pmpi_buffers[i].addr + hip_mpitest_pmpi_buffers[i].nBytes) {
+            return hip_mpitest_pmpi_buffers[i].memchar;
+        }
+    }
+    return '-';
+}
+
+
+/*
+** Statistics
+*/
+static long hip_mpitest_pmpi_bytes (int count, MPI_Datatype datatype)
+{
+    int tsize;
+
+    if (count <= 0 || MPI_DATATYPE_NULL == datatype) {
+        return 0;
+    }
+    PMPI_Type_size (datatype, &tsize);
+    return (long)count * tsize;
+}
+
+static long hip_mpitest_pmpi_sum (const int *counts, MPI_Datatype datatype, MPI_Comm comm)
+{
+    int size;
+    long sum=0;
+
+    if (NULL == counts) {
+        return 0;
+    }
+    PMPI_Comm_size (comm, &size);
+    for (int i=0; i<size; i++) {
+        sum += hip_mpitest_pmpi_bytes(counts[i], datatype);
+    }
+    return sum;
+}
+
+static int hip_mpitest_pmpi_bin (double t)
+{
+    double usec = t * 1e6;
+    int bin = 0;
+
+    // bin 0: < 1us, bin k: [2^(k-1), 2^k) us
+    while (usec >= 1.0 && bin < HIP_MPITEST_PMPI_NBINS-1) {
+        usec /= 2.0;
+        bin++;
+    }
+    return bin;
+}
+
+static hip_mpitest_pmpi_stats_t* hip_mpitest_pmpi_lookup (int func, int objkind, MPI_Fint handle,
+                                                          char smem, char rmem)
+{
+    hip_mpitest_pmpi_key_t *key;
+
+    for (int i=0; i<hip_mpitest_pmpi_nentries; i++) {
+        key = &hip_mpitest_pmpi_keys[i];
+        if (key->func == func && key->objkind == objkind && key->handle == handle &&
+            key->smem == smem && key->rmem == rmem) {
+            return &hip_mpitest_pmpi_entries[i];
+        }
+    }
+    if (hip_mpitest_pmpi_nentries == HIP_MPITEST_PMPI_MAX_ENTRIES) {
+        hip_mpitest_pmpi_dropped++;
+        return NULL;
+    }
+
+    key = &hip_mpitest_pmpi_keys[hip_mpitest_pmpi_nentries];
+    key->func    = func;
+    key->objkind = objkind;
+    key->handle  = handle;
+    key->smem    = smem;
+    key->rmem    = rmem;
+
+    hip_mpitest_pmpi_stats_t *e = &hip_mpitest_pmpi_entries[hip_mpitest_pmpi_nentries++];
+    memset (e, 0, sizeof(hip_mpitest_pmpi_stats_t));
+    e->func = func;
+    e->smem = smem;
+    e->rmem = rmem;
+    strncpy (e->object, "-", HIP_MPITEST_PMPI_NAMELEN);
+    return e;
+}
+
+static void hip_mpitest_pmpi_update (hip_mpitest_pmpi_stats_t *e, long bytes, hip_mpitest_pmpi_time_t t1s)
+{
+    hip_mpitest_pmpi_time_t t1e = std::chrono::high_resolution_clock::now();
+    double t = std::chrono::duration<double>(t1e-t1s).count();
+
+    if (e->calls == 0 || t < e->tmin) {
+        e->tmin = t;
+    }
+    if (t > e->tmax) {
+        e->tmax = t;
+    }
+    e->calls++;
+    e->bytes += bytes;
+    e->time  += t;
+    e->hist[hip_mpitest_pmpi_bin(t)]++;
+}
+
+static void hip_mpitest_pmpi_record_comm (int func, MPI_Comm comm, const void *sbuf, const void *rbuf,
+                                          long bytes, hip_mpitest_pmpi_time_t t1s)
+{
+    hip_mpitest_pmpi_stats_t *e;
+
+    e = hip_mpitest_pmpi_lookup (func, HIP_MPITEST_PMPI_OBJ_COMM, PMPI_Comm_c2f(comm),
+                                 hip_mpitest_pmpi_memtype(sbuf), hip_mpitest_pmpi_memtype(rbuf));
+    if (NULL == e) {
+        return;
+    }
+    if (e->calls == 0) {
+        char name[MPI_MAX_OBJECT_NAME];
+        int len=0, size;
+
+        PMPI_Comm_get_name (comm, name, &len);
+        if (len > 0) {
+            snprintf(e->object, HIP_MPITEST_PMPI_NAMELEN, "%s", name);
+        }
+        else {
+            PMPI_Comm_size (comm, &size);
+            snprintf(e->object, HIP_MPITEST_PMPI_NAMELEN, "comm(size %d)", size);
+        }
+    }
+    hip_mpitest_pmpi_update (e, bytes, t1s);
+}
+
+static void hip_mpitest_pmpi_record_win (int func, MPI_Win win, const void *sbuf, const void *rbuf,
+                                         long bytes, hip_mpitest_pmpi_time_t t1s)
+{
+    hip_mpitest_pmpi_stats_t *e;
+
+    e = hip_mpitest_pmpi_lookup (func, HIP_MPITEST_PMPI_OBJ_WIN, PMPI_Win_c2f(win),
+                                 hip_mpitest_pmpi_memtype(sbuf), hip_mpitest_pmpi_memtype(rbuf));
+    if (NULL == e) {
+        return;
+    }
+    if (e->calls == 0) {
+        char name[MPI_MAX_OBJECT_NAME];
+        int len=0;
+
+        PMPI_Win_get_name (win, name, &len);
+        snprintf(e->object, HIP_MPITEST_PMPI_NAMELEN, "%s", len > 0 ? name : "win");
+    }
+    hip_mpitest_pmpi_update (e, bytes, t1s);
+}
+
+static void hip_mpitest_pmpi_record_file (int func, MPI_File fh, const void *sbuf, const void *rbuf,
+                                          long bytes, hip_mpitest_pmpi_time_t t1s)
+{
+    hip_mpitest_pmpi_stats_t *e;
+
+    e = hip_mpitest_pmpi_lookup (func, HIP_MPITEST_PMPI_OBJ_FILE, PMPI_File_c2f(fh),
+                                 hip_mpitest_pmpi_memtype(sbuf), hip_mpitest_pmpi_memtype(rbuf));
+    if (NULL == e) {
+        return;
+    }
+    if (e->calls == 0) {
+        strncpy (e->object, "file", HIP_MPITEST_PMPI_NAMELEN);
+    }
+    hip_mpitest_pmpi_update (e, bytes, t1s);
+}
+
+static void hip_mpitest_pmpi_record_none (int func, const void *sbuf, const void *rbuf,
+                                          long bytes, hip_mpitest_pmpi_time_t t1s)
+{
+    hip_mpitest_pmpi_stats_t *e;
+
+    e = hip_mpitest_pmpi_lookup (func, HIP_MPITEST_PMPI_OBJ_NONE, 0,
+                                 hip_mpitest_pmpi_memtype(sbuf), hip_mpitest_pmpi_memtype(rbuf));
+    if (NULL == e) {
+        return;
+    }
+    hip_mpitest_pmpi_update (e, bytes, t1s);
+}
+
+
+/*
+** Aggregation and output
+*/
+static int hip_mpitest_pmpi_compare (const void *a, const void *b)
+{
+    const hip_mpitest_pmpi_stats_t *ea = (const hip_mpitest_pmpi_stats_t *)a;
+    const hip_mpitest_pmpi_stats_t *eb = (const hip_mpitest_pmpi_stats_t *)b;
+    int ret;
+
+    if (ea->func != eb->func) {
+        return ea->func - eb->func;
+    }
+    ret = strncmp (ea->object, eb->object, HIP_MPITEST_PMPI_NAMELEN);
+    if (ret != 0) {
+        return ret;
+    }
+    if (ea->smem != eb->smem) {
+        return ea->smem - eb->smem;
+    }
+    return ea->rmem - eb->rmem;
+}
+
+static void hip_mpitest_pmpi_print (FILE *out, hip_mpitest_pmpi_stats_t *all, int nall, int size)
+{
+    fprintf(out, "\nPMPI profile of %s - %d processes (aggregated over all processes)\n\n",
+            hip_mpitest_pmpi_exec, size);
+    fprintf(out, "%-26s %-20s S R %10s %14s %12s %10s %10s %10s\n", "Function", "Object",
+            "calls", "bytes", "total(s)", "avg(us)", "min(us)", "max(us)");
+    fprintf(out, "========================================================================"
+            "==================================================\n");
+
+    for (int i=0; i<nall; i++) {
+        hip_mpitest_pmpi_stats_t *e = &all[i];
+        fprintf(out, "%-26s %-20.20s %c %c %10ld %14ld %12.6lf %10.3lf %10.3lf %10.3lf\n",
+                hip_mpitest_pmpi_names[e->func], e->object, e->smem, e->rmem, e->calls,
+                e->bytes, e->time, e->time*1e6/e->calls, e->tmin*1e6, e->tmax*1e6);
+
+        fprintf(out, "    latency histogram (us):");
+        for (int b=0; b<HIP_MPITEST_PMPI_NBINS; b++) {
+            if (e->hist[b] == 0) {
+                continue;
+            }
+            if (b == 0) {
+                fprintf(out, " [<1]:%ld", e->hist[b]);
+            }
+            else {
+                fprintf(out, " [%ld-%ld]:%ld", 1L<<(b-1), 1L<<b, e->hist[b]);
+            }
+        }
+        fprintf(out, "\n");
+    }
+}
+
+static void hip_mpitest_pmpi_report (void)
+{
+    int rank, size, nall=0, nmerged=0;
+    int *counts=NULL, *displs=NULL;
+    hip_mpitest_pmpi_stats_t *all=NULL;
+    int esize = sizeof(hip_mpitest_pmpi_stats_t);
+    int nlocal = hip_mpitest_pmpi_nentries;
+    long dropped = 0;
+
+    PMPI_Comm_rank (MPI_COMM_WORLD, &rank);
+    PMPI_Comm_size (MPI_COMM_WORLD, &size);
+
+    if (rank == 0) {
+        counts = (int *) malloc (size * sizeof(int));
+        displs = (int *) malloc (size * sizeof(int));
+        if (NULL == counts || NULL == displs) {
+            fprintf(stderr, "PMPI profile: Could not allocate memory\n");
+            nlocal = 0;
+        }
+    }
+    PMPI_Reduce (&hip_mpitest_pmpi_dropped, &dropped, 1, MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    PMPI_Gather (&nlocal, 1, MPI_INT, counts, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (rank == 0 && NULL != counts && NULL != displs) {
+        for (int i=0; i<size; i++) {
+            displs[i] = nall * esize;
+            nall     += counts[i];
+            counts[i] *= esize;
+        }
+        all = (hip_mpitest_pmpi_stats_t *) malloc ((nall > 0 ? nall : 1) * esize);
+        if (NULL == all) {
+            fprintf(stderr, "PMPI profile: Could not allocate memory\n");
+            PMPI_Abort (MPI_COMM_WORLD, 1);
+        }
+    }
+    PMPI_Gatherv (hip_mpitest_pmpi_entries, nlocal*esize, MPI_BYTE, all, counts, displs,
+                  MPI_BYTE, 0, MPI_COMM_WORLD);
+
+    if (rank == 0 && NULL != all) {
+        // merge the entries of all processes, in-place
+        qsort (all, nall, esize, hip_mpitest_pmpi_compare);
+        for (int i=0; i<nall; i++) {
+            if (nmerged > 0 && hip_mpitest_pmpi_compare(&all[nmerged-1], &all[i]) == 0) {
+                hip_mpitest_pmpi_stats_t *m = &all[nmerged-1];
+                if (all[i].tmin < m->tmin) m->tmin = all[i].tmin;
+                if (all[i].tmax > m->tmax) m->tmax = all[i].tmax;
+                m->calls += all[i].calls;
+                m->bytes += all[i].bytes;
+                m->time  += all[i].time;
+                for (int b=0; b<HIP_MPITEST_PMPI_NBINS; b++) {
+                    m->hist[b] += all[i].hist[b];
+                }
+            }
+            else {
+                all[nmerged++] = all[i];
+            }
+        }
+
+        FILE *out = stdout;
+        char *fname = getenv("HIP_MPITEST_PMPI_OUTPUT");
+        if (NULL != fname) {
+            out = fopen (fname, "w");
+            if (NULL == out) {
+                fprintf(stderr, "PMPI profile: Could not open %s, using stdout\n", fname);
+                out = stdout;
+            }
+        }
+        hip_mpitest_pmpi_print (out, all, nmerged, size);
+        if (dropped > 0) {
+            fprintf(out, "Warning: %ld calls not recorded, increase HIP_MPITEST_PMPI_MAX_ENTRIES\n",
+                    dropped);
+        }
+        if (out != stdout) {
+            fclose (out);
+        }
+        else {
+            fflush (out);
+        }
+    }
+
+    free (counts);
+    free (displs);
+    free (all);
+}
+
+static void hip_mpitest_pmpi_set_exec (int *argc, char ***argv)
+{
+    if (NULL != argc && NULL != argv && *argc > 0 && NULL != (*argv)[0]) {
+        char tmp[256];
+        snprintf(tmp, sizeof(tmp), "%s", (*argv)[0]);
+        snprintf(hip_mpitest_pmpi_exec, sizeof(hip_mpitest_pmpi_exec), "%s", basename(tmp));
+    }
+}
+
+
+/*
+** Initialization and finalization
+*/
+int MPI_Init (int *argc, char ***argv)
+{
+    hip_mpitest_pmpi_set_exec (argc, argv);
+    return PMPI_Init (argc, argv);
+}
+
+int MPI_Init_thread (int *argc, char ***argv, int required, int *provided)
+{
+    hip_mpitest_pmpi_set_exec (argc, argv);
+    return PMPI_Init_thread (argc, argv, required, provided);
+}
+
+int MPI_Finalize (void)
+{
+    int initialized=0;
+
+    PMPI_Initialized (&initialized);
+    if (initialized) {
+        hip_mpitest_pmpi_report ();
+    }
+    return PMPI_Finalize ();
+}
+
+
+/*
+** Point-to-point communication
+*/
+int MPI_Send (const void *buf, int count, MPI_Datatype datatype, int dest, int tag, MPI_Comm comm)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Send (buf, count, datatype, dest, tag, comm);
+    hip_mpitest_pmpi_record_comm (MPI_Send_ID, comm, buf, NULL,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_Ssend (const void *buf, int count, MPI_Datatype datatype, int dest, int tag, MPI_Comm comm)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Ssend (buf, count, datatype, dest, tag, comm);
+    hip_mpitest_pmpi_record_comm (MPI_Ssend_ID, comm, buf, NULL,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_Bsend (const void *buf, int count, MPI_Datatype datatype, int dest, int tag, MPI_Comm comm)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Bsend (buf, count, datatype, dest, tag, comm);
+    hip_mpitest_pmpi_record_comm (MPI_Bsend_ID, comm, buf, NULL,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_Recv (void *buf, int count, MPI_Datatype datatype, int source, int tag, MPI_Comm comm,
+              MPI_Status *status)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Recv (buf, count, datatype, source, tag, comm, status);
+    hip_mpitest_pmpi_record_comm (MPI_Recv_ID, comm, NULL, buf,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_Sendrecv (const void *sendbuf, int sendcount, MPI_Datatype sendtype, int dest, int sendtag,
+                  void *recvbuf, int recvcount, MPI_Datatype recvtype, int source, int recvtag,
+                  MPI_Comm comm, MPI_Status *status)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Sendrecv (sendbuf, sendcount, sendtype, dest, sendtag, recvbuf, recvcount,
+                             recvtype, source, recvtag, comm, status);
+    hip_mpitest_pmpi_record_comm (MPI_Sendrecv_ID, comm, sendbuf, recvbuf,
+                                  hip_mpitest_pmpi_bytes(sendcount, sendtype), _t1s);
+    return ret;
+}
+
+int MPI_Isend (const void *buf, int count, MPI_Datatype datatype, int dest, int tag, MPI_Comm comm,
+               MPI_Request *request)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Isend (buf, count, datatype, dest, tag, comm, request);
+    hip_mpitest_pmpi_record_comm (MPI_Isend_ID, comm, buf, NULL,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_Issend (const void *buf, int count, MPI_Datatype datatype, int dest, int tag, MPI_Comm comm,
+                MPI_Request *request)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Issend (buf, count, datatype, dest, tag, comm, request);
+    hip_mpitest_pmpi_record_comm (MPI_Issend_ID, comm, buf, NULL,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_Irecv (void *buf, int count, MPI_Datatype datatype, int source, int tag, MPI_Comm comm,
+               MPI_Request *request)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Irecv (buf, count, datatype, source, tag, comm, request);
+    hip_mpitest_pmpi_record_comm (MPI_Irecv_ID, comm, NULL, buf,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_Send_init (const void *buf, int count, MPI_Datatype datatype, int dest, int tag,
+                   MPI_Comm comm, MPI_Request *request)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Send_init (buf, count, datatype, dest, tag, comm, request);
+    hip_mpitest_pmpi_record_comm (MPI_Send_init_ID, comm, buf, NULL,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_Recv_init (void *buf, int count, MPI_Datatype datatype, int source, int tag,
+                   MPI_Comm comm, MPI_Request *request)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Recv_init (buf, count, datatype, source, tag, comm, request);
+    hip_mpitest_pmpi_record_comm (MPI_Recv_init_ID, comm, NULL, buf,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_Start (MPI_Request *request)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Start (request);
+    hip_mpitest_pmpi_record_none (MPI_Start_ID, NULL, NULL, 0, _t1s);
+    return ret;
+}
+
+int MPI_Startall (int count, MPI_Request array_of_requests[])
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Startall (count, array_of_requests);
+    hip_mpitest_pmpi_record_none (MPI_Startall_ID, NULL, NULL, 0, _t1s);
+    return ret;
+}
+
+int MPI_Wait (MPI_Request *request, MPI_Status *status)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Wait (request, status);
+    hip_mpitest_pmpi_record_none (MPI_Wait_ID, NULL, NULL, 0, _t1s);
+    return ret;
+}
+
+int MPI_Waitall (int count, MPI_Request array_of_requests[], MPI_Status array_of_statuses[])
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Waitall (count, array_of_requests, array_of_statuses);
+    hip_mpitest_pmpi_record_none (MPI_Waitall_ID, NULL, NULL, 0, _t1s);
+    return ret;
+}
+
+int MPI_Test (MPI_Request *request, int *flag, MPI_Status *status)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Test (request, flag, status);
+    hip_mpitest_pmpi_record_none (MPI_Test_ID, NULL, NULL, 0, _t1s);
+    return ret;
+}
+
+int MPI_Testall (int count, MPI_Request array_of_requests[], int *flag,
+                 MPI_Status array_of_statuses[])
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Testall (count, array_of_requests, flag, array_of_statuses);
+    hip_mpitest_pmpi_record_none (MPI_Testall_ID, NULL, NULL, 0, _t1s);
+    return ret;
+}
+
+
+/*
+** Collective communication
+*/
+int MPI_Barrier (MPI_Comm comm)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Barrier (comm);
+    hip_mpitest_pmpi_record_comm (MPI_Barrier_ID, comm, NULL, NULL, 0, _t1s);
+    return ret;
+}
+
+int MPI_Bcast (void *buffer, int count, MPI_Datatype datatype, int root, MPI_Comm comm)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Bcast (buffer, count, datatype, root, comm);
+    hip_mpitest_pmpi_record_comm (MPI_Bcast_ID, comm, buffer, NULL,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_Ibcast (void *buffer, int count, MPI_Datatype datatype, int root, MPI_Comm comm,
+                MPI_Request *request)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Ibcast (buffer, count, datatype, root, comm, request);
+    hip_mpitest_pmpi_record_comm (MPI_Ibcast_ID, comm, buffer, NULL,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_Reduce (const void *sendbuf, void *recvbuf, int count, MPI_Datatype datatype, MPI_Op op,
+                int root, MPI_Comm comm)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Reduce (sendbuf, recvbuf, count, datatype, op, root, comm);
+    hip_mpitest_pmpi_record_comm (MPI_Reduce_ID, comm, sendbuf, recvbuf,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_Ireduce (const void *sendbuf, void *recvbuf, int count, MPI_Datatype datatype, MPI_Op op,
+                 int root, MPI_Comm comm, MPI_Request *request)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Ireduce (sendbuf, recvbuf, count, datatype, op, root, comm, request);
+    hip_mpitest_pmpi_record_comm (MPI_Ireduce_ID, comm, sendbuf, recvbuf,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_Allreduce (const void *sendbuf, void *recvbuf, int count, MPI_Datatype datatype, MPI_Op op,
+                   MPI_Comm comm)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Allreduce (sendbuf, recvbuf, count, datatype, op, comm);
+    hip_mpitest_pmpi_record_comm (MPI_Allreduce_ID, comm, sendbuf, recvbuf,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_Iallreduce (const void *sendbuf, void *recvbuf, int count, MPI_Datatype datatype, MPI_Op op,
+                    MPI_Comm comm, MPI_Request *request)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Iallreduce (sendbuf, recvbuf, count, datatype, op, comm, request);
+    hip_mpitest_pmpi_record_comm (MPI_Iallreduce_ID, comm, sendbuf, recvbuf,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_Reduce_local (const void *inbuf, void *inoutbuf, int count, MPI_Datatype datatype, MPI_Op op)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Reduce_local (inbuf, inoutbuf, count, datatype, op);
+    hip_mpitest_pmpi_record_none (MPI_Reduce_local_ID, inbuf, inoutbuf,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_Reduce_scatter (const void *sendbuf, void *recvbuf, const int recvcounts[],
+                        MPI_Datatype datatype, MPI_Op op, MPI_Comm comm)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Reduce_scatter (sendbuf, recvbuf, recvcounts, datatype, op, comm);
+    hip_mpitest_pmpi_record_comm (MPI_Reduce_scatter_ID, comm, sendbuf, recvbuf,
+                                  hip_mpitest_pmpi_sum(recvcounts, datatype, comm), _t1s);
+    return ret;
+}
+
+int MPI_Reduce_scatter_block (const void *sendbuf, void *recvbuf, int recvcount,
+                              MPI_Datatype datatype, MPI_Op op, MPI_Comm comm)
+{
+    int size;
+    PMPI_Comm_size (comm, &size);
+
+    PMPI_PROF_START;
+    int ret = PMPI_Reduce_scatter_block (sendbuf, recvbuf, recvcount, datatype, op, comm);
+    hip_mpitest_pmpi_record_comm (MPI_Reduce_scatter_block_ID, comm, sendbuf, recvbuf,
+                                  hip_mpitest_pmpi_bytes(recvcount, datatype) * size, _t1s);
+    return ret;
+}
+
+int MPI_Scan (const void *sendbuf, void *recvbuf, int count, MPI_Datatype datatype, MPI_Op op,
+              MPI_Comm comm)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Scan (sendbuf, recvbuf, count, datatype, op, comm);
+    hip_mpitest_pmpi_record_comm (MPI_Scan_ID, comm, sendbuf, recvbuf,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_Exscan (const void *sendbuf, void *recvbuf, int count, MPI_Datatype datatype, MPI_Op op,
+                MPI_Comm comm)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Exscan (sendbuf, recvbuf, count, datatype, op, comm);
+    hip_mpitest_pmpi_record_comm (MPI_Exscan_ID, comm, sendbuf, recvbuf,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_Gather (const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf,
+                int recvcount, MPI_Datatype recvtype, int root, MPI_Comm comm)
+{
+    long bytes = MPI_IN_PLACE == sendbuf ? hip_mpitest_pmpi_bytes(recvcount, recvtype) :
+                                           hip_mpitest_pmpi_bytes(sendcount, sendtype);
+    PMPI_PROF_START;
+    int ret = PMPI_Gather (sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, root, comm);
+    hip_mpitest_pmpi_record_comm (MPI_Gather_ID, comm, sendbuf, recvbuf, bytes, _t1s);
+    return ret;
+}
+
+int MPI_Gatherv (const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf,
+                 const int recvcounts[], const int displs[], MPI_Datatype recvtype, int root,
+                 MPI_Comm comm)
+{
+    long bytes = MPI_IN_PLACE == sendbuf ? 0 : hip_mpitest_pmpi_bytes(sendcount, sendtype);
+    PMPI_PROF_START;
+    int ret = PMPI_Gatherv (sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs, recvtype,
+                            root, comm);
+    hip_mpitest_pmpi_record_comm (MPI_Gatherv_ID, comm, sendbuf, recvbuf, bytes, _t1s);
+    return ret;
+}
+
+int MPI_Scatter (const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf,
+                 int recvcount, MPI_Datatype recvtype, int root, MPI_Comm comm)
+{
+    int rank, size;
+    long bytes;
+
+    PMPI_Comm_rank (comm, &rank);
+    PMPI_Comm_size (comm, &size);
+    bytes = rank == root ? hip_mpitest_pmpi_bytes(sendcount, sendtype) * size :
+                           hip_mpitest_pmpi_bytes(recvcount, recvtype);
+    PMPI_PROF_START;
+    int ret = PMPI_Scatter (sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, root, comm);
+    hip_mpitest_pmpi_record_comm (MPI_Scatter_ID, comm, sendbuf, recvbuf, bytes, _t1s);
+    return ret;
+}
+
+int MPI_Scatterv (const void *sendbuf, const int sendcounts[], const int displs[],
+                  MPI_Datatype sendtype, void *recvbuf, int recvcount, MPI_Datatype recvtype,
+                  int root, MPI_Comm comm)
+{
+    int rank;
+    long bytes;
+
+    PMPI_Comm_rank (comm, &rank);
+    bytes = rank == root ? hip_mpitest_pmpi_sum(sendcounts, sendtype, comm) :
+                           hip_mpitest_pmpi_bytes(recvcount, recvtype);
+    PMPI_PROF_START;
+    int ret = PMPI_Scatterv (sendbuf, sendcounts, displs, sendtype, recvbuf, recvcount, recvtype,
+                             root, comm);
+    hip_mpitest_pmpi_record_comm (MPI_Scatterv_ID, comm, sendbuf, recvbuf, bytes, _t1s);
+    return ret;
+}
+
+int MPI_Allgather (const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf,
+                   int recvcount, MPI_Datatype recvtype, MPI_Comm comm)
+{
+    long bytes = MPI_IN_PLACE == sendbuf ? hip_mpitest_pmpi_bytes(recvcount, recvtype) :
+                                           hip_mpitest_pmpi_bytes(sendcount, sendtype);
+    PMPI_PROF_START;
+    int ret = PMPI_Allgather (sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm);
+    hip_mpitest_pmpi_record_comm (MPI_Allgather_ID, comm, sendbuf, recvbuf, bytes, _t1s);
+    return ret;
+}
+
+int MPI_Allgatherv (const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf,
+                    const int recvcounts[], const int displs[], MPI_Datatype recvtype,
+                    MPI_Comm comm)
+{
+    int rank;
+    long bytes;
+
+    PMPI_Comm_rank (comm, &rank);
+    bytes = MPI_IN_PLACE == sendbuf ? hip_mpitest_pmpi_bytes(recvcounts[rank], recvtype) :
+                                      hip_mpitest_pmpi_bytes(sendcount, sendtype);
+    PMPI_PROF_START;
+    int ret = PMPI_Allgatherv (sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs,
+                               recvtype, comm);
+    hip_mpitest_pmpi_record_comm (MPI_Allgatherv_ID, comm, sendbuf, recvbuf, bytes, _t1s);
+    return ret;
+}
+
+int MPI_Alltoall (const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf,
+                  int recvcount, MPI_Datatype recvtype, MPI_Comm comm)
+{
+    int size;
+    long bytes;
+
+    PMPI_Comm_size (comm, &size);
+    bytes = MPI_IN_PLACE == sendbuf ? hip_mpitest_pmpi_bytes(recvcount, recvtype) * size :
+                                      hip_mpitest_pmpi_bytes(sendcount, sendtype) * size;
+    PMPI_PROF_START;
+    int ret = PMPI_Alltoall (sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm);
+    hip_mpitest_pmpi_record_comm (MPI_Alltoall_ID, comm, sendbuf, recvbuf, bytes, _t1s);
+    return ret;
+}
+
+int MPI_Alltoallv (const void *sendbuf, const int sendcounts[], const int sdispls[],
+                   MPI_Datatype sendtype, void *recvbuf, const int recvcounts[],
+                   const int rdispls[], MPI_Datatype recvtype, MPI_Comm comm)
+{
+    long bytes = MPI_IN_PLACE == sendbuf ? hip_mpitest_pmpi_sum(recvcounts, recvtype, comm) :
+                                           hip_mpitest_pmpi_sum(sendcounts, sendtype, comm);
+    PMPI_PROF_START;
+    int ret = PMPI_Alltoallv (sendbuf, sendcounts, sdispls, sendtype, recvbuf, recvcounts,
+                              rdispls, recvtype, comm);
+    hip_mpitest_pmpi_record_comm (MPI_Alltoallv_ID, comm, sendbuf, recvbuf, bytes, _t1s);
+    return ret;
+}
+
+
+/*
+** Datatype packing
+*/
+int MPI_Pack (const void *inbuf, int incount, MPI_Datatype datatype, void *outbuf, int outsize,
+              int *position, MPI_Comm comm)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Pack (inbuf, incount, datatype, outbuf, outsize, position, comm);
+    hip_mpitest_pmpi_record_comm (MPI_Pack_ID, comm, inbuf, outbuf,
+                                  hip_mpitest_pmpi_bytes(incount, datatype), _t1s);
+    return ret;
+}
+
+int MPI_Unpack (const void *inbuf, int insize, int *position, void *outbuf, int outcount,
+                MPI_Datatype datatype, MPI_Comm comm)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Unpack (inbuf, insize, position, outbuf, outcount, datatype, comm);
+    hip_mpitest_pmpi_record_comm (MPI_Unpack_ID, comm, inbuf, outbuf,
+                                  hip_mpitest_pmpi_bytes(outcount, datatype), _t1s);
+    return ret;
+}
+
+
+/*
+** One-sided communication
+*/
+int MPI_Put (const void *origin_addr, int origin_count, MPI_Datatype origin_datatype,
+             int target_rank, MPI_Aint target_disp, int target_count,
+             MPI_Datatype target_datatype, MPI_Win win)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Put (origin_addr, origin_count, origin_datatype, target_rank, target_disp,
+                        target_count, target_datatype, win);
+    hip_mpitest_pmpi_record_win (MPI_Put_ID, win, origin_addr, NULL,
+                                 hip_mpitest_pmpi_bytes(origin_count, origin_datatype), _t1s);
+    return ret;
+}
+
+int MPI_Get (void *origin_addr, int origin_count, MPI_Datatype origin_datatype,
+             int target_rank, MPI_Aint target_disp, int target_count,
+             MPI_Datatype target_datatype, MPI_Win win)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Get (origin_addr, origin_count, origin_datatype, target_rank, target_disp,
+                        target_count, target_datatype, win);
+    hip_mpitest_pmpi_record_win (MPI_Get_ID, win, NULL, origin_addr,
+                                 hip_mpitest_pmpi_bytes(origin_count, origin_datatype), _t1s);
+    return ret;
+}
+
+int MPI_Rput (const void *origin_addr, int origin_count, MPI_Datatype origin_datatype,
+              int target_rank, MPI_Aint target_disp, int target_count,
+              MPI_Datatype target_datatype, MPI_Win win, MPI_Request *request)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Rput (origin_addr, origin_count, origin_datatype, target_rank, target_disp,
+                         target_count, target_datatype, win, request);
+    hip_mpitest_pmpi_record_win (MPI_Rput_ID, win, origin_addr, NULL,
+                                 hip_mpitest_pmpi_bytes(origin_count, origin_datatype), _t1s);
+    return ret;
+}
+
+int MPI_Rget (void *origin_addr, int origin_count, MPI_Datatype origin_datatype,
+              int target_rank, MPI_Aint target_disp, int target_count,
+              MPI_Datatype target_datatype, MPI_Win win, MPI_Request *request)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Rget (origin_addr, origin_count, origin_datatype, target_rank, target_disp,
+                         target_count, target_datatype, win, request);
+    hip_mpitest_pmpi_record_win (MPI_Rget_ID, win, NULL, origin_addr,
+                                 hip_mpitest_pmpi_bytes(origin_count, origin_datatype), _t1s);
+    return ret;
+}
+
+int MPI_Accumulate (const void *origin_addr, int origin_count, MPI_Datatype origin_datatype,
+                    int target_rank, MPI_Aint target_disp, int target_count,
+                    MPI_Datatype target_datatype, MPI_Op op, MPI_Win win)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Accumulate (origin_addr, origin_count, origin_datatype, target_rank,
+                               target_disp, target_count, target_datatype, op, win);
+    hip_mpitest_pmpi_record_win (MPI_Accumulate_ID, win, origin_addr, NULL,
+                                 hip_mpitest_pmpi_bytes(origin_count, origin_datatype), _t1s);
+    return ret;
+}
+
+int MPI_Raccumulate (const void *origin_addr, int origin_count, MPI_Datatype origin_datatype,
+                     int target_rank, MPI_Aint target_disp, int target_count,
+                     MPI_Datatype target_datatype, MPI_Op op, MPI_Win win, MPI_Request *request)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Raccumulate (origin_addr, origin_count, origin_datatype, target_rank,
+                                target_disp, target_count, target_datatype, op, win, request);
+    hip_mpitest_pmpi_record_win (MPI_Raccumulate_ID, win, origin_addr, NULL,
+                                 hip_mpitest_pmpi_bytes(origin_count, origin_datatype), _t1s);
+    return ret;
+}
+
+int MPI_Get_accumulate (const void *origin_addr, int origin_count, MPI_Datatype origin_datatype,
+                        void *result_addr, int result_count, MPI_Datatype result_datatype,
+                        int target_rank, MPI_Aint target_disp, int target_count,
+                        MPI_Datatype target_datatype, MPI_Op op, MPI_Win win)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Get_accumulate (origin_addr, origin_count, origin_datatype, result_addr,
+                                   result_count, result_datatype, target_rank, target_disp,
+                                   target_count, target_datatype, op, win);
+    hip_mpitest_pmpi_record_win (MPI_Get_accumulate_ID, win, origin_addr, result_addr,
+                                 hip_mpitest_pmpi_bytes(result_count, result_datatype), _t1s);
+    return ret;
+}
+
+int MPI_Win_fence (int assert, MPI_Win win)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Win_fence (assert, win);
+    hip_mpitest_pmpi_record_win (MPI_Win_fence_ID, win, NULL, NULL, 0, _t1s);
+    return ret;
+}
+
+int MPI_Win_lock (int lock_type, int rank, int assert, MPI_Win win)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Win_lock (lock_type, rank, assert, win);
+    hip_mpitest_pmpi_record_win (MPI_Win_lock_ID, win, NULL, NULL, 0, _t1s);
+    return ret;
+}
+
+int MPI_Win_unlock (int rank, MPI_Win win)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Win_unlock (rank, win);
+    hip_mpitest_pmpi_record_win (MPI_Win_unlock_ID, win, NULL, NULL, 0, _t1s);
+    return ret;
+}
+
+int MPI_Win_lock_all (int assert, MPI_Win win)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Win_lock_all (assert, win);
+    hip_mpitest_pmpi_record_win (MPI_Win_lock_all_ID, win, NULL, NULL, 0, _t1s);
+    return ret;
+}
+
+int MPI_Win_unlock_all (MPI_Win win)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Win_unlock_all (win);
+    hip_mpitest_pmpi_record_win (MPI_Win_unlock_all_ID, win, NULL, NULL, 0, _t1s);
+    return ret;
+}
+
+int MPI_Win_flush (int rank, MPI_Win win)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Win_flush (rank, win);
+    hip_mpitest_pmpi_record_win (MPI_Win_flush_ID, win, NULL, NULL, 0, _t1s);
+    return ret;
+}
+
+int MPI_Win_flush_all (MPI_Win win)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Win_flush_all (win);
+    hip_mpitest_pmpi_record_win (MPI_Win_flush_all_ID, win, NULL, NULL, 0, _t1s);
+    return ret;
+}
+
+int MPI_Win_flush_local (int rank, MPI_Win win)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_Win_flush_local (rank, win);
+    hip_mpitest_pmpi_record_win (MPI_Win_flush_local_ID, win, NULL, NULL, 0, _t1s);
+    return ret;
+}
+
+
+/*
+** File I/O
+*/
+int MPI_File_open (MPI_Comm comm, const char *filename, int amode, MPI_Info info, MPI_File *fh)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_File_open (comm, filename, amode, info, fh);
+    hip_mpitest_pmpi_record_comm (MPI_File_open_ID, comm, NULL, NULL, 0, _t1s);
+    return ret;
+}
+
+int MPI_File_close (MPI_File *fh)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_File_close (fh);
+    hip_mpitest_pmpi_record_none (MPI_File_close_ID, NULL, NULL, 0, _t1s);
+    return ret;
+}
+
+int MPI_File_write (MPI_File fh, const void *buf, int count, MPI_Datatype datatype,
+                    MPI_Status *status)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_File_write (fh, buf, count, datatype, status);
+    hip_mpitest_pmpi_record_file (MPI_File_write_ID, fh, buf, NULL,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_File_write_at (MPI_File fh, MPI_Offset offset, const void *buf, int count,
+                       MPI_Datatype datatype, MPI_Status *status)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_File_write_at (fh, offset, buf, count, datatype, status);
+    hip_mpitest_pmpi_record_file (MPI_File_write_at_ID, fh, buf, NULL,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_File_write_all (MPI_File fh, const void *buf, int count, MPI_Datatype datatype,
+                        MPI_Status *status)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_File_write_all (fh, buf, count, datatype, status);
+    hip_mpitest_pmpi_record_file (MPI_File_write_all_ID, fh, buf, NULL,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_File_iwrite (MPI_File fh, const void *buf, int count, MPI_Datatype datatype,
+                     MPI_Request *request)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_File_iwrite (fh, buf, count, datatype, request);
+    hip_mpitest_pmpi_record_file (MPI_File_iwrite_ID, fh, buf, NULL,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_File_iwrite_at (MPI_File fh, MPI_Offset offset, const void *buf, int count,
+                        MPI_Datatype datatype, MPI_Request *request)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_File_iwrite_at (fh, offset, buf, count, datatype, request);
+    hip_mpitest_pmpi_record_file (MPI_File_iwrite_at_ID, fh, buf, NULL,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_File_iwrite_all (MPI_File fh, const void *buf, int count, MPI_Datatype datatype,
+                         MPI_Request *request)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_File_iwrite_all (fh, buf, count, datatype, request);
+    hip_mpitest_pmpi_record_file (MPI_File_iwrite_all_ID, fh, buf, NULL,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_File_read (MPI_File fh, void *buf, int count, MPI_Datatype datatype, MPI_Status *status)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_File_read (fh, buf, count, datatype, status);
+    hip_mpitest_pmpi_record_file (MPI_File_read_ID, fh, NULL, buf,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_File_read_at (MPI_File fh, MPI_Offset offset, void *buf, int count, MPI_Datatype datatype,
+                      MPI_Status *status)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_File_read_at (fh, offset, buf, count, datatype, status);
+    hip_mpitest_pmpi_record_file (MPI_File_read_at_ID, fh, NULL, buf,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_File_read_all (MPI_File fh, void *buf, int count, MPI_Datatype datatype,
+                       MPI_Status *status)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_File_read_all (fh, buf, count, datatype, status);
+    hip_mpitest_pmpi_record_file (MPI_File_read_all_ID, fh, NULL, buf,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_File_iread (MPI_File fh, void *buf, int count, MPI_Datatype datatype,
+                    MPI_Request *request)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_File_iread (fh, buf, count, datatype, request);
+    hip_mpitest_pmpi_record_file (MPI_File_iread_ID, fh, NULL, buf,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_File_iread_at (MPI_File fh, MPI_Offset offset, void *buf, int count,
+                       MPI_Datatype datatype, MPI_Request *request)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_File_iread_at (fh, offset, buf, count, datatype, request);
+    hip_mpitest_pmpi_record_file (MPI_File_iread_at_ID, fh, NULL, buf,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
+
+int MPI_File_iread_all (MPI_File fh, void *buf, int count, MPI_Datatype datatype,
+                        MPI_Request *request)
+{
+    PMPI_PROF_START;
+    int ret = PMPI_File_iread_all (fh, buf, count, datatype, request);
+    hip_mpitest_pmpi_record_file (MPI_File_iread_all_ID, fh, NULL, buf,
+                                  hip_mpitest_pmpi_bytes(count, datatype), _t1s);
+    return ret;
+}
@@ -0,0 +1,50 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#ifndef __HIP_MPITEST_PMPI__
+#define __HIP_MPITEST_PMPI__
+
+#include <stddef.h>
+#include "hip_mpitest_config.h"
+
+/*
+** Interface between the test buffers and the optional PMPI profiling
+** library (libhip_mpitest_pmpi.a, enabled with --enable-pmpi-profiling).
+** The buffer macros register every allocation together with its memory
+** type character, which allows the profiling layer to attribute each MPI
+** call to the memory types of the buffers it was invoked with.
+*/
+#if HIP_MPITEST_PMPI_PROFILE
+extern "C" void hip_mpitest_pmpi_register_buffer   (const void *addr, size_t nBytes, char memchar);
+extern "C" void hip_mpitest_pmpi_deregister_buffer (const void *addr);
+
+#define HIP_MPITEST_PMPI_REGISTER(_buf, _nBytes) \
+    hip_mpitest_pmpi_register_buffer((_buf)->get_buffer(), (_nBytes), (_buf)->get_memchar())
+#define HIP_MPITEST_PMPI_DEREGISTER(_buf) \
+    hip_mpitest_pmpi_deregister_buffer((_buf)->get_buffer())
+#else
+#define HIP_MPITEST_PMPI_REGISTER(_buf, _nBytes)
+#define HIP_MPITEST_PMPI_DEREGISTER(_buf)
+#endif
+
+#endif // __HIP_MPITEST_PMPI__
@@ -0,0 +1,322 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#ifndef __HIP_MPITEST_RAWIO__
+#define __HIP_MPITEST_RAWIO__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+
+#include "hip_mpitest_config.h"
+
+#if HIP_MPITEST_LIBURING
+#include <liburing.h>
+#else
+#include <aio.h>
+#endif
+
+/*
+** Raw local file I/O reference path.
+**
+** A contiguous host buffer is written to or read from a file with O_DIRECT,
+** i.e. bypassing the page cache, in blocks of HIP_MPITEST_RAWIO_BLOCK bytes
+** (default 1 MiB, a k or m suffix is accepted) through aligned bounce buffers.
+** Up to HIP_MPITEST_RAWIO_DEPTH blocks (default 8) are in flight, submitted
+** through io_uring if configure found liburing, through POSIX AIO otherwise.
+** The part of the transfer that does not fill an aligned block, and the whole
+** transfer if the offset is not aligned, the file system does not support
+** O_DIRECT or HIP_MPITEST_RAWIO_DIRECT=0 is set, go through the page cache.
+** Writes end with fdatasync.
+*/
+
+#define HIP_MPITEST_RAWIO_ALIGN 4096
+
+typedef struct hip_mpitest_rawio_s {
+    int     fd;
+    int     depth;
+    bool    write;
+    char   *buf;
+    off_t   offset;
+    size_t  block;
+    char   *bounce;
+    long   *slot_block;   // block in flight in a slot, -1 if the slot is free
+    size_t *slot_len;
+#if HIP_MPITEST_LIBURING
+    struct io_uring ring;
+#else
+    struct aiocb   *cbs;
+#endif
+} hip_mpitest_rawio_t;
+
+static inline const char* hip_mpitest_rawio_engine (void)
+{
+    return HIP_MPITEST_LIBURING ? "io_uring" : "posix_aio";
+}
+
+static int hip_mpitest_rawio_depth (void)
+{
+    char *env = getenv("HIP_MPITEST_RAWIO_DEPTH");
+
+    return (NULL != env && atoi(env) > 0) ? atoi(env) : 8;
+}
+
+static size_t hip_mpitest_rawio_block (void)
+{
+    char *env = getenv("HIP_MPITEST_RAWIO_BLOCK");
+    char *end;
+    size_t block;
+
+    if (NULL == env) {
+        return 1024 * 1024;
+    }
+    block = strtoul (env, &end, 10);
+    if (*end == 'k' || *end == 'K') {
+        block *= 1024;
+    }
+    else if (*end == 'm' || *end == 'M') {
+        block *= 1024 * 1024;
+    }
+    // multiple of the alignment required by O_DIRECT
+    block = (block + HIP_MPITEST_RAWIO_ALIGN - 1) / HIP_MPITEST_RAWIO_ALIGN * HIP_MPITEST_RAWIO_ALIGN;
+    return block > 0 ? block : HIP_MPITEST_RAWIO_ALIGN;
+}
+
+// Transfers len bytes at offset with blocking pread/pwrite calls
+static int hip_mpitest_rawio_sync (int fd, char *buf, size_t len, off_t offset, bool write)
+{
+    while (len > 0) {
+        ssize_t a = write ? pwrite (fd, buf, len, offset) : pread (fd, buf, len, offset);
+
+        if (a == -1 && (errno == EINTR || errno == EAGAIN)) {
+            continue;
+        }
+        if (a <= 0) {
+            fprintf(stderr, "hip_mpitest_rawio: error while %s file %d: %s\n",
+                    write ? "writing to" : "reading from", fd, a == 0 ? "end of file" : strerror(errno));
+            return -1;
+        }
+        len    -= a;
+        buf    += a;
+        offset += a;
+    }
+    return 0;
+}
+
+static int hip_mpitest_rawio_submit (hip_mpitest_rawio_t *io, int slot, long b, size_t len)
+{
+    char  *bounce = io->bounce + (size_t)slot * io->block;
+    off_t  offset = io->offset + (off_t)b * io->block;
+    int    ret;
+
+    if (io->write) {
+        memcpy (bounce, io->buf + (size_t)b * io->block, len);
+    }
+    io->slot_block[slot] = b;
+    io->slot_len[slot]   = len;
+
+#if HIP_MPITEST_LIBURING
+    struct io_uring_sqe *sqe = io_uring_get_sqe (&io->ring);
+    if (NULL == sqe) {
+        io->slot_block[slot] = -1;
+        return -1;
+    }
+    if (io->write) {
+        io_uring_prep_write (sqe, io->fd, bounce, len, offset);
+    }
+    else {
+        io_uring_prep_read (sqe, io->fd, bounce, len, offset);
+    }
+    io_uring_sqe_set_data (sqe, (void *)(uintptr_t)slot);
+    ret = io_uring_submit (&io->ring) == 1 ? 0 : -1;
+#else
+    struct aiocb *cb = &io->cbs[slot];
+    memset (cb, 0, sizeof(struct aiocb));
+    cb->aio_fildes = io->fd;
+    cb->aio_buf    = bounce;
+    cb->aio_nbytes = len;
+    cb->aio_offset = offset;
+    ret = io->write ? aio_write (cb) : aio_read (cb);
+#endif
+    if (0 != ret) {
+        fprintf(stderr, "hip_mpitest_rawio: error while submitting to file %d\n", io->fd);
+        io->slot_block[slot] = -1;
+    }
+    return ret;
+}
+
+// Completes requests until the slot is free
+static int hip_mpitest_rawio_complete (hip_mpitest_rawio_t *io, int slot)
+{
+    while (io->slot_block[slot] >= 0) {
+        int done, err;
+        ssize_t res;
+
+#if HIP_MPITEST_LIBURING
+        struct io_uring_cqe *cqe;
+        if (0 != io_uring_wait_cqe (&io->ring, &cqe)) {
+            return -1;
+        }
+        done = (int)(uintptr_t)io_uring_cqe_get_data (cqe);
+        res  = cqe->res;
+        err  = -cqe->res;
+        io_uring_cqe_seen (&io->ring, cqe);
+#else
+        const struct aiocb *list[1] = {&io->cbs[slot]};
+        // aio_error returns the error of the operation, errno is not set
+        while (EINPROGRESS == (err = aio_error (&io->cbs[slot]))) {
+            aio_suspend (list, 1, NULL);
+        }
+        done = slot;
+        res  = aio_return (&io->cbs[slot]);
+#endif
+        if (res != (ssize_t)io->slot_len[done]) {
+            fprintf(stderr, "hip_mpitest_rawio: error while %s file %d: %s\n",
+                    io->write ? "writing to" : "reading from", io->fd,
+                    res < 0 ? strerror(err) : "short transfer");
+            // the request is reaped, do not wait for it again when draining
+            io->slot_block[done] = -1;
+            return -1;
+        }
+        if (!io->write) {
+            memcpy (io->buf + (size_t)io->slot_block[done] * io->block,
+                    io->bounce + (size_t)done * io->block, io->slot_len[done]);
+        }
+        io->slot_block[done] = -1;
+    }
+    return 0;
+}
+
+static int hip_mpitest_rawio (const char *fname, void *buf, size_t nbytes, off_t offset, bool write)
+{
+    hip_mpitest_rawio_t io;
+    char *env = getenv("HIP_MPITEST_RAWIO_DIRECT");
+    int flags = write ? O_CREAT|O_WRONLY : O_RDONLY;
+    int ret = -1, fd;
+    size_t ndirect = 0;
+    long nblocks;
+
+    memset (&io, 0, sizeof(io));
+    io.fd     = -1;
+    io.depth  = hip_mpitest_rawio_depth();
+    io.block  = hip_mpitest_rawio_block();
+    io.write  = write;
+    io.buf    = (char *)buf;
+    io.offset = offset;
+
+    fd = open (fname, flags, 0666);
+    if (-1 == fd) {
+        fprintf(stderr, "hip_mpitest_rawio: cannot open %s: %s\n", fname, strerror(errno));
+        return -1;
+    }
+    if ((NULL == env || atoi(env) != 0) && 0 == offset % HIP_MPITEST_RAWIO_ALIGN) {
+        io.fd = open (fname, flags | O_DIRECT, 0666);
+        if (-1 != io.fd) {
+            ndirect = nbytes / HIP_MPITEST_RAWIO_ALIGN * HIP_MPITEST_RAWIO_ALIGN;
+        }
+    }
+    nblocks = (ndirect + io.block - 1) / io.block;
+
+    if (nblocks > 0) {
+        io.bounce     = (char *) aligned_alloc (HIP_MPITEST_RAWIO_ALIGN, (size_t)io.depth * io.block);
+        io.slot_block = (long *) malloc (io.depth * sizeof(long));
+        io.slot_len   = (size_t *) malloc (io.depth * sizeof(size_t));
+        if (NULL == io.bounce || NULL == io.slot_block || NULL == io.slot_len) {
+            goto out;
+        }
+        for (int s=0; s<io.depth; s++) {
+            io.slot_block[s] = -1;
+        }
+#if HIP_MPITEST_LIBURING
+        if (0 != io_uring_queue_init (io.depth, &io.ring, 0)) {
+            goto out;
+        }
+#else
+        io.cbs = (struct aiocb *) calloc (io.depth, sizeof(struct aiocb));
+        if (NULL == io.cbs) {
+            goto out;
+        }
+#endif
+
+        ret = 0;
+        for (long b=0; b<nblocks; b++) {
+            int slot = (int)(b % io.depth);
+            size_t len = ndirect - (size_t)b * io.block < io.block ? ndirect - (size_t)b * io.block : io.block;
+
+            if (0 != hip_mpitest_rawio_complete (&io, slot) ||
+                0 != hip_mpitest_rawio_submit (&io, slot, b, len)) {
+                ret = -1;
+                break;
+            }
+        }
+        // drain the queue, also after an error
+        for (int s=0; s<io.depth; s++) {
+            if (0 != hip_mpitest_rawio_complete (&io, s)) {
+                ret = -1;
+            }
+        }
+#if HIP_MPITEST_LIBURING
+        io_uring_queue_exit (&io.ring);
+#endif
+        if (0 != ret) {
+            goto out;
+        }
+    }
+
+    // remainder through the page cache
+    ret = hip_mpitest_rawio_sync (fd, io.buf + ndirect, nbytes - ndirect, offset + ndirect, write);
+    if (0 == ret && write) {
+        ret = fdatasync (fd);
+    }
+
+ out:
+#if !HIP_MPITEST_LIBURING
+    free (io.cbs);
+#endif
+    free (io.bounce);
+    free (io.slot_block);
+    free (io.slot_len);
+    if (-1 != io.fd) {
+        close (io.fd);
+    }
+    close (fd);
+
+    return ret;
+}
+
+static inline int hip_mpitest_rawio_write (const char *fname, const void *buf, size_t nbytes, off_t offset)
+{
+    return hip_mpitest_rawio (fname, (void *)buf, nbytes, offset, true);
+}
+
+static inline int hip_mpitest_rawio_read (const char *fname, void *buf, size_t nbytes, off_t offset)
+{
+    return hip_mpitest_rawio (fname, buf, nbytes, offset, false);
+}
+
+#endif
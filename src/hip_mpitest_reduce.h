@@ -0,0 +1,601 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#ifndef __HIP_MPITEST_REDUCE__
+#define __HIP_MPITEST_REDUCE__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <complex>
+
+#include "mpi.h"
+
+/*
+** Element types and operations of the reduction tests and benchmarks,
+** selected with the --dtype and --op command line options.
+**
+**   dtype: int8, int16, int32, int64, float, double, complex (double complex),
+**          bfloat16, float16
+**   op:    sum, prod, max, min, maxloc, band, user (a user-defined sum)
+**
+** bfloat16 and float16 use the MPIX_BFLOAT16 and MPIX_C_FLOAT16 datatypes if
+** provided by the MPI library. Otherwise they are sent as two bytes and all
+** operations are implemented as user-defined operations that compute in float.
+** maxloc uses the pair types MPI_SHORT_INT, MPI_2INT, MPI_LONG_INT,
+** MPI_FLOAT_INT and MPI_DOUBLE_INT and is only available for int16, int32,
+** int64, float and double.
+**
+** The input values are chosen such that the result is exact for every
+** element type and reduction order: small integers for sum, max and min,
+** +1/-1 for prod and integers with a single bit cleared for band. bfloat16
+** and float16 represent integers exactly only up to 256 and 2048, for sum
+** only the first 32 and 256 processes contribute non-zero values to keep
+** all partial sums exact.
+*/
+#define HIP_MPITEST_OP_SUM    0
+#define HIP_MPITEST_OP_PROD   1
+#define HIP_MPITEST_OP_MAX    2
+#define HIP_MPITEST_OP_MIN    3
+#define HIP_MPITEST_OP_MAXLOC 4
+#define HIP_MPITEST_OP_BAND   5
+#define HIP_MPITEST_OP_USER   6
+
+static const char *hip_mpitest_op_names[] = {"sum", "prod", "max", "min", "maxloc", "band", "user", NULL};
+[[maybe_unused]] static const char *hip_mpitest_dtype_names[] = {"int8", "int16", "int32", "int64", "float", "double",
+                                                "complex", "bfloat16", "float16", NULL};
+
+// Returns the code of an operation or -1 if unknown
+static int hip_mpitest_op_lookup (const char *opname)
+{
+    for (int i=0; hip_mpitest_op_names[i] != NULL; i++) {
+        if (strcmp(opname, hip_mpitest_op_names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// the receive buffer of MPI_Reduce_local is initialized with the values of this rank
+#define HIP_MPITEST_REDUCE_LOCAL_RANK 1
+
+typedef struct { uint16_t bits; } hip_mpitest_bfloat16;
+typedef struct { uint16_t bits; } hip_mpitest_float16;
+
+static float hip_mpitest_bfloat16_to_float (uint16_t b)
+{
+    uint32_t u = (uint32_t)b << 16;
+    float f;
+    memcpy (&f, &u, sizeof(f));
+    return f;
+}
+
+static uint16_t hip_mpitest_float_to_bfloat16 (float f)
+{
+    uint32_t u;
+    memcpy (&u, &f, sizeof(u));
+    // round to nearest even
+    u += 0x7fff + ((u >> 16) & 1);
+    return (uint16_t)(u >> 16);
+}
+
+static float hip_mpitest_float16_to_float (uint16_t h)
+{
+    uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    int      exp  = (h >> 10) & 0x1f;
+    uint32_t mant = h & 0x3ff;
+    uint32_t u;
+    float f;
+
+    if (exp == 0 && mant == 0) {
+        u = sign;
+    }
+    else if (exp == 0) {
+        // subnormal, normalize the mantissa
+        exp = 1;
+        while (!(mant & 0x400)) {
+            mant <<= 1;
+            exp--;
+        }
+        u = sign | ((uint32_t)(exp + 112) << 23) | ((mant & 0x3ff) << 13);
+    }
+    else if (exp == 31) {
+        u = sign | 0x7f800000 | (mant << 13);
+    }
+    else {
+        u = sign | ((uint32_t)(exp + 112) << 23) | (mant << 13);
+    }
+    memcpy (&f, &u, sizeof(f));
+    return f;
+}
+
+static uint16_t hip_mpitest_float_to_float16 (float f)
+{
+    uint32_t u, h, rem, half;
+    memcpy (&u, &f, sizeof(u));
+    uint16_t sign = (u >> 16) & 0x8000;
+    int      exp  = (int)((u >> 23) & 0xff) - 127 + 15;
+    uint32_t mant = u & 0x7fffff;
+
+    if (((u >> 23) & 0xff) == 0xff) {
+        return sign | 0x7c00 | (mant ? 0x200 : 0);
+    }
+    if (exp >= 31) {
+        return sign | 0x7c00;
+    }
+    if (exp <= 0) {
+        // subnormal or zero
+        if (exp < -10) {
+            return sign;
+        }
+        mant |= 0x800000;
+        int shift = 14 - exp;
+        h    = mant >> shift;
+        rem  = mant & ((1u << shift) - 1);
+        half = 1u << (shift - 1);
+    }
+    else {
+        h    = ((uint32_t)exp << 10) | (mant >> 13);
+        rem  = mant & 0x1fff;
+        half = 0x1000;
+    }
+    // round to nearest even, a carry into the exponent is intended
+    if (rem > half || (rem == half && (h & 1))) {
+        h++;
+    }
+    return sign | (uint16_t)h;
+}
+
+// Conversion between the element type and the type used to compute the expected results
+// exact_sum_ranks is the number of processes contributing to a sum, see above
+template <typename T> struct hip_mpitest_reduce_traits {
+    typedef T compute_type;
+    static const int exact_sum_ranks = INT32_MAX;
+    static compute_type get (T x) { return x; }
+    static T set (compute_type v) { return v; }
+};
+
+// integers are computed in 64 bit and truncated after each step like in the library
+#define HIP_MPITEST_REDUCE_INT_TRAITS(_type)                                    \
+template <> struct hip_mpitest_reduce_traits<_type> {                           \
+    typedef int64_t compute_type;                                               \
+    static const int exact_sum_ranks = INT32_MAX;                               \
+    static compute_type get (_type x) { return x; }                             \
+    static _type set (compute_type v) { return (_type)v; }                      \
+};
+HIP_MPITEST_REDUCE_INT_TRAITS(int8_t)
+HIP_MPITEST_REDUCE_INT_TRAITS(int16_t)
+HIP_MPITEST_REDUCE_INT_TRAITS(int32_t)
+
+template <> struct hip_mpitest_reduce_traits<hip_mpitest_bfloat16> {
+    typedef float compute_type;
+    static const int exact_sum_ranks = 32;
+    static compute_type get (hip_mpitest_bfloat16 x) { return hip_mpitest_bfloat16_to_float(x.bits); }
+    static hip_mpitest_bfloat16 set (compute_type v) {
+        hip_mpitest_bfloat16 x = {hip_mpitest_float_to_bfloat16(v)};
+        return x;
+    }
+};
+
+template <> struct hip_mpitest_reduce_traits<hip_mpitest_float16> {
+    typedef float compute_type;
+    static const int exact_sum_ranks = 256;
+    static compute_type get (hip_mpitest_float16 x) { return hip_mpitest_float16_to_float(x.bits); }
+    static hip_mpitest_float16 set (compute_type v) {
+        hip_mpitest_float16 x = {hip_mpitest_float_to_float16(v)};
+        return x;
+    }
+};
+
+// max, min and band are not defined for all compute types, the combinations
+// are rejected in hip_mpitest_reduction_create
+template <typename C> static C hip_mpitest_reduce_max (C a, C b) { return a > b ? a : b; }
+template <typename C> static C hip_mpitest_reduce_min (C a, C b) { return a < b ? a : b; }
+template <typename C> static C hip_mpitest_reduce_band (C a, C b) { return a; }
+static std::complex<double> hip_mpitest_reduce_max (std::complex<double> a, std::complex<double> b) { return a; }
+static std::complex<double> hip_mpitest_reduce_min (std::complex<double> a, std::complex<double> b) { return a; }
+static int64_t hip_mpitest_reduce_band (int64_t a, int64_t b) { return a & b; }
+
+template <typename C> static C hip_mpitest_reduce_apply (int op, C a, C b)
+{
+    switch (op) {
+    case HIP_MPITEST_OP_PROD:
+        return a * b;
+    case HIP_MPITEST_OP_MAX:
+        return hip_mpitest_reduce_max(a, b);
+    case HIP_MPITEST_OP_MIN:
+        return hip_mpitest_reduce_min(a, b);
+    case HIP_MPITEST_OP_BAND:
+        return hip_mpitest_reduce_band(a, b);
+    default:
+        return a + b;
+    }
+}
+
+template <typename C> static C hip_mpitest_reduce_value (int op, int rank, int i)
+{
+    switch (op) {
+    case HIP_MPITEST_OP_PROD:
+        return C(((rank + i) % 2) ? -1 : 1);
+    case HIP_MPITEST_OP_MAX:
+    case HIP_MPITEST_OP_MIN:
+    case HIP_MPITEST_OP_MAXLOC:
+        return C(((rank * 7 + i) % 101) - 50);
+    case HIP_MPITEST_OP_BAND:
+        return C(~((int64_t)1 << ((rank + i) % 7)));
+    default:
+        return C((rank + i) % 8);
+    }
+}
+
+// Host reduction loop, written such that the compiler can vectorize it for the native types
+template <typename T, int OP> static void hip_mpitest_reduce_host_loop (const T * __restrict__ in,
+                                                                        T * __restrict__ inout, int count)
+{
+    typedef hip_mpitest_reduce_traits<T> traits;
+
+    for (int i=0; i<count; i++) {
+        inout[i] = traits::set(hip_mpitest_reduce_apply(OP, traits::get(in[i]), traits::get(inout[i])));
+    }
+}
+
+template <typename T, int OP> static void hip_mpitest_reduce_user_fn (void *invec, void *inoutvec, int *len,
+                                                                       MPI_Datatype *datatype)
+{
+    hip_mpitest_reduce_host_loop<T, OP> ((const T *) invec, (T *) inoutvec, *len);
+}
+
+class hip_mpitest_reduction {
+ protected:
+    MPI_Datatype datatype;
+    MPI_Op       mpi_op;
+    int          op;
+    bool         free_type;
+    bool         free_op;
+    char         name[64];
+ public:
+    hip_mpitest_reduction() : free_type(false), free_op(false) {}
+    virtual ~hip_mpitest_reduction() {
+        if (free_type) {
+            MPI_Type_free (&datatype);
+        }
+        if (free_op) {
+            MPI_Op_free (&mpi_op);
+        }
+    }
+
+    MPI_Datatype get_mpi_type() {
+        return datatype;
+    }
+    MPI_Op get_mpi_op() {
+        return mpi_op;
+    }
+    const char *get_name() {
+        return name;
+    }
+    int get_op() {
+        return op;
+    }
+    virtual size_t get_extent()=0;
+    virtual void init_sendbuf (void *sbuf, int count, int rank)=0;
+    virtual void init_recvbuf (void *rbuf, int count)=0;
+    // result of the reduction over nprocs processes
+    virtual bool check_recvbuf (void *rbuf, int nprocs, int rank, int count)=0;
+    // result of MPI_Reduce_local with the buffers initialized by init_sendbuf and init_recvbuf
+    virtual bool check_reduce_local (void *rbuf, int rank, int count)=0;
+    // reference implementation of the reduction on host memory
+    virtual void reduce_host (const void *in, void *inout, int count)=0;
+};
+
+template <typename T> class hip_mpitest_reduction_t: public hip_mpitest_reduction {
+    typedef hip_mpitest_reduce_traits<T> traits;
+    typedef typename traits::compute_type C;
+
+    C value (int rank, int i) {
+        if ((op == HIP_MPITEST_OP_SUM || op == HIP_MPITEST_OP_USER) && rank >= traits::exact_sum_ranks) {
+            return C(0);
+        }
+        return hip_mpitest_reduce_value<C>(op, rank, i);
+    }
+
+    bool check (T *recvbuf, int count, int rank, int nprocs, bool local) {
+        bool res = true;
+        for (int i=0; i<count; i++) {
+            C expected;
+            if (local) {
+                expected = traits::get(traits::set(hip_mpitest_reduce_apply(op, value(rank, i),
+                                  value(HIP_MPITEST_REDUCE_LOCAL_RANK, i))));
+            }
+            else {
+                T acc = traits::set(value(0, i));
+                for (int r=1; r<nprocs; r++) {
+                    acc = traits::set(hip_mpitest_reduce_apply(op, traits::get(acc), value(r, i)));
+                }
+                expected = traits::get(acc);
+            }
+            if (traits::get(recvbuf[i]) != expected) {
+                res = false;
+#ifdef VERBOSE
+                printf("[%d] recvbuf[%d] differs from the expected result\n", rank, i);
+#endif
+            }
+        }
+        return res;
+    }
+
+ public:
+    hip_mpitest_reduction_t (const char *dtype, MPI_Datatype _datatype, int _op, bool user) {
+        MPI_User_function *fn;
+
+        op = _op;
+        snprintf(name, sizeof(name), "%s %s", dtype, hip_mpitest_op_names[op]);
+        if (_datatype == MPI_DATATYPE_NULL) {
+            MPI_Type_contiguous (sizeof(T), MPI_BYTE, &datatype);
+            MPI_Type_commit (&datatype);
+            free_type = true;
+        }
+        else {
+            datatype = _datatype;
+        }
+
+        if (!user && op != HIP_MPITEST_OP_USER) {
+            MPI_Op ops[] = {MPI_SUM, MPI_PROD, MPI_MAX, MPI_MIN, MPI_MAXLOC, MPI_BAND};
+            mpi_op = ops[op];
+            return;
+        }
+        switch (op) {
+        case HIP_MPITEST_OP_PROD: fn = hip_mpitest_reduce_user_fn<T, HIP_MPITEST_OP_PROD>; break;
+        case HIP_MPITEST_OP_MAX:  fn = hip_mpitest_reduce_user_fn<T, HIP_MPITEST_OP_MAX>;  break;
+        case HIP_MPITEST_OP_MIN:  fn = hip_mpitest_reduce_user_fn<T, HIP_MPITEST_OP_MIN>;  break;
+        default:                  fn = hip_mpitest_reduce_user_fn<T, HIP_MPITEST_OP_SUM>;  break;
+        }
+        MPI_Op_create (fn, 1, &mpi_op);
+        free_op = true;
+    }
+
+    size_t get_extent() {
+        return sizeof(T);
+    }
+
+    void init_sendbuf (void *sbuf, int count, int rank) {
+        T *sendbuf = (T *) sbuf;
+        for (int i=0; i<count; i++) {
+            sendbuf[i] = traits::set(value(rank, i));
+        }
+    }
+
+    void init_recvbuf (void *rbuf, int count) {
+        T *recvbuf = (T *) rbuf;
+        for (int i=0; i<count; i++) {
+            recvbuf[i] = traits::set(value(HIP_MPITEST_REDUCE_LOCAL_RANK, i));
+        }
+    }
+
+    bool check_recvbuf (void *rbuf, int nprocs, int rank, int count) {
+        return check ((T *) rbuf, count, rank, nprocs, false);
+    }
+
+    bool check_reduce_local (void *rbuf, int rank, int count) {
+        return check ((T *) rbuf, count, rank, 0, true);
+    }
+
+    void reduce_host (const void *in, void *inout, int count) {
+        switch (op) {
+        case HIP_MPITEST_OP_PROD:
+            hip_mpitest_reduce_host_loop<T, HIP_MPITEST_OP_PROD> ((const T *) in, (T *) inout, count);
+            break;
+        case HIP_MPITEST_OP_MAX:
+            hip_mpitest_reduce_host_loop<T, HIP_MPITEST_OP_MAX> ((const T *) in, (T *) inout, count);
+            break;
+        case HIP_MPITEST_OP_MIN:
+            hip_mpitest_reduce_host_loop<T, HIP_MPITEST_OP_MIN> ((const T *) in, (T *) inout, count);
+            break;
+        case HIP_MPITEST_OP_BAND:
+            hip_mpitest_reduce_host_loop<T, HIP_MPITEST_OP_BAND> ((const T *) in, (T *) inout, count);
+            break;
+        default:
+            hip_mpitest_reduce_host_loop<T, HIP_MPITEST_OP_SUM> ((const T *) in, (T *) inout, count);
+            break;
+        }
+    }
+};
+
+// value and location pairs of MPI_MAXLOC, the location is the rank
+template <typename V> class hip_mpitest_reduction_maxloc: public hip_mpitest_reduction {
+    typedef struct { V val; int loc; } pair;
+
+    void expected_pair (int i, int r, V *val, int *loc) {
+        V v = hip_mpitest_reduce_value<V>(op, r, i);
+        if (v > *val || (v == *val && r < *loc)) {
+            *val = v;
+            *loc = r;
+        }
+    }
+
+    bool compare (pair *recvbuf, int i, V val, int loc, int rank) {
+        if (recvbuf[i].val != val || recvbuf[i].loc != loc) {
+#ifdef VERBOSE
+            printf("[%d] recvbuf[%d] = (%lf, %d) expected (%lf, %d)\n", rank, i,
+                   (double)recvbuf[i].val, recvbuf[i].loc, (double)val, loc);
+#endif
+            return false;
+        }
+        return true;
+    }
+
+ public:
+    hip_mpitest_reduction_maxloc (const char *dtype, MPI_Datatype pairtype) {
+        op       = HIP_MPITEST_OP_MAXLOC;
+        datatype = pairtype;
+        mpi_op   = MPI_MAXLOC;
+        snprintf(name, sizeof(name), "%s %s", dtype, hip_mpitest_op_names[op]);
+    }
+
+    size_t get_extent() {
+        return sizeof(pair);
+    }
+
+    void init_sendbuf (void *sbuf, int count, int rank) {
+        pair *sendbuf = (pair *) sbuf;
+        for (int i=0; i<count; i++) {
+            sendbuf[i].val = hip_mpitest_reduce_value<V>(op, rank, i);
+            sendbuf[i].loc = rank;
+        }
+    }
+
+    void init_recvbuf (void *rbuf, int count) {
+        pair *recvbuf = (pair *) rbuf;
+        for (int i=0; i<count; i++) {
+            recvbuf[i].val = hip_mpitest_reduce_value<V>(op, HIP_MPITEST_REDUCE_LOCAL_RANK, i);
+            recvbuf[i].loc = HIP_MPITEST_REDUCE_LOCAL_RANK;
+        }
+    }
+
+    bool check_recvbuf (void *rbuf, int nprocs, int rank, int count) {
+        bool res = true;
+        for (int i=0; i<count; i++) {
+            V val = hip_mpitest_reduce_value<V>(op, 0, i);
+            int loc = 0;
+            for (int r=1; r<nprocs; r++) {
+                expected_pair (i, r, &val, &loc);
+            }
+            res = compare ((pair *) rbuf, i, val, loc, rank) && res;
+        }
+        return res;
+    }
+
+    bool check_reduce_local (void *rbuf, int rank, int count) {
+        bool res = true;
+        for (int i=0; i<count; i++) {
+            V val = hip_mpitest_reduce_value<V>(op, HIP_MPITEST_REDUCE_LOCAL_RANK, i);
+            int loc = HIP_MPITEST_REDUCE_LOCAL_RANK;
+            expected_pair (i, rank, &val, &loc);
+            res = compare ((pair *) rbuf, i, val, loc, rank) && res;
+        }
+        return res;
+    }
+
+    void reduce_host (const void *in, void *inout, int count) {
+        const pair * __restrict__ a = (const pair *) in;
+        pair * __restrict__ b = (pair *) inout;
+
+        for (int i=0; i<count; i++) {
+            if (a[i].val > b[i].val || (a[i].val == b[i].val && a[i].loc < b[i].loc)) {
+                b[i] = a[i];
+            }
+        }
+    }
+};
+
+// Returns NULL for unknown element types or operations and invalid combinations
+static hip_mpitest_reduction* hip_mpitest_reduction_create (const char *dtype, const char *opname)
+{
+    int op = hip_mpitest_op_lookup(opname);
+
+    if (op < 0) {
+        return NULL;
+    }
+
+    if (op == HIP_MPITEST_OP_MAXLOC) {
+        if (strcmp(dtype, "int16") == 0) {
+            return new hip_mpitest_reduction_maxloc<short>(dtype, MPI_SHORT_INT);
+        }
+        else if (strcmp(dtype, "int32") == 0) {
+            return new hip_mpitest_reduction_maxloc<int>(dtype, MPI_2INT);
+        }
+        else if (strcmp(dtype, "int64") == 0 && sizeof(long) == sizeof(int64_t)) {
+            return new hip_mpitest_reduction_maxloc<long>(dtype, MPI_LONG_INT);
+        }
+        else if (strcmp(dtype, "float") == 0) {
+            return new hip_mpitest_reduction_maxloc<float>(dtype, MPI_FLOAT_INT);
+        }
+        else if (strcmp(dtype, "double") == 0) {
+            return new hip_mpitest_reduction_maxloc<double>(dtype, MPI_DOUBLE_INT);
+        }
+        return NULL;
+    }
+
+    if (strcmp(dtype, "int8") == 0) {
+        return new hip_mpitest_reduction_t<int8_t>(dtype, MPI_INT8_T, op, false);
+    }
+    else if (strcmp(dtype, "int16") == 0) {
+        return new hip_mpitest_reduction_t<int16_t>(dtype, MPI_INT16_T, op, false);
+    }
+    else if (strcmp(dtype, "int32") == 0) {
+        return new hip_mpitest_reduction_t<int32_t>(dtype, MPI_INT32_T, op, false);
+    }
+    else if (strcmp(dtype, "int64") == 0) {
+        return new hip_mpitest_reduction_t<int64_t>(dtype, MPI_INT64_T, op, false);
+    }
+
+    // bitwise operations are only defined for integers
+    if (op == HIP_MPITEST_OP_BAND) {
+        return NULL;
+    }
+    if (strcmp(dtype, "float") == 0) {
+        return new hip_mpitest_reduction_t<float>(dtype, MPI_FLOAT, op, false);
+    }
+    else if (strcmp(dtype, "double") == 0) {
+        return new hip_mpitest_reduction_t<double>(dtype, MPI_DOUBLE, op, false);
+    }
+    else if (strcmp(dtype, "complex") == 0) {
+        if (op == HIP_MPITEST_OP_MAX || op == HIP_MPITEST_OP_MIN) {
+            return NULL;
+        }
+        return new hip_mpitest_reduction_t<std::complex<double> >(dtype, MPI_C_DOUBLE_COMPLEX, op, false);
+    }
+    else if (strcmp(dtype, "bfloat16") == 0) {
+#ifdef MPIX_BFLOAT16
+        return new hip_mpitest_reduction_t<hip_mpitest_bfloat16>(dtype, MPIX_BFLOAT16, op, false);
+#else
+        return new hip_mpitest_reduction_t<hip_mpitest_bfloat16>(dtype, MPI_DATATYPE_NULL, op, true);
+#endif
+    }
+    else if (strcmp(dtype, "float16") == 0) {
+#ifdef MPIX_C_FLOAT16
+        return new hip_mpitest_reduction_t<hip_mpitest_float16>(dtype, MPIX_C_FLOAT16, op, false);
+#else
+        return new hip_mpitest_reduction_t<hip_mpitest_float16>(dtype, MPI_DATATYPE_NULL, op, true);
+#endif
+    }
+
+    return NULL;
+}
+
+// Returns the reduction selected with --dtype and --op, aborts on invalid selections
+static hip_mpitest_reduction* hip_mpitest_reduction_select (MPI_Comm comm)
+{
+    hip_mpitest_reduction *red = hip_mpitest_reduction_create(hip_mpitest_dtype, hip_mpitest_op);
+
+    if (NULL == red) {
+        int rank;
+        MPI_Comm_rank (comm, &rank);
+        if (rank == 0) {
+            printf("Invalid combination of datatype %s and operation %s\n", hip_mpitest_dtype, hip_mpitest_op);
+        }
+        MPI_Abort (comm, 1);
+    }
+    return red;
+}
+
+#endif
@@ -0,0 +1,163 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#ifndef __HIP_MPITEST_SKEW__
+#define __HIP_MPITEST_SKEW__
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mpi.h"
+#include "hip_mpitest_clock.h"
+
+/*
+** Per-iteration arrival skew of collective operations.
+**
+** If the environment variable HIP_MPITEST_SKEW is set, the benchmarks
+** synchronize the clocks of all processes to rank 0 before each message
+** length and record the entry and exit time of every iteration. For each
+** message length the following averages over all iterations are reported:
+**   entry_spread: time between the first and the last process entering
+**   exit_spread:  time between the first and the last process leaving
+**   lifo:         time between the last process entering and the first
+**                 process leaving, i.e. the cost of the operation without
+**                 the load imbalance. Can be negative for operations that
+**                 do not synchronize all processes (e.g. MPI_Bcast).
+*/
+
+static bool    hip_mpitest_skew_active=false;
+static double  hip_mpitest_skew_offset=0.0;
+static double *hip_mpitest_skew_entry=NULL;
+static double *hip_mpitest_skew_exit=NULL;
+static int     hip_mpitest_skew_niter=0;
+
+#define BENCH_SKEW_ENTER(_i) {                                       \
+    if (hip_mpitest_skew_active && (_i) < hip_mpitest_skew_niter) {  \
+        hip_mpitest_skew_entry[_i] = hip_mpitest_clock_now();        \
+    }                                                                \
+}
+
+#define BENCH_SKEW_EXIT(_i) {                                        \
+    if (hip_mpitest_skew_active && (_i) < hip_mpitest_skew_niter) {  \
+        hip_mpitest_skew_exit[_i] = hip_mpitest_clock_now();         \
+    }                                                                \
+}
+
+static inline void bench_skew_init (MPI_Comm comm)
+{
+    if (NULL != getenv("HIP_MPITEST_SKEW")) {
+        hip_mpitest_skew_active = true;
+    }
+}
+
+// Has to be called by all processes before the timed region of a message length
+static inline void bench_skew_begin (MPI_Comm comm, int niter)
+{
+    if (!hip_mpitest_skew_active) {
+        return;
+    }
+
+    // re-synchronize for every message length to compensate clock drift,
+    // the synchronization is not recorded by the PMPI profiling library
+    hip_mpitest_skew_offset = hip_mpitest_clock_sync (comm);
+
+    if (niter > hip_mpitest_skew_niter) {
+        free (hip_mpitest_skew_entry);
+        free (hip_mpitest_skew_exit);
+        hip_mpitest_skew_entry = (double *) malloc (niter * sizeof(double));
+        hip_mpitest_skew_exit  = (double *) malloc (niter * sizeof(double));
+        if (NULL == hip_mpitest_skew_entry || NULL == hip_mpitest_skew_exit) {
+            fprintf(stderr, "Could not allocate memory, skew measurement disabled\n");
+            MPI_Abort (comm, 1);
+        }
+    }
+    hip_mpitest_skew_niter = niter;
+}
+
+/*
+** Computes the average entry spread, exit spread and last-in-first-out
+** time on rank 0 of comm. Returns false if no measurement was taken. The
+** timestamps are reduced through the PMPI interface.
+*/
+static inline bool bench_skew_end (MPI_Comm comm, int niter, double *entry_spread,
+                                   double *exit_spread, double *lifo)
+{
+    int rank;
+    double *buf, *max_entry, *min_entry, *max_exit, *min_exit;
+
+    if (!hip_mpitest_skew_active) {
+        return false;
+    }
+    if (niter > hip_mpitest_skew_niter) {
+        niter = hip_mpitest_skew_niter;
+    }
+
+    PMPI_Comm_rank (comm, &rank);
+    buf = (double *) malloc (4 * niter * sizeof(double));
+    if (NULL == buf) {
+        fprintf(stderr, "Could not allocate memory\n");
+        MPI_Abort (comm, 1);
+    }
+    max_entry = buf;
+    min_entry = buf + niter;
+    max_exit  = buf + 2*niter;
+    min_exit  = buf + 3*niter;
+
+    for (int i=0; i<niter; i++) {
+        hip_mpitest_skew_entry[i] += hip_mpitest_skew_offset;
+        hip_mpitest_skew_exit[i]  += hip_mpitest_skew_offset;
+    }
+    PMPI_Reduce (hip_mpitest_skew_entry, max_entry, niter, MPI_DOUBLE, MPI_MAX, 0, comm);
+    PMPI_Reduce (hip_mpitest_skew_entry, min_entry, niter, MPI_DOUBLE, MPI_MIN, 0, comm);
+    PMPI_Reduce (hip_mpitest_skew_exit,  max_exit,  niter, MPI_DOUBLE, MPI_MAX, 0, comm);
+    PMPI_Reduce (hip_mpitest_skew_exit,  min_exit,  niter, MPI_DOUBLE, MPI_MIN, 0, comm);
+
+    *entry_spread = 0.0;
+    *exit_spread  = 0.0;
+    *lifo         = 0.0;
+    if (rank == 0) {
+        for (int i=0; i<niter; i++) {
+            *entry_spread += max_entry[i] - min_entry[i];
+            *exit_spread  += max_exit[i]  - min_exit[i];
+            *lifo         += min_exit[i]  - max_entry[i];
+        }
+        *entry_spread /= niter;
+        *exit_spread  /= niter;
+        *lifo         /= niter;
+    }
+
+    free (buf);
+    return true;
+}
+
+static inline void bench_skew_finalize (void)
+{
+    free (hip_mpitest_skew_entry);
+    free (hip_mpitest_skew_exit);
+    hip_mpitest_skew_entry = NULL;
+    hip_mpitest_skew_exit  = NULL;
+    hip_mpitest_skew_niter = 0;
+    hip_mpitest_skew_active = false;
+}
+
+#endif
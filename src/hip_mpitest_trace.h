@@ -0,0 +1,283 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#ifndef __HIP_MPITEST_TRACE__
+#define __HIP_MPITEST_TRACE__
+
+#include "hip_mpitest_config.h"
+
+/*
+** Timeline tracer of the testsuite (enabled with --enable-trace).
+**
+** The test loops and the buffer copy functions record begin/end timestamps,
+** operation name, number of bytes and memory types of every operation into
+** a per-process ring buffer. The slot of an event is reserved with an atomic
+** increment, no lock is required. If the ring buffer overflows, the oldest
+** events are overwritten. The size of the ring buffer can be set with the
+** environment variable HIP_MPITEST_TRACE_EVENTS (default 65536).
+**
+** The clock offset of each process to rank 0 is estimated in parse_args.
+** When MPI_Finalize is called, the events of all processes are collected on
+** rank 0, corrected for the clock offset and written in the Chrome trace
+** event format to hip_mpitest_trace.json, or the file named by the
+** environment variable HIP_MPITEST_TRACE_FILE. The file can be viewed with
+** chrome://tracing or https://ui.perfetto.dev. The tracer communicates
+** through the PMPI interface, i.e. its messages are not recorded by the
+** profiling library.
+*/
+
+#if HIP_MPITEST_TRACE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+
+#include "mpi.h"
+#include "hip_mpitest_clock.h"
+
+#define HIP_MPITEST_TRACE_NAMELEN 32
+#define HIP_MPITEST_TRACE_EVENTS  65536
+
+typedef struct hip_mpitest_trace_event_s {
+    double tbegin;
+    double tend;
+    long   bytes;
+    char   name[HIP_MPITEST_TRACE_NAMELEN];
+    char   smem;
+    char   rmem;
+} hip_mpitest_trace_event_t;
+
+static hip_mpitest_trace_event_t   *hip_mpitest_trace_events=NULL;
+static unsigned long                hip_mpitest_trace_capacity=0;
+static std::atomic<unsigned long>   hip_mpitest_trace_head(0);
+static double                       hip_mpitest_trace_offset=0.0;
+static MPI_Comm                     hip_mpitest_trace_comm=MPI_COMM_NULL;
+[[maybe_unused]] static char        hip_mpitest_trace_smem='-';
+[[maybe_unused]] static char        hip_mpitest_trace_rmem='-';
+
+static void hip_mpitest_trace_record (const char *name, double tbegin, long bytes, char smem, char rmem)
+{
+    double tend = hip_mpitest_clock_now();
+
+    if (NULL == hip_mpitest_trace_events) {
+        return;
+    }
+
+    unsigned long idx = hip_mpitest_trace_head.fetch_add(1, std::memory_order_relaxed);
+    hip_mpitest_trace_event_t *ev = &hip_mpitest_trace_events[idx % hip_mpitest_trace_capacity];
+    ev->tbegin = tbegin;
+    ev->tend   = tend;
+    ev->bytes  = bytes;
+    ev->smem   = smem;
+    ev->rmem   = rmem;
+    strncpy (ev->name, name, HIP_MPITEST_TRACE_NAMELEN);
+    ev->name[HIP_MPITEST_TRACE_NAMELEN-1] = '\0';
+}
+
+static inline long hip_mpitest_trace_bytes (int count, MPI_Datatype datatype)
+{
+    int tsize;
+
+    if (count <= 0 || MPI_DATATYPE_NULL == datatype) {
+        return 0;
+    }
+    MPI_Type_size (datatype, &tsize);
+    return (long)count * tsize;
+}
+
+static void hip_mpitest_trace_write (FILE *out, hip_mpitest_trace_event_t *events, int *counts,
+                                     double *offsets, int size)
+{
+    double tmin = -1.0;
+    int n = 0;
+
+    for (int r=0; r<size; r++) {
+        for (int i=0; i<counts[r]; i++, n++) {
+            double t = events[n].tbegin + offsets[r];
+            if (tmin < 0.0 || t < tmin) {
+                tmin = t;
+            }
+        }
+    }
+
+    fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    for (int r=0; r<size; r++) {
+        fprintf(out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":0,"
+                "\"args\":{\"name\":\"rank %d\"}},\n", r, r);
+        fprintf(out, "{\"name\":\"process_sort_index\",\"ph\":\"M\",\"pid\":%d,\"tid\":0,"
+                "\"args\":{\"sort_index\":%d}},\n", r, r);
+    }
+
+    n = 0;
+    for (int r=0; r<size; r++) {
+        for (int i=0; i<counts[r]; i++, n++) {
+            hip_mpitest_trace_event_t *ev = &events[n];
+            fprintf(out, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":0,"
+                    "\"ts\":%.3lf,\"dur\":%.3lf,\"args\":{\"bytes\":%ld,\"sendbuf\":\"%c\","
+                    "\"recvbuf\":\"%c\"}}%s\n", ev->name,
+                    strncmp(ev->name, "MPI_", 4) == 0 ? "mpi" : "copy", r,
+                    (ev->tbegin + offsets[r] - tmin) * 1e6, (ev->tend - ev->tbegin) * 1e6,
+                    ev->bytes, ev->smem, ev->rmem, (r == size-1 && i == counts[r]-1) ? "" : ",");
+        }
+    }
+    fprintf(out, "]}\n");
+}
+
+/*
+** Called by MPI_Finalize when the attributes of MPI_COMM_SELF are deleted,
+** i.e. before any other part of MPI is shut down.
+*/
+static int hip_mpitest_trace_finalize (MPI_Comm comm, int keyval, void *attr, void *extra)
+{
+    int rank, size, nlocal, ntotal=0;
+    int *counts=NULL, *displs=NULL;
+    double *offsets=NULL;
+    hip_mpitest_trace_event_t *local=NULL, *all=NULL;
+    int esize = sizeof(hip_mpitest_trace_event_t);
+    unsigned long head = hip_mpitest_trace_head.load();
+
+    PMPI_Comm_rank (hip_mpitest_trace_comm, &rank);
+    PMPI_Comm_size (hip_mpitest_trace_comm, &size);
+
+    // bring the events into chronological order
+    nlocal = head < hip_mpitest_trace_capacity ? (int)head : (int)hip_mpitest_trace_capacity;
+    local  = (hip_mpitest_trace_event_t *) malloc ((nlocal > 0 ? nlocal : 1) * esize);
+    if (NULL == local) {
+        nlocal = 0;
+    }
+    for (int i=0; i<nlocal; i++) {
+        local[i] = hip_mpitest_trace_events[(head - nlocal + i) % hip_mpitest_trace_capacity];
+    }
+    if (head > hip_mpitest_trace_capacity) {
+        fprintf(stderr, "[%d] Trace: %lu events overwritten, increase HIP_MPITEST_TRACE_EVENTS\n",
+                rank, head - hip_mpitest_trace_capacity);
+    }
+
+    if (rank == 0) {
+        counts  = (int *) malloc (size * sizeof(int));
+        displs  = (int *) malloc (size * sizeof(int));
+        offsets = (double *) malloc (size * sizeof(double));
+        if (NULL == counts || NULL == displs || NULL == offsets) {
+            fprintf(stderr, "Trace: Could not allocate memory\n");
+            MPI_Abort (hip_mpitest_trace_comm, 1);
+        }
+    }
+    PMPI_Gather (&nlocal, 1, MPI_INT, counts, 1, MPI_INT, 0, hip_mpitest_trace_comm);
+    PMPI_Gather (&hip_mpitest_trace_offset, 1, MPI_DOUBLE, offsets, 1, MPI_DOUBLE, 0,
+                hip_mpitest_trace_comm);
+    if (rank == 0) {
+        for (int r=0; r<size; r++) {
+            displs[r] = ntotal * esize;
+            ntotal   += counts[r];
+        }
+        all = (hip_mpitest_trace_event_t *) malloc ((ntotal > 0 ? ntotal : 1) * esize);
+        if (NULL == all) {
+            fprintf(stderr, "Trace: Could not allocate memory\n");
+            MPI_Abort (hip_mpitest_trace_comm, 1);
+        }
+        for (int r=0; r<size; r++) {
+            counts[r] *= esize;
+        }
+    }
+    PMPI_Gatherv (local, nlocal * esize, MPI_BYTE, all, counts, displs, MPI_BYTE, 0,
+                 hip_mpitest_trace_comm);
+
+    if (rank == 0) {
+        const char *fname = getenv("HIP_MPITEST_TRACE_FILE");
+        if (NULL == fname) {
+            fname = "hip_mpitest_trace.json";
+        }
+        for (int r=0; r<size; r++) {
+            counts[r] /= esize;
+        }
+        FILE *out = fopen (fname, "w");
+        if (NULL == out) {
+            fprintf(stderr, "Trace: Could not open %s\n", fname);
+        }
+        else {
+            hip_mpitest_trace_write (out, all, counts, offsets, size);
+            fclose (out);
+        }
+    }
+
+    free (local);
+    free (all);
+    free (counts);
+    free (displs);
+    free (offsets);
+    free (hip_mpitest_trace_events);
+    hip_mpitest_trace_events = NULL;
+    PMPI_Comm_free (&hip_mpitest_trace_comm);
+
+    return MPI_SUCCESS;
+}
+
+static void hip_mpitest_trace_init (MPI_Comm comm)
+{
+    int keyval;
+    char *nevents = getenv("HIP_MPITEST_TRACE_EVENTS");
+
+    if (MPI_COMM_NULL != hip_mpitest_trace_comm) {
+        return;
+    }
+
+    hip_mpitest_trace_capacity = HIP_MPITEST_TRACE_EVENTS;
+    if (NULL != nevents && atol(nevents) > 0) {
+        hip_mpitest_trace_capacity = atol(nevents);
+    }
+    hip_mpitest_trace_events = (hip_mpitest_trace_event_t *) malloc (hip_mpitest_trace_capacity *
+                                                                     sizeof(hip_mpitest_trace_event_t));
+    if (NULL == hip_mpitest_trace_events) {
+        fprintf(stderr, "Trace: Could not allocate memory, tracing disabled\n");
+    }
+
+    PMPI_Comm_dup (comm, &hip_mpitest_trace_comm);
+    hip_mpitest_trace_offset = hip_mpitest_clock_sync (hip_mpitest_trace_comm);
+
+    MPI_Comm_create_keyval (MPI_COMM_NULL_COPY_FN, hip_mpitest_trace_finalize, &keyval, NULL);
+    MPI_Comm_set_attr (MPI_COMM_SELF, keyval, NULL);
+}
+
+#define HIP_MPITEST_TRACE_BEGIN() \
+    double _trace_tbegin = hip_mpitest_clock_now()
+#define HIP_MPITEST_TRACE_END(_name, _count, _datatype)                             \
+    hip_mpitest_trace_record(_name, _trace_tbegin, hip_mpitest_trace_bytes(_count, _datatype), \
+                             hip_mpitest_trace_smem, hip_mpitest_trace_rmem)
+#define HIP_MPITEST_TRACE_COPY(_name, _nBytes, _smem, _rmem) \
+    hip_mpitest_trace_record(_name, _trace_tbegin, (long)(_nBytes), _smem, _rmem)
+#define HIP_MPITEST_TRACE_SENDBUF(_buf) hip_mpitest_trace_smem = (_buf)->get_memchar()
+#define HIP_MPITEST_TRACE_RECVBUF(_buf) hip_mpitest_trace_rmem = (_buf)->get_memchar()
+
+#else
+
+#define hip_mpitest_trace_init(_comm)
+#define HIP_MPITEST_TRACE_BEGIN()
+#define HIP_MPITEST_TRACE_END(_name, _count, _datatype)
+#define HIP_MPITEST_TRACE_COPY(_name, _nBytes, _smem, _rmem)
+#define HIP_MPITEST_TRACE_SENDBUF(_buf)
+#define HIP_MPITEST_TRACE_RECVBUF(_buf)
+
+#endif
+
+#endif // __HIP_MPITEST_TRACE__
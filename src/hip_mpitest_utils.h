@@ -79,7 +79,8 @@ static void print_help (int argc, char **argv)
     MPI_Comm_rank (MPI_COMM_WORLD, &rank);
     if (0 == rank) {
         // print help message
-        printf("Usage: %s -s <sendBufType> -r <recvBufType> -n <elements> -t <sleepTime>\n", argv[0]);
+        printf("Usage: %s -s <sendBufType> -r <recvBufType> -n <elements> -t <sleepTime>"
+               " --dtype <datatype> --op <operation>\n", argv[0]);
         printf("   with sendBufType and recvBufType being : \n"
                "         D      Device memory (i.e. hipMalloc) - default if not specified \n"
                "         H      Host memory (i.e. malloc)\n"
@@ -87,7 +88,12 @@ static void print_help (int argc, char **argv)
                "         O      Device accessible page locked host memory (i.e. hipHostMalloc)\n"
                "         R      Registered host memory (i.e. hipHostRegister)\n"
 	       "   elements:  number of elements to send/recv\n"
-               "   sleepTime: time in seconds to sleep (optional)\n");
+               "   sleepTime: time in seconds to sleep (optional)\n"
+               "   datatype:  element type of the reduction tests and benchmarks (optional)\n"
+               "              int8, int16, int32, int64, float, double - default, complex,\n"
+               "              bfloat16, float16\n"
+               "   operation: operation of the reduction tests and benchmarks (optional)\n"
+               "              sum - default, prod, max, min, maxloc, band, user\n");
     }
 }
 
@@ -95,6 +101,10 @@ extern hip_mpitest_buffer *sendbuf;
 extern hip_mpitest_buffer *recvbuf;
 extern int elements;
 
+// element type and operation of the reduction tests, see hip_mpitest_reduce.h
+static const char *hip_mpitest_dtype="double";
+static const char *hip_mpitest_op="sum";
+
 static void parse_args ( int argc, char **argv, MPI_Comm comm )
 {
     static struct option longopts[] = {
@@ -102,13 +112,16 @@ static void parse_args ( int argc, char **argv, MPI_Comm comm )
         {"recvbuftype", required_argument, 0, 'r'},
         {"elements",    required_argument, 0, 'n'},
         {"sleeptime",   required_argument, 0, 't'},
-        {"help",        no_argument,       0, 'h'}
+        {"dtype",       required_argument, 0, 'd'},
+        {"op",          required_argument, 0, 'o'},
+        {"help",        no_argument,       0, 'h'},
+        {0,             0,                 0,  0 }
     };
 
     int longindex, stime=0;
     while (1) {
         int c;
-        c = getopt_long(argc, argv, "s:r:n:t:h", longopts, &longindex);
+        c = getopt_long(argc, argv, "s:r:n:t:d:o:h", longopts, &longindex);
 
         if (c == -1)
             break;
@@ -135,6 +148,12 @@ static void parse_args ( int argc, char **argv, MPI_Comm comm )
                 sleep (stime);
             }
             break;
+        case 'd' :
+            hip_mpitest_dtype = optarg;
+            break;
+        case 'o' :
+            hip_mpitest_op = optarg;
+            break;
         default :
             print_help(argc, argv);
             MPI_Finalize();
@@ -154,6 +173,8 @@ static void parse_args ( int argc, char **argv, MPI_Comm comm )
     signal(SIGBUS,  sig_handler);
     signal(SIGFPE,  sig_handler);
     signal(SIGSEGV, sig_handler);
+
+    hip_mpitest_trace_init(comm);
     return;
 }
 
@@ -176,7 +197,7 @@ static void bind_device()
     return;
 }
 
-static void report_buffertype (MPI_Comm comm, const char *name, hip_mpitest_buffer *buf)
+static inline void report_buffertype (MPI_Comm comm, const char *name, hip_mpitest_buffer *buf)
 {
 #ifdef VERBOSE
     int rank;
@@ -189,6 +210,22 @@ static void report_buffertype (MPI_Comm comm, const char *name, hip_mpitest_buff
 #endif
 }
 
+/*
+** Sets path to the test file name in the directory HIP_MPITEST_IO_DIR
+** (default: the working directory), e.g. on the file system to be tested.
+*/
+static inline const char* hip_mpitest_io_path (const char *name, char *path, size_t len)
+{
+    char *dir = getenv("HIP_MPITEST_IO_DIR");
+
+    if (NULL != dir && strlen(dir) > 0) {
+        snprintf(path, len, "%s/%s", dir, name);
+    }
+    else {
+        snprintf(path, len, "%s", name);
+    }
+    return path;
+}
 
 static void report_performance (char *exec, MPI_Comm comm, char sendtype, char recvtype,
                                 int elements, long nBytes, int niter, double time)
@@ -33,6 +33,22 @@ int elements=1024;
 hip_mpitest_buffer *sendbuf=NULL;
 hip_mpitest_buffer *recvbuf=NULL;
 
+/*
+** The window exposes the receive buffer on the root and the send buffer on
+** all other processes. By default it is created with MPI_Win_create on these
+** buffers, the following defines select another window flavor:
+**   HIP_MPITEST_OSC_WIN_ALLOCATE  window memory allocated by MPI_Win_allocate
+**   HIP_MPITEST_OSC_WIN_SHARED    window memory allocated by MPI_Win_allocate_shared
+**                                 on the processes of each node
+**   HIP_MPITEST_OSC_WIN_DYNAMIC   buffers attached to a window created by
+**                                 MPI_Win_create_dynamic
+** Library allocated window memory is initialized from the user buffers before
+** the test, and the result is copied back to the receive buffer of the root.
+** With HIP_MPITEST_OSC_LOADSTORE (shared windows only) the data is not moved by
+** MPI_Put/MPI_Get but by direct stores/loads to the window segment of the
+** target returned by MPI_Win_shared_query.
+*/
+
 static void init_sendbuf (int *sendbuf, int count, int mynode)
 {
     for (int i = 0; i < count; i++) {
@@ -66,20 +82,29 @@ static bool check_recvbuf (int *recvbuf, int nProcs, int rank, int count)
 }
 
 static int type_osc_test ( void *sendbuf, void *recvbuf, int count,
-                           MPI_Datatype datatype, int root, MPI_Comm comm, MPI_Win win);
+                           MPI_Datatype datatype, int root, MPI_Comm comm, MPI_Win win,
+                           MPI_Aint *tbase);
 
 int main (int argc, char *argv[])
 {
     int rank, nProcs;
     int root = 0; //checkbuff will not work for any other root value right now
     MPI_Win win = MPI_WIN_NULL;
+    MPI_Comm comm = MPI_COMM_WORLD;
+    void *winbuf, *winbase=NULL;
+    MPI_Aint winsize, *tbase=NULL;
+    bool attached=false;
     int ret;
 
     bind_device();
 
     MPI_Init      (&argc, &argv);
-    MPI_Comm_size (MPI_COMM_WORLD, &nProcs);
-    MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+#ifdef HIP_MPITEST_OSC_WIN_SHARED
+    // shared memory windows can only span the processes of a node
+    MPI_Comm_split_type (MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &comm);
+#endif
+    MPI_Comm_size (comm, &nProcs);
+    MPI_Comm_rank (comm, &rank);
 
     parse_args(argc, argv, MPI_COMM_WORLD);
 
@@ -94,25 +119,67 @@ int main (int argc, char *argv[])
 
     //Create window
     if (rank == root) {
-        ret = MPI_Win_create (recvbuf->get_buffer(), nProcs*elements*sizeof(int), sizeof(int), MPI_INFO_NULL,
-                              MPI_COMM_WORLD, &win);
+        winbuf  = recvbuf->get_buffer();
+        winsize = nProcs*elements*sizeof(int);
     }
     else {
-        ret = MPI_Win_create (sendbuf->get_buffer(), elements*sizeof(int), sizeof(int), MPI_INFO_NULL,
-                              MPI_COMM_WORLD, &win);
+        winbuf  = sendbuf->get_buffer();
+        winsize = elements*sizeof(int);
+    }
+#if defined HIP_MPITEST_OSC_WIN_ALLOCATE
+    ret = MPI_Win_allocate (winsize, sizeof(int), MPI_INFO_NULL, comm, &winbase, &win);
+#elif defined HIP_MPITEST_OSC_WIN_SHARED
+    ret = MPI_Win_allocate_shared (winsize, sizeof(int), MPI_INFO_NULL, comm, &winbase, &win);
+#elif defined HIP_MPITEST_OSC_WIN_DYNAMIC
+    ret = MPI_Win_create_dynamic (MPI_INFO_NULL, comm, &win);
+#else
+    ret = MPI_Win_create (winbuf, winsize, sizeof(int), MPI_INFO_NULL, comm, &win);
+#endif
+    if (MPI_SUCCESS != ret) {
+        goto out;
     }
+
+#ifdef HIP_MPITEST_OSC_WIN_DYNAMIC
+    ret = MPI_Win_attach (win, winbuf, winsize);
     if (MPI_SUCCESS != ret) {
         goto out;
     }
+    attached = true;
+
+    // displacements in a dynamic window are the addresses on the target
+    MPI_Aint addr;
+    tbase = (MPI_Aint *) malloc (nProcs * sizeof(MPI_Aint));
+    if (NULL == tbase) {
+        ret = MPI_ERR_OTHER;
+        goto out;
+    }
+    MPI_Get_address (winbuf, &addr);
+    ret = MPI_Allgather (&addr, 1, MPI_AINT, tbase, 1, MPI_AINT, comm);
+    if (MPI_SUCCESS != ret) {
+        goto out;
+    }
+#endif
+
+    if (NULL != winbase) {
+        HIP_CHECK(hipMemcpy(winbase, winbuf, winsize, hipMemcpyDefault));
+        // the window memory of all targets has to be initialized before the first access
+        MPI_Barrier (comm);
+    }
 
     //execute one-sided operations
     ret = type_osc_test (sendbuf->get_buffer(), recvbuf->get_buffer(),
-                         elements, MPI_INT, root, MPI_COMM_WORLD, win);
+                         elements, MPI_INT, root, comm, win, tbase);
     if (MPI_SUCCESS != ret) {
         printf("Error in type_osc_test. Aborting\n");
         goto out;
     }
 
+#if defined HIP_MPITEST_OSC_PUT || defined HIP_MPITEST_OSC_RPUT
+    if (NULL != winbase && rank == root) {
+        HIP_CHECK(hipMemcpy(winbuf, winbase, winsize, hipMemcpyDefault));
+    }
+#endif
+
     // verify results
     bool res, fret;
     res=true;
@@ -131,9 +198,16 @@ int main (int argc, char *argv[])
 
  out:
     //Cleanup dynamic buffers
+    if (attached) {
+        MPI_Win_detach (win, winbuf);
+    }
     if (MPI_WIN_NULL != win) {
         MPI_Win_free (&win);
     }
+    if (MPI_COMM_WORLD != comm) {
+        MPI_Comm_free (&comm);
+    }
+    free (tbase);
     FREE_BUFFER(sendbuf, tmp_sendbuf);
     FREE_BUFFER(recvbuf, tmp_recvbuf);
 
@@ -149,8 +223,42 @@ int main (int argc, char *argv[])
 }
 
 
+#ifndef HIP_MPITEST_OSC_LOADSTORE
+// Returns the target displacement, which is an address on the target for dynamic windows
+static MPI_Aint osc_disp (MPI_Aint *tbase, int target, MPI_Aint disp, int tsize)
+{
+    return (NULL == tbase) ? disp : tbase[target] + disp * tsize;
+}
+#else
+// Returns the start of the window segment of the target in the address space of the caller
+static char *osc_segment (MPI_Win win, int target)
+{
+    MPI_Aint segsize;
+    int dispunit;
+    char *base = NULL;
+
+    if (MPI_SUCCESS != MPI_Win_shared_query (win, target, &segsize, &dispunit, &base)) {
+        return NULL;
+    }
+    return base;
+}
+#endif
+
+#if defined HIP_MPITEST_OSC_LOADSTORE
+#define OSC_TRACE_NAME "load/store"
+#elif defined HIP_MPITEST_OSC_GET
+#define OSC_TRACE_NAME "MPI_Get"
+#elif defined HIP_MPITEST_OSC_RGET
+#define OSC_TRACE_NAME "MPI_Rget"
+#elif defined HIP_MPITEST_OSC_RPUT
+#define OSC_TRACE_NAME "MPI_Rput"
+#else
+#define OSC_TRACE_NAME "MPI_Put"
+#endif
+
 int type_osc_test (void *sbuf, void *rbuf, int count,
-                   MPI_Datatype datatype, int root, MPI_Comm comm, MPI_Win win)
+                   MPI_Datatype datatype, int root, MPI_Comm comm, MPI_Win win,
+                   MPI_Aint *tbase)
 {
     int size, rank, ret;
     int tsize;
@@ -159,6 +267,17 @@ int type_osc_test (void *sbuf, void *rbuf, int count,
     MPI_Comm_rank (comm, &rank);
     MPI_Type_size (datatype, &tsize);
 
+    // one event per epoch, including the synchronization
+    HIP_MPITEST_TRACE_BEGIN();
+
+#ifdef HIP_MPITEST_OSC_LOADSTORE
+    ret = MPI_Win_lock_all (MPI_MODE_NOCHECK, win);
+    if (MPI_SUCCESS != ret) {
+        return ret;
+    }
+    MPI_Win_sync (win);
+#endif
+
 #ifdef HIP_MPITEST_OSC_FENCE
     ret = MPI_Win_fence (0, win);
     if (MPI_SUCCESS != ret) {
@@ -177,14 +296,21 @@ int type_osc_test (void *sbuf, void *rbuf, int count,
                     return ret;
                 }
 #endif
-#if defined HIP_MPITEST_OSC_GET
-                ret = MPI_Get (r, count, datatype, i, 0, count, datatype, win);
+#if defined HIP_MPITEST_OSC_LOADSTORE
+                char *base = osc_segment (win, i);
+                if (NULL == base || hipSuccess != hipMemcpy (r, base, count*tsize, hipMemcpyDefault)) {
+                    return MPI_ERR_OTHER;
+                }
+#elif defined HIP_MPITEST_OSC_GET
+                ret = MPI_Get (r, count, datatype, i, osc_disp(tbase, i, 0, tsize), count,
+                               datatype, win);
                 if (MPI_SUCCESS != ret) {
                     return ret;
                 }
 #elif defined HIP_MPITEST_OSC_RGET
                 MPI_Request req;
-                ret = MPI_Rget (r, count, datatype, i, 0, count, datatype, win, &req);
+                ret = MPI_Rget (r, count, datatype, i, osc_disp(tbase, i, 0, tsize), count,
+                                datatype, win, &req);
                 if (MPI_SUCCESS != ret) {
                     return ret;
                 }
@@ -213,14 +339,22 @@ int type_osc_test (void *sbuf, void *rbuf, int count,
             return ret;
         }
 #endif
-#if defined HIP_MPITEST_OSC_PUT
-        ret = MPI_Put(sbuf, count, datatype, root, disp, count, datatype, win);
+#if defined HIP_MPITEST_OSC_LOADSTORE
+        char *base = osc_segment (win, root);
+        if (NULL == base || hipSuccess != hipMemcpy (base + disp*tsize, sbuf, count*tsize,
+                                                     hipMemcpyDefault)) {
+            return MPI_ERR_OTHER;
+        }
+#elif defined HIP_MPITEST_OSC_PUT
+        ret = MPI_Put(sbuf, count, datatype, root, osc_disp(tbase, root, disp, tsize), count,
+                      datatype, win);
         if (MPI_SUCCESS != ret) {
             return ret;
         }
 #elif defined HIP_MPITEST_OSC_RPUT
         MPI_Request req;
-        ret = MPI_Rput(sbuf, count, datatype, root, disp, count, datatype, win, &req);
+        ret = MPI_Rput(sbuf, count, datatype, root, osc_disp(tbase, root, disp, tsize), count,
+                       datatype, win, &req);
         if (MPI_SUCCESS != ret) {
             return ret;
         }
@@ -253,5 +387,25 @@ int type_osc_test (void *sbuf, void *rbuf, int count,
     }
 #endif
 
+#ifdef HIP_MPITEST_OSC_LOADSTORE
+    // make the stores of all processes visible before the root reads its segment
+    MPI_Win_sync (win);
+    ret = MPI_Barrier(comm);
+    if (MPI_SUCCESS != ret) {
+        return ret;
+    }
+    MPI_Win_sync (win);
+    ret = MPI_Win_unlock_all (win);
+    if (MPI_SUCCESS != ret) {
+        return ret;
+    }
+#endif
+
+#if defined HIP_MPITEST_OSC_GET || defined HIP_MPITEST_OSC_RGET
+    HIP_MPITEST_TRACE_END(OSC_TRACE_NAME, rank == root ? count*(size-1) : 0, datatype);
+#else
+    HIP_MPITEST_TRACE_END(OSC_TRACE_NAME, rank != root ? count : 0, datatype);
+#endif
+
     return MPI_SUCCESS;
 }
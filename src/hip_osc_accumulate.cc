@@ -144,6 +144,7 @@ int type_osc_accumulate_test (void *sbuf, void *rbuf, int count,
     MPI_Comm_rank (comm, &rank);
     MPI_Type_size (datatype, &tsize);
 
+    HIP_MPITEST_TRACE_BEGIN();
 #ifdef HIP_MPITEST_OSC_ACCUMULATE_FENCE
     ret = MPI_Win_fence (0, win);
     if (MPI_SUCCESS != ret) {
@@ -183,5 +184,6 @@ int type_osc_accumulate_test (void *sbuf, void *rbuf, int count,
         return ret;
     }
 #endif
+    HIP_MPITEST_TRACE_END("MPI_Accumulate", count*size, datatype);
     return MPI_SUCCESS;
 }
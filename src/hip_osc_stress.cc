@@ -158,6 +158,7 @@ int type_osc_stress_test (int *sbuf, int count, MPI_Comm comm, MPI_Win win)
 
     int datadisp = count * size * NUM_NB_ITERATIONS;
 
+    HIP_MPITEST_TRACE_BEGIN();
     ret = MPI_Win_lock_all(MPI_MODE_NOCHECK, win);
     if (MPI_SUCCESS != ret) {
         goto out;
@@ -195,6 +196,11 @@ int type_osc_stress_test (int *sbuf, int count, MPI_Comm comm, MPI_Win win)
     if (MPI_SUCCESS != ret) {
         goto out;
     }
+#ifdef HIP_MPITEST_OSC_RGET
+    HIP_MPITEST_TRACE_END("MPI_Rget", count*size*NUM_NB_ITERATIONS, MPI_INT);
+#else
+    HIP_MPITEST_TRACE_END("MPI_Rput", count*size*NUM_NB_ITERATIONS, MPI_INT);
+#endif
  out:
     free (reqs);
     return ret;
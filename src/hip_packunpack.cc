@@ -29,6 +29,7 @@
 
 #include "hip_mpitest_utils.h"
 #include "hip_mpitest_datatype.h"
+#include "hip_mpitest_datatype_catalog.h"
 #include "hip_mpitest_buffer.h"
 
 
@@ -37,15 +38,16 @@ int  elements=3;
 
 hip_mpitest_buffer *sendbuf=NULL;
 hip_mpitest_buffer *recvbuf=NULL;
+static int type_elements;
 
 static void init_contg_sendbuf (void *buf, int totalcount, int rank)
 {
     int *sbuf = (int  *)buf;
     int l=0;
-    int count = totalcount / (2*A_WIDTH);
+    int count = totalcount / type_elements;
 
     for (int i=0; i<count; i++) {
-        for (int j=0; j<2*A_WIDTH; j++, l++) {
+        for (int j=0; j<type_elements; j++, l++) {
             sbuf[l] = rank*3+i;
         }
     }
@@ -64,10 +66,10 @@ static bool check_contg_recvbuf(void *buf, int numprocs, int rank, int totalcoun
     int *recvbuf = (int*)buf;
     bool res = true;
     int l=0;
-    int count = totalcount / (2*A_WIDTH);
+    int count = totalcount / type_elements;
 
     for (int i=0; i<count && res != false; i++) {
-        for (int j=0; j<2*A_WIDTH; j++, l++) {
+        for (int j=0; j<type_elements; j++, l++) {
              if ( (recvbuf[l] != (rank*3)+i) ) {
                  res = false;
 #ifdef VERBOSE
@@ -98,8 +100,13 @@ int main (int argc, char *argv[])
 
     parse_args(argc, argv, comm);
 
-    hip_mpitest_datatype *dat = new (TEST_DATATYPE);
+    // the datatype selected at runtime replaces the compile time default
+    hip_mpitest_datatype *dat = hip_mpitest_datatype_select(comm);
+    if (NULL == dat) {
+        dat = new (TEST_DATATYPE);
+    }
     int *tmp_sendbuf=NULL, *tmp_recvbuf=NULL;
+    type_elements = dat->get_num_elements();
 
     // Initialise send buffer
 #ifdef HIP_MPITEST_UNPACK
@@ -193,10 +200,13 @@ int packunpack_test ( void *sendbuf, void *recvbuf, int count,
 
     for (int i=0; i<niterations; i++) {
         pos = 0;
+        HIP_MPITEST_TRACE_BEGIN();
 #ifdef HIP_MPITEST_UNPACK
         ret = MPI_Unpack(sendbuf, type_size*count, &pos, recvbuf, count, datatype, comm);
+        HIP_MPITEST_TRACE_END("MPI_Unpack", count, datatype);
 #else
         ret = MPI_Pack(sendbuf, count, datatype, recvbuf, type_extent*count, &pos, comm);
+        HIP_MPITEST_TRACE_END("MPI_Pack", count, datatype);
 #endif
         if (MPI_SUCCESS != ret) {
             return ret;
@@ -166,21 +166,25 @@ int type_p2p_bl_test(int *sbuf, int *rbuf, int count, MPI_Comm comm)
     MPI_Comm_rank(comm, &rank);
 
     if (rank == 0) {
+        HIP_MPITEST_TRACE_BEGIN();
         ret = MPI_Send(sbuf, count, MPI_INT, 1, tag, comm);
         if (MPI_SUCCESS != ret) {
             return ret;
         }
         ret = MPI_Recv(rbuf, count, MPI_INT, 1, tag, comm, &status);
+        HIP_MPITEST_TRACE_END("MPI_Send/MPI_Recv", count, MPI_INT);
         if (MPI_SUCCESS != ret) {
             return ret;
         }
     }
     if (rank == 1) {
+        HIP_MPITEST_TRACE_BEGIN();
         ret = MPI_Recv(rbuf, count, MPI_INT, 0, tag, comm, &status);
         if (MPI_SUCCESS != ret) {
             return ret;
         }
         ret = MPI_Send(sbuf, count, MPI_INT, 0, tag, comm);
+        HIP_MPITEST_TRACE_END("MPI_Recv/MPI_Send", count, MPI_INT);
         if (MPI_SUCCESS != ret) {
             return ret;
         }
@@ -214,21 +218,25 @@ int type_p2p_bsend_test(int *sbuf, int *rbuf, int count, MPI_Comm comm)
     }
 
     if (rank == 0) {
+        HIP_MPITEST_TRACE_BEGIN();
         ret = MPI_Bsend(sbuf, count, MPI_INT, 1, tag, comm);
         if (MPI_SUCCESS != ret) {
             goto out;
         }
         ret = MPI_Recv(rbuf, count, MPI_INT, 1, tag, comm, &status);
+        HIP_MPITEST_TRACE_END("MPI_Bsend/MPI_Recv", count, MPI_INT);
         if (MPI_SUCCESS != ret) {
             goto out;
         }
     }
     if (rank == 1) {
+        HIP_MPITEST_TRACE_BEGIN();
         ret = MPI_Recv(rbuf, count, MPI_INT, 0, tag, comm, &status);
         if (MPI_SUCCESS != ret) {
             goto out;
         }
         ret = MPI_Bsend(sbuf, count, MPI_INT, 0, tag, comm);
+        HIP_MPITEST_TRACE_END("MPI_Recv/MPI_Bsend", count, MPI_INT);
         if (MPI_SUCCESS != ret) {
             goto out;
         }
@@ -253,20 +261,24 @@ int type_p2p_ssend_test(int *sbuf, int *rbuf, int count, MPI_Comm comm) {
     MPI_Comm_size(comm, &size);
 
     if (rank == 0) {
+        HIP_MPITEST_TRACE_BEGIN();
         ret = MPI_Ssend(sbuf, count, MPI_INT, 1, tag, comm);
         if (MPI_SUCCESS != ret) {
             return ret;
         }
         ret = MPI_Recv(rbuf, count, MPI_INT, 1, tag, comm, &status);
+        HIP_MPITEST_TRACE_END("MPI_Ssend/MPI_Recv", count, MPI_INT);
         if (MPI_SUCCESS != ret) {
             return ret;
         }
     } else if (rank == 1) {
+        HIP_MPITEST_TRACE_BEGIN();
         ret = MPI_Recv(rbuf, count, MPI_INT, 0, tag, comm, &status);
         if (MPI_SUCCESS != ret) {
             return ret;
         }
         ret = MPI_Ssend(sbuf, count, MPI_INT, 0, tag, comm);
+        HIP_MPITEST_TRACE_END("MPI_Recv/MPI_Ssend", count, MPI_INT);
         if (MPI_SUCCESS != ret) {
             return ret;
         }
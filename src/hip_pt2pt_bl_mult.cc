@@ -180,13 +180,17 @@ int type_p2p_bl_mult_test(int *sbuf, int *rbuf, int count, MPI_Comm comm)
     MPI_Comm_rank(comm, &rank);
 
     if (rank == 0) {
+        HIP_MPITEST_TRACE_BEGIN();
         ret = MPI_Ssend(sbuf, count, MPI_INT, 1, tag, comm);
+        HIP_MPITEST_TRACE_END("MPI_Ssend", count, MPI_INT);
         if (MPI_SUCCESS != ret) {
             return ret;
         }
     }
     if (rank == 1) {
+        HIP_MPITEST_TRACE_BEGIN();
         ret = MPI_Recv(rbuf, count, MPI_INT, 0, tag, comm, &status);
+        HIP_MPITEST_TRACE_END("MPI_Recv", count, MPI_INT);
         if (MPI_SUCCESS != ret) {
             return ret;
         }
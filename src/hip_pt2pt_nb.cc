@@ -162,6 +162,7 @@ int type_p2p_nb_test (int *sbuf, int *rbuf, int count, MPI_Comm comm)
         return MPI_ERR_OTHER;
     }
 
+    HIP_MPITEST_TRACE_BEGIN();
     for (int i=0; i<size; i++) {
         if (i == rank) {
             // No send-to-self for the moment
@@ -194,6 +195,7 @@ int type_p2p_nb_test (int *sbuf, int *rbuf, int count, MPI_Comm comm)
         goto out;
     }
 #endif
+    HIP_MPITEST_TRACE_END("MPI_Isend/MPI_Irecv", count*(size-1), MPI_INT);
 
  out:
     free (reqs);
@@ -217,6 +219,7 @@ int type_p2p_persistent_test (int *sbuf, int *rbuf, int count, MPI_Comm comm)
         return MPI_ERR_OTHER;
     }
 
+    HIP_MPITEST_TRACE_BEGIN();
     for (int i=0; i<size; i++) {
         recvbuf = &rbuf[i*count];
         ret = MPI_Recv_init (recvbuf, count, MPI_INT, i, tag, comm, &reqs[2*i]);
@@ -237,6 +240,7 @@ int type_p2p_persistent_test (int *sbuf, int *rbuf, int count, MPI_Comm comm)
     if (MPI_SUCCESS != ret) {
         goto out;
     }
+    HIP_MPITEST_TRACE_END("MPI_Startall", count*size, MPI_INT);
 
  out:
     free (reqs);
@@ -156,6 +156,7 @@ int type_p2p_nb_stress_test (int *sbuf, int *rbuf, int count, MPI_Comm comm)
         printf("4. Could not allocate memory. Aborting\n");
         return MPI_ERR_OTHER;
     }
+    HIP_MPITEST_TRACE_BEGIN();
     for (int j=0; j<NUM_NB_ITERATIONS; j++) {
         for (int i=0; i<size; i++) {
 #ifndef HIP_MPITEST_SENDTOSELF
@@ -182,6 +183,11 @@ int type_p2p_nb_stress_test (int *sbuf, int *rbuf, int count, MPI_Comm comm)
     if (MPI_SUCCESS != ret) {
         goto out;
     }
+#ifdef HIP_MPITEST_SENDTOSELF
+    HIP_MPITEST_TRACE_END("MPI_Isend/MPI_Irecv", count*size*NUM_NB_ITERATIONS, MPI_INT);
+#else
+    HIP_MPITEST_TRACE_END("MPI_Isend/MPI_Irecv", count*(size-1)*NUM_NB_ITERATIONS, MPI_INT);
+#endif
  out:
     free (reqs);
     return ret;
@@ -29,42 +29,23 @@
 
 #include "hip_mpitest_utils.h"
 #include "hip_mpitest_buffer.h"
+#include "hip_mpitest_reduce.h"
 
 #define NITER 1
 int elements=100;
 hip_mpitest_buffer *sendbuf=NULL;
 hip_mpitest_buffer *recvbuf=NULL;
 
-static void init_sendbuf (double *sendbuf, int count, int mynode)
-{
-    for (int i = 0; i < count; i++) {
-        sendbuf[i] = (double)(mynode+i);
-    }
-}
+hip_mpitest_reduction *reduction=NULL;
 
-static void init_recvbuf (double *recvbuf, int count)
+static void init_sendbuf (char *sendbuf, int count, int mynode)
 {
-    for (int i = 0; i < count; i++) {
-        recvbuf[i] = (double)i;
-    }
+    reduction->init_sendbuf (sendbuf, count, mynode);
 }
 
-static bool check_recvbuf(double *recvbuf, int nprocs, int rank, int count)
+static void init_recvbuf (char *recvbuf, int count)
 {
-    bool res=true;
-    double expected = 0.0;
-
-    for (int i=0; i<count; i++) {
-        expected = (double)(rank + 2*i);
-        if (recvbuf[i] != expected) {
-            res = false;
-#ifdef VERBOSE
-            printf("recvbuf[%d] = %lf expected %lf\n", i, recvbuf[i], expected);
-#endif
-        }
-    }
-
-    return res;
+    reduction->init_recvbuf (recvbuf, count);
 }
 
 int reduce_local_test (void *sendbuf, void *recvbuf, int count,
@@ -85,22 +66,24 @@ int main (int argc, char *argv[])
     MPI_Comm_rank (MPI_COMM_WORLD, &rank);
 
     parse_args(argc, argv, MPI_COMM_WORLD);
+    reduction = hip_mpitest_reduction_select(MPI_COMM_WORLD);
 
-    double *tmp_sendbuf=NULL, *tmp_recvbuf=NULL;
+    char *tmp_sendbuf=NULL, *tmp_recvbuf=NULL;
+    size_t extent = reduction->get_extent();
 
     // Initialise send buffer
-    ALLOCATE_SENDBUFFER(sendbuf, tmp_sendbuf, double, elements, sizeof(double),
+    ALLOCATE_SENDBUFFER(sendbuf, tmp_sendbuf, char, elements, extent,
                         rank, MPI_COMM_WORLD, init_sendbuf, out);
 
     // Initialize recv buffer
-    ALLOCATE_RECVBUFFER(recvbuf, tmp_recvbuf, double, elements, sizeof(double),
+    ALLOCATE_RECVBUFFER(recvbuf, tmp_recvbuf, char, elements, extent,
                         rank, MPI_COMM_WORLD, init_recvbuf, out);
 
     // execute the reduce_local test
     MPI_Barrier(MPI_COMM_WORLD);
     t1s = std::chrono::high_resolution_clock::now();
     ret = reduce_local_test (sendbuf->get_buffer(), recvbuf->get_buffer(), elements,
-                             MPI_DOUBLE, MPI_SUM);
+                             reduction->get_mpi_type(), reduction->get_mpi_op());
     if (MPI_SUCCESS != ret) {
         fprintf(stderr, "Error in reduce_local_test. Aborting\n");
         goto out;
@@ -112,16 +95,16 @@ int main (int argc, char *argv[])
     bool res, fret;
     res = true;
     if (recvbuf->NeedsStagingBuffer()) {
-        HIP_CHECK(recvbuf->CopyFrom(tmp_recvbuf, elements*sizeof(double)));
-        res = check_recvbuf(tmp_recvbuf, size, rank, elements);
+        HIP_CHECK(recvbuf->CopyFrom(tmp_recvbuf, elements*extent));
+        res = reduction->check_reduce_local(tmp_recvbuf, rank, elements);
     }
     else {
-        res = check_recvbuf((double*) recvbuf->get_buffer(), size, rank, elements);
+        res = reduction->check_reduce_local(recvbuf->get_buffer(), rank, elements);
     }
 
     fret = report_testresult(argv[0], MPI_COMM_WORLD, sendbuf->get_memchar(), recvbuf->get_memchar(), res);
     report_performance (argv[0], MPI_COMM_WORLD, sendbuf->get_memchar(), recvbuf->get_memchar(),
-                        elements, (size_t)(elements * sizeof(double)), NITER, t1);
+                        elements, (size_t)(elements * extent), NITER, t1);
 
  out:
     //Free buffers
@@ -130,6 +113,7 @@ int main (int argc, char *argv[])
 
     delete (sendbuf);
     delete (recvbuf);
+    delete (reduction);
 
     if (MPI_SUCCESS != ret) {
         MPI_Abort (MPI_COMM_WORLD, 1);
@@ -145,7 +129,9 @@ int reduce_local_test ( void *sendbuf, void *recvbuf, int count,
 {
     int ret;
 
+    HIP_MPITEST_TRACE_BEGIN();
     ret = MPI_Reduce_local (sendbuf, recvbuf, count, datatype, op);
+    HIP_MPITEST_TRACE_END("MPI_Reduce_local", count, datatype);
     if (MPI_SUCCESS != ret) {
         return ret;
     }
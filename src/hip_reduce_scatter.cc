@@ -190,7 +190,9 @@ int reduce_scatter_test(void *sendbuf, void *recvbuf, int count,
     }
 
     for (int i = 0; i < niterations; i++) {
+        HIP_MPITEST_TRACE_BEGIN();
         ret = MPI_Reduce_scatter(sendbuf, recvbuf, recv_counts, datatype, MPI_SUM, comm);
+        HIP_MPITEST_TRACE_END("MPI_Reduce_scatter", count, datatype);
         if (MPI_SUCCESS != ret) {
             goto out;
         }
@@ -209,7 +211,9 @@ int reduce_scatter_block_test(void *sendbuf, void *recvbuf, int blockcount,
     MPI_Comm_size(comm, &size);
 
     for (int i = 0; i < niterations; i++) {
+        HIP_MPITEST_TRACE_BEGIN();
         ret = MPI_Reduce_scatter_block(sendbuf, recvbuf, blockcount, datatype, MPI_SUM, comm);
+        HIP_MPITEST_TRACE_END("MPI_Reduce_scatter_block", blockcount, datatype);
 
         if (ret != MPI_SUCCESS) {
             return ret;
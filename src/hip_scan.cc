@@ -150,9 +150,13 @@ int scan_test (void *sendbuf, void *recvbuf, int count,
     int ret;
 
 #ifdef HIP_MPITEST_EXSCAN
+    HIP_MPITEST_TRACE_BEGIN();
     ret = MPI_Exscan(sendbuf, recvbuf, count, datatype, op, comm);
+    HIP_MPITEST_TRACE_END("MPI_Exscan", count, datatype);
 #else
+    HIP_MPITEST_TRACE_BEGIN();
     ret = MPI_Scan(sendbuf, recvbuf, count, datatype, op, comm);    
+    HIP_MPITEST_TRACE_END("MPI_Scan", count, datatype);
 #endif
     if (MPI_SUCCESS != ret) {
         return ret;
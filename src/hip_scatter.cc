@@ -188,9 +188,13 @@ int scatter_test(void *sendbuf, void *recvbuf, int count,
 
     for (int i = 0; i < niterations; i++) {
 #if defined HIP_MPITEST_SCATTERV
+        HIP_MPITEST_TRACE_BEGIN();
         ret = MPI_Scatterv(sendbuf, send_counts, send_displs, datatype, recvbuf, count, datatype, 0, comm);
+        HIP_MPITEST_TRACE_END("MPI_Scatterv", count, datatype);
 #else
+        HIP_MPITEST_TRACE_BEGIN();
         ret = MPI_Scatter(sendbuf, count, datatype, recvbuf, count, datatype, 0, comm);
+        HIP_MPITEST_TRACE_END("MPI_Scatter", count, datatype);
 #endif
         if (MPI_SUCCESS != ret) {
             goto out;
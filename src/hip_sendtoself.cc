@@ -149,6 +149,7 @@ int type_p2p_nb_test (int *sendbuf, int *recvbuf, int count, MPI_Comm comm)
         return MPI_ERR_OTHER;
     }
 
+    HIP_MPITEST_TRACE_BEGIN();
     ret = MPI_Irecv (recvbuf, count, MPI_INT, rank, tag, comm, &reqs[0]);
     if (MPI_SUCCESS != ret) {
         goto out;
@@ -163,6 +164,7 @@ int type_p2p_nb_test (int *sendbuf, int *recvbuf, int count, MPI_Comm comm)
     if (MPI_SUCCESS != ret) {
         goto out;
     }
+    HIP_MPITEST_TRACE_END("MPI_Isend/MPI_Irecv", count, MPI_INT);
 
  out:
     free (reqs);
@@ -0,0 +1,70 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#ifndef __HIP_TYPE_DARRAY__
+#define __HIP_TYPE_DARRAY__
+
+#include "mpi.h"
+#include "hip_mpitest_datatype.h"
+
+// The part of a one-dimensional array of HIP_TYPE_NBLOCKS*width integers
+// per process owned by this process in a cyclic(width) distribution over
+// all processes of MPI_COMM_WORLD. The gaps are given by the blocks of the
+// other processes, hence the layout differs between processes and the gap
+// parameter is not used.
+class hip_type_darray: public hip_mpitest_datatype {
+ protected:
+    int width;
+    int rank;
+    int nprocs;
+ public:
+    hip_type_darray() :
+        hip_type_darray(hip_mpitest_datatype_param("HIP_MPITEST_DDT_BLOCKLEN", HIP_TYPE_WIDTH, 1),
+                        hip_mpitest_datatype_param("HIP_MPITEST_DDT_GAP", GAPSIZE, 0)) {}
+    hip_type_darray(int _width, int _gap) : width(_width) {
+        MPI_Comm_rank (MPI_COMM_WORLD, &rank);
+        MPI_Comm_size (MPI_COMM_WORLD, &nprocs);
+
+        int gsizes[1]   = {nprocs*HIP_TYPE_NBLOCKS*width};
+        int distribs[1] = {MPI_DISTRIBUTE_CYCLIC};
+        int dargs[1]    = {width};
+        int psizes[1]   = {nprocs};
+
+        MPI_Type_create_darray(nprocs, rank, 1, gsizes, distribs, dargs, psizes,
+                               MPI_ORDER_C, MPI_INT, &datatype);
+        MPI_Type_commit(&datatype);
+    }
+    ~hip_type_darray() {
+        MPI_Type_free (&datatype);
+    }
+
+    int get_num_elements() {
+        return HIP_TYPE_NBLOCKS*width;
+    }
+
+    MPI_Aint get_element_offset(int e) {
+        return ((e / width)*nprocs + rank)*width + e % width;
+    }
+};
+
+#endif
@@ -0,0 +1,73 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#ifndef __HIP_TYPE_INDEXED__
+#define __HIP_TYPE_INDEXED__
+
+#include <vector>
+
+#include "mpi.h"
+#include "hip_mpitest_datatype.h"
+
+// HIP_TYPE_NBLOCKS blocks of irregular length (width or 2*width integers)
+// separated by irregular gaps (gap, 2*gap or 3*gap integers)
+class hip_type_indexed: public hip_mpitest_datatype {
+ protected:
+    std::vector<MPI_Aint> offsets;
+ public:
+    hip_type_indexed() :
+        hip_type_indexed(hip_mpitest_datatype_param("HIP_MPITEST_DDT_BLOCKLEN", HIP_TYPE_WIDTH, 1),
+                         hip_mpitest_datatype_param("HIP_MPITEST_DDT_GAP", GAPSIZE, 0)) {}
+    hip_type_indexed(int width, int gap) {
+        int blens[HIP_TYPE_NBLOCKS], displs[HIP_TYPE_NBLOCKS];
+        int pos = 0;
+        MPI_Datatype dat1;
+
+        for (int i=0; i<HIP_TYPE_NBLOCKS; i++) {
+            blens[i]  = i % 2 == 0 ? width : 2*width;
+            displs[i] = pos;
+            for (int j=0; j<blens[i]; j++) {
+                offsets.push_back(pos + j);
+            }
+            pos += blens[i] + gap * (1 + i % 3);
+        }
+
+        MPI_Type_indexed(HIP_TYPE_NBLOCKS, blens, displs, MPI_INT, &dat1);
+        MPI_Type_create_resized(dat1, 0, pos*sizeof(int), &datatype);
+        MPI_Type_commit(&datatype);
+        MPI_Type_free (&dat1);
+    }
+    ~hip_type_indexed() {
+        MPI_Type_free (&datatype);
+    }
+
+    int get_num_elements() {
+        return (int)offsets.size();
+    }
+
+    MPI_Aint get_element_offset(int e) {
+        return offsets[e];
+    }
+};
+
+#endif
@@ -0,0 +1,61 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#ifndef __HIP_TYPE_SUBARRAY__
+#define __HIP_TYPE_SUBARRAY__
+
+#include "mpi.h"
+#include "hip_mpitest_datatype.h"
+
+// The columns gap/2 to gap/2+width-1 of a HIP_TYPE_NBLOCKS x (width+gap)
+// integer array in C order
+class hip_type_subarray: public hip_mpitest_datatype {
+ protected:
+    int width;
+    int gap;
+ public:
+    hip_type_subarray() :
+        hip_type_subarray(hip_mpitest_datatype_param("HIP_MPITEST_DDT_BLOCKLEN", HIP_TYPE_WIDTH, 1),
+                          hip_mpitest_datatype_param("HIP_MPITEST_DDT_GAP", GAPSIZE, 0)) {}
+    hip_type_subarray(int _width, int _gap) : width(_width), gap(_gap) {
+        int sizes[2]    = {HIP_TYPE_NBLOCKS, width+gap};
+        int subsizes[2] = {HIP_TYPE_NBLOCKS, width};
+        int starts[2]   = {0, gap/2};
+
+        MPI_Type_create_subarray(2, sizes, subsizes, starts, MPI_ORDER_C, MPI_INT, &datatype);
+        MPI_Type_commit(&datatype);
+    }
+    ~hip_type_subarray() {
+        MPI_Type_free (&datatype);
+    }
+
+    int get_num_elements() {
+        return HIP_TYPE_NBLOCKS*width;
+    }
+
+    MPI_Aint get_element_offset(int e) {
+        return (e / width)*(width+gap) + gap/2 + e % width;
+    }
+};
+
+#endif
@@ -0,0 +1,62 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#ifndef __HIP_TYPE_VECTOR__
+#define __HIP_TYPE_VECTOR__
+
+#include "mpi.h"
+#include "hip_mpitest_datatype.h"
+
+// HIP_TYPE_NBLOCKS blocks of width integers with a stride of width+gap
+// integers, resized to include the gap after the last block
+class hip_type_vector: public hip_mpitest_datatype {
+ protected:
+    int width;
+    int gap;
+ public:
+    hip_type_vector() :
+        hip_type_vector(hip_mpitest_datatype_param("HIP_MPITEST_DDT_BLOCKLEN", HIP_TYPE_WIDTH, 1),
+                        hip_mpitest_datatype_param("HIP_MPITEST_DDT_GAP", GAPSIZE, 0)) {}
+    hip_type_vector(int _width, int _gap) : width(_width), gap(_gap) {
+        MPI_Aint extent = HIP_TYPE_NBLOCKS*(width+gap)*sizeof(int);
+        MPI_Datatype dat1;
+
+        MPI_Type_vector(HIP_TYPE_NBLOCKS, width, width+gap, MPI_INT, &dat1);
+        MPI_Type_create_resized(dat1, 0, extent, &datatype);
+        MPI_Type_commit(&datatype);
+        MPI_Type_free (&dat1);
+    }
+    ~hip_type_vector() {
+        MPI_Type_free (&datatype);
+    }
+
+    int get_num_elements() {
+        return HIP_TYPE_NBLOCKS*width;
+    }
+
+    MPI_Aint get_element_offset(int e) {
+        return (e / width)*(width+gap) + e % width;
+    }
+};
+
+#endif
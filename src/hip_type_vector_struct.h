@@ -0,0 +1,75 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/******************************************************************************
+ * Copyright (c) 2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ *****************************************************************************/
+
+#ifndef __HIP_TYPE_VECTOR_STRUCT__
+#define __HIP_TYPE_VECTOR_STRUCT__
+
+#include "mpi.h"
+#include "hip_mpitest_datatype.h"
+
+#ifdef A_WIDTH
+#define HIP_TYPE_VECTOR_STRUCT_WIDTH A_WIDTH
+#else
+#define HIP_TYPE_VECTOR_STRUCT_WIDTH 128
+#endif
+#define HIP_TYPE_VECTOR_STRUCT_COUNT 4
+
+// Nested datatype: a vector of HIP_TYPE_VECTOR_STRUCT_COUNT structs using
+// every second struct, each struct laid out as in hip_type_struct
+class hip_type_vector_struct: public hip_mpitest_datatype {
+ protected:
+    int width;
+    int gap;
+ public:
+    hip_type_vector_struct() :
+        hip_type_vector_struct(hip_mpitest_datatype_param("HIP_MPITEST_DDT_BLOCKLEN", HIP_TYPE_VECTOR_STRUCT_WIDTH, 1),
+                               hip_mpitest_datatype_param("HIP_MPITEST_DDT_GAP", GAPSIZE, 0)) {}
+    hip_type_vector_struct(int _width, int _gap) : width(_width), gap(_gap) {
+        MPI_Aint displs[2] = {0, (MPI_Aint)((width+gap)*sizeof(int))};
+        MPI_Datatype dats[2] = {MPI_INT, MPI_INT};
+        int blength[2] = {width, width};
+        MPI_Datatype dat1;
+
+        MPI_Type_create_struct(2, blength, displs, dats, &dat1);
+        MPI_Type_vector(HIP_TYPE_VECTOR_STRUCT_COUNT, 1, 2, dat1, &datatype);
+        MPI_Type_commit(&datatype);
+        MPI_Type_free (&dat1);
+    }
+    ~hip_type_vector_struct() {
+        MPI_Type_free (&datatype);
+    }
+
+    int get_num_elements() {
+        return HIP_TYPE_VECTOR_STRUCT_COUNT*2*width;
+    }
+
+    MPI_Aint get_element_offset(int e) {
+        MPI_Aint struct_extent = 2*width + gap;
+        int v = e / (2*width);
+        int r = e % (2*width);
+
+        return v*2*struct_extent + (r < width ? r : gap + r);
+    }
+};
+
+#endif